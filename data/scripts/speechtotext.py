@@ -26,8 +26,9 @@ rec.SetWords(True)
 
 # zone rendering
 if len(sys.argv) > 4 and (float(sys.argv[4])>0 or float(sys.argv[5])>0):
-    process = subprocess.Popen(['ffmpeg', '-loglevel', 'quiet', '-i',
-                            sys.argv[3], '-ss', sys.argv[4], '-t', sys.argv[5],
+    # seek before opening the input so that ffmpeg doesn't decode everything up to the zone start
+    process = subprocess.Popen(['ffmpeg', '-loglevel', 'quiet', '-ss', sys.argv[4], '-t', sys.argv[5],
+                            '-i', sys.argv[3],
                             '-ar', str(sample_rate) , '-ac', '1', '-f', 's16le', '-'],
                             stdout=subprocess.PIPE)
 else:
@@ -156,8 +156,10 @@ int main(int argc, char **argv)
         f.close();
         QDomElement consumer = doc.documentElement().firstChildElement(QStringLiteral("consumer"));
         if (!consumer.isNull()) {
-            if (consumer.hasAttribute(QLatin1String("s")) || consumer.hasAttribute(QLatin1String("r"))) {
+            if (consumer.hasAttribute(QLatin1String("s")) || consumer.hasAttribute(QLatin1String("r")) ||
+                !consumer.nextSiblingElement(QStringLiteral("consumer")).isNull()) {
                 // Workaround MLT embedded consumer resize (MLT issue #453)
+                // Several consumers (multiple outputs) also require the multi consumer
                 playlist.prepend(QStringLiteral("xml:"));
                 playlist.append(QStringLiteral("?multi=1"));
             }
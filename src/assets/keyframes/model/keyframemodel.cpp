@@ -403,7 +403,9 @@ bool KeyframeModel::moveKeyframe(GenTime oldPos, GenTime pos, QVariant newVal, b
     Fun redo = []() { return true; };
     bool res = moveKeyframe(oldPos, pos, std::move(newVal), undo, redo);
     if (res && logUndo) {
-        PUSH_UNDO(undo, redo, i18nc("@action", "Move keyframe"));
+        // Successive nudges of a keyframe end up in a single undo entry, the key follows the keyframe position
+        PUSH_UNDO_MERGE(undo, redo, i18nc("@action", "Move keyframe"), QStringLiteral("keyframe-move-%1-%2").arg(quintptr(this)).arg(oldPos.seconds()),
+                        QStringLiteral("keyframe-move-%1-%2").arg(quintptr(this)).arg(pos.seconds()));
     }
     return res;
 }
@@ -474,7 +476,7 @@ bool KeyframeModel::updateKeyframe(GenTime pos, QVariant value)
     Fun redo = []() { return true; };
     bool res = updateKeyframe(pos, value, undo, redo);
     if (res) {
-        PUSH_UNDO(undo, redo, i18n("Update keyframe"));
+        PUSH_UNDO_MERGE(undo, redo, i18n("Update keyframe"), QStringLiteral("keyframe-update-%1-%2").arg(quintptr(this)).arg(pos.seconds()));
     }
     return res;
 }
@@ -515,7 +517,7 @@ bool KeyframeModel::updateKeyframeType(GenTime pos, int type, Fun &undo, Fun &re
 Fun KeyframeModel::updateKeyframe_lambda(GenTime pos, KeyframeType type, const QVariant &value, bool notify)
 {
     QWriteLocker locker(&m_lock);
-    return [this, pos, type, value, notify]() {
+    Fun update = [this, pos, type, value, notify]() {
         qDebug() << "update lambda" << pos.frames(pCore->getCurrentFps()) << value << notify;
         Q_ASSERT(m_keyframeList.count(pos) > 0);
         int row = static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(pos)));
@@ -524,12 +526,13 @@ Fun KeyframeModel::updateKeyframe_lambda(GenTime pos, KeyframeType type, const Q
         if (notify) emit dataChanged(index(row), index(row), {ValueRole, NormalizedValueRole, TypeRole});
         return true;
     };
+    return UndoPayload::attach(update, UndoPayload::stringSize(value.toString()));
 }
 
 Fun KeyframeModel::addKeyframe_lambda(GenTime pos, KeyframeType type, const QVariant &value, bool notify)
 {
     QWriteLocker locker(&m_lock);
-    return [this, notify, pos, type, value]() {
+    Fun add = [this, notify, pos, type, value]() {
         qDebug() << "add lambda" << pos.frames(pCore->getCurrentFps()) << value << notify;
         Q_ASSERT(m_keyframeList.count(pos) == 0);
         // We determine the row of the newly added marker
@@ -544,6 +547,7 @@ Fun KeyframeModel::addKeyframe_lambda(GenTime pos, KeyframeType type, const QVar
         if (notify) endInsertRows();
         return true;
     };
+    return UndoPayload::attach(add, UndoPayload::stringSize(value.toString()));
 }
 
 Fun KeyframeModel::deleteKeyframe_lambda(GenTime pos, bool notify)
@@ -1416,6 +1420,81 @@ bool KeyframeModel::removeNextKeyframes(GenTime pos, Fun &undo, Fun &redo)
     return true;
 }
 
+bool KeyframeModel::removeKeyframes(const QList<GenTime> &positions, Fun &undo, Fun &redo)
+{
+    QWriteLocker locker(&m_lock);
+    std::map<GenTime, std::pair<KeyframeType, QVariant>> removed;
+    for (const auto &p : positions) {
+        auto it = m_keyframeList.find(p);
+        if (it == m_keyframeList.end()) {
+            return false;
+        }
+        removed.insert(*it);
+    }
+    if (removed.empty()) {
+        return true;
+    }
+    QVector<int> prevSelection;
+    if (auto ptr = m_model.lock()) {
+        prevSelection = ptr->m_selectedKeyframes;
+    }
+    // Removing thousands of keyframes one by one is very slow, so we directly edit the list and trigger one reset
+    Fun local_redo = [this, removed]() {
+        beginResetModel();
+        for (const auto &kf : removed) {
+            m_keyframeList.erase(kf.first);
+        }
+        endResetModel();
+        if (auto ptr = m_model.lock()) {
+            ptr->m_selectedKeyframes = {};
+        }
+        return true;
+    };
+    Fun local_undo = [this, removed, prevSelection]() {
+        beginResetModel();
+        for (const auto &kf : removed) {
+            m_keyframeList[kf.first] = kf.second;
+        }
+        endResetModel();
+        setSelectedKeyframes(prevSelection);
+        return true;
+    };
+    if (local_redo()) {
+        UPDATE_UNDO_REDO(local_redo, local_undo, undo, redo);
+        return true;
+    }
+    return false;
+}
+
+QVector<QVector<double>> KeyframeModel::getKeyframeChannels(bool *ok) const
+{
+    READ_LOCK();
+    QVector<QVector<double>> channels;
+    *ok = m_paramType == ParamType::KeyframeParam || m_paramType == ParamType::AnimatedRect;
+    if (!*ok) {
+        return channels;
+    }
+    channels.reserve(int(m_keyframeList.size()));
+    for (const auto &kf : m_keyframeList) {
+        QVector<double> values;
+        if (m_paramType == ParamType::AnimatedRect) {
+            const QStringList data = kf.second.second.toString().simplified().split(QLatin1Char(' '));
+            for (int i = 0; i < data.size() && i < 5; i++) {
+                double val = data.at(i).toDouble();
+                if (i == 4) {
+                    // Opacity is stored in the 0-1 range
+                    val *= 100.;
+                }
+                values << val;
+            }
+        } else {
+            values << kf.second.second.toDouble();
+        }
+        channels << values;
+    }
+    return channels;
+}
+
 void KeyframeModel::setSelectedKeyframe(int ix, bool add)
 {
     QVector<int> previous;
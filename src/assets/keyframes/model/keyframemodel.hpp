@@ -72,7 +72,14 @@ protected:
     bool removeAllKeyframes();
     bool removeAllKeyframes(Fun &undo, Fun &redo);
     bool removeNextKeyframes(GenTime pos, Fun &undo, Fun &redo);
+    /** @brief Removes a list of keyframes in one operation, with a single model reset instead of one notification per keyframe */
+    bool removeKeyframes(const QList<GenTime> &positions, Fun &undo, Fun &redo);
     QList<GenTime> getKeyframePos() const;
+    /** @brief Returns the numeric values of each keyframe in position order, used for simplification.
+       Double parameters have one channel, rect parameters have x, y, width, height and opacity (in percent).
+       @param ok is set to false if the parameter type cannot be simplified
+     */
+    QVector<QVector<double>> getKeyframeChannels(bool *ok) const;
 
 protected:
     /** @brief Same function but accumulates undo/redo */
@@ -9,6 +9,7 @@
 #include "core.h"
 #include "doc/docundostack.hpp"
 #include "keyframemodel.hpp"
+#include "keyframesimplifier.hpp"
 #include "klocalizedstring.h"
 #include "macros.hpp"
 #include <kdenlivesettings.h>
@@ -215,6 +216,79 @@ bool KeyframeModelList::removeNextKeyframes(GenTime pos)
     return applyOperation(op, i18n("Delete keyframes"));
 }
 
+int KeyframeModelList::simplifyKeyframes(double tolerance)
+{
+    QWriteLocker locker(&m_lock);
+    Fun undo = []() { return true; };
+    Fun redo = []() { return true; };
+    int removed = simplifyKeyframes(tolerance, undo, redo);
+    if (removed > 0) {
+        PUSH_UNDO(undo, redo, i18n("Simplify keyframes"));
+    }
+    return removed;
+}
+
+int KeyframeModelList::simplifyKeyframes(double tolerance, Fun &undo, Fun &redo)
+{
+    QWriteLocker locker(&m_lock);
+    Q_ASSERT(m_parameters.size() > 0);
+    // All parameters share the same keyframe positions, so the decision is made on all channels of all parameters
+    QList<GenTime> positions = m_parameters.begin()->second->getKeyframePos();
+    const int count = positions.size();
+    if (count < 3) {
+        return 0;
+    }
+    QVector<int> frames;
+    frames.reserve(count);
+    for (const auto &pos : qAsConst(positions)) {
+        frames << pos.frames(pCore->getCurrentFps());
+    }
+    QVector<QVector<double>> channels(count);
+    QVector<bool> locked(count, false);
+    for (const auto &param : m_parameters) {
+        bool ok = true;
+        const QVector<QVector<double>> values = param.second->getKeyframeChannels(&ok);
+        if (!ok || values.size() != count) {
+            return -1;
+        }
+        for (int i = 0; i < count; i++) {
+            channels[i] << values.at(i);
+        }
+        int ix = 0;
+        for (const auto &kf : param.second->m_keyframeList) {
+            if (kf.second.first == KeyframeType::Discrete) {
+                // A discrete keyframe holds its value until the next one, both are required
+                locked[ix] = true;
+                if (ix + 1 < count) {
+                    locked[ix + 1] = true;
+                }
+            }
+            ix++;
+        }
+    }
+    const QVector<bool> keep = KeyframeSimplifier::simplify(frames, channels, locked, tolerance);
+    QList<GenTime> toRemove;
+    for (int i = 0; i < count; i++) {
+        if (!keep.at(i)) {
+            toRemove << positions.at(i);
+        }
+    }
+    if (toRemove.isEmpty()) {
+        return 0;
+    }
+    Fun local_undo = []() { return true; };
+    Fun local_redo = []() { return true; };
+    for (const auto &param : m_parameters) {
+        if (!param.second->removeKeyframes(toRemove, local_undo, local_redo)) {
+            bool undone = local_undo();
+            Q_ASSERT(undone);
+            return -1;
+        }
+    }
+    UPDATE_UNDO_REDO_NOLOCK(local_redo, local_undo, undo, redo);
+    return toRemove.size();
+}
+
 bool KeyframeModelList::moveKeyframe(GenTime oldPos, GenTime pos, bool logUndo, bool updateView)
 {
     QWriteLocker locker(&m_lock);
@@ -55,6 +55,13 @@ public:
     bool removeAllKeyframes();
     /** @brief Delete all the keyframes after a certain position (except first) */
     bool removeNextKeyframes(GenTime pos);
+    /** @brief Remove the keyframes that can be interpolated from their neighbours without deviating more than tolerance
+       (in pixels for rect parameters, in value units otherwise) on any parameter.
+       Discrete keyframes are always kept.
+       @returns the number of removed keyframes, or -1 if the parameters cannot be simplified
+    */
+    int simplifyKeyframes(double tolerance);
+    int simplifyKeyframes(double tolerance, Fun &undo, Fun &redo);
 
     /** @brief moves a keyframe
        @param oldPos is the old position of the keyframe
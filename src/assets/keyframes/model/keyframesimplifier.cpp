@@ -0,0 +1,75 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "keyframesimplifier.hpp"
+
+#include <QPair>
+#include <QtGlobal>
+
+QVector<bool> KeyframeSimplifier::simplify(const QVector<int> &frames, const QVector<QVector<double>> &channels, const QVector<bool> &locked, double tolerance)
+{
+    const int count = frames.size();
+    QVector<bool> keep(count, true);
+    if (count < 3 || channels.size() != count || tolerance < 0.) {
+        return keep;
+    }
+    keep.fill(false);
+    keep[0] = true;
+    keep[count - 1] = true;
+    for (int i = 0; i < locked.size() && i < count; ++i) {
+        if (locked.at(i)) {
+            keep[i] = true;
+        }
+    }
+    // Locked keyframes split the curve in independent segments
+    int segmentStart = 0;
+    for (int i = 1; i < count; ++i) {
+        if (keep.at(i)) {
+            simplifySegment(frames, channels, segmentStart, i, tolerance, keep);
+            segmentStart = i;
+        }
+    }
+    return keep;
+}
+
+void KeyframeSimplifier::simplifySegment(const QVector<int> &frames, const QVector<QVector<double>> &channels, int first, int last, double tolerance,
+                                         QVector<bool> &keep)
+{
+    // Iterative version to avoid deep recursion on very long tracking data
+    QVector<QPair<int, int>> stack;
+    stack.append({first, last});
+    while (!stack.isEmpty()) {
+        const QPair<int, int> segment = stack.takeLast();
+        const int start = segment.first;
+        const int end = segment.second;
+        if (end - start < 2) {
+            continue;
+        }
+        const QVector<double> &startValues = channels.at(start);
+        const QVector<double> &endValues = channels.at(end);
+        const double span = frames.at(end) - frames.at(start);
+        double maxError = -1.;
+        int maxIndex = -1;
+        for (int i = start + 1; i < end; ++i) {
+            const double ratio = span > 0. ? (frames.at(i) - frames.at(start)) / span : 0.;
+            const QVector<double> &values = channels.at(i);
+            double error = 0.;
+            for (int c = 0; c < values.size() && c < startValues.size() && c < endValues.size(); ++c) {
+                const double interpolated = startValues.at(c) + (endValues.at(c) - startValues.at(c)) * ratio;
+                error = qMax(error, qAbs(values.at(c) - interpolated));
+            }
+            if (error > maxError) {
+                maxError = error;
+                maxIndex = i;
+            }
+        }
+        if (maxError > tolerance) {
+            keep[maxIndex] = true;
+            stack.append({start, maxIndex});
+            stack.append({maxIndex, end});
+        }
+    }
+}
@@ -0,0 +1,31 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QVector>
+
+/** @class KeyframeSimplifier
+    @brief Error bounded curve simplification for keyframe lists, used to decimate the one keyframe per frame
+    data produced by motion tracking or clipboard imports.
+    The algorithm is a Ramer–Douglas–Peucker variant working on several channels at once: a keyframe is only
+    dropped if every channel can be linearly interpolated from the kept neighbours within the given tolerance.
+ */
+struct KeyframeSimplifier
+{
+    /** @brief Compute which keyframes should be kept
+       @param frames the keyframe positions, in ascending order
+       @param channels for each keyframe, the list of its numeric values (all keyframes must have the same channel count)
+       @param locked keyframes that must be kept (for example discrete keyframes). Can be empty
+       @param tolerance the maximum allowed deviation, in value units
+       @return a vector with the same size as frames, true for keyframes that must be kept
+     */
+    static QVector<bool> simplify(const QVector<int> &frames, const QVector<QVector<double>> &channels, const QVector<bool> &locked, double tolerance);
+
+private:
+    static void simplifySegment(const QVector<int> &frames, const QVector<QVector<double>> &channels, int first, int last, double tolerance,
+                                QVector<bool> &keep);
+};
@@ -10,7 +10,7 @@
 #include <memory>
 #include <utility>
 AssetCommand::AssetCommand(const std::shared_ptr<AssetParameterModel> &model, const QModelIndex &index, QString value, QUndoCommand *parent)
-    : QUndoCommand(parent)
+    : MeasuredUndoCommand(parent)
     , m_model(model)
     , m_index(index)
     , m_value(std::move(value))
@@ -84,7 +84,7 @@ bool AssetCommand::mergeWith(const QUndoCommand *other)
 }
 
 AssetMultiCommand::AssetMultiCommand(const std::shared_ptr<AssetParameterModel> &model, const QList <QModelIndex> &indexes, const QStringList &values, QUndoCommand *parent)
-    : QUndoCommand(parent)
+    : MeasuredUndoCommand(parent)
     , m_model(model)
     , m_indexes(indexes)
     , m_values(values)
@@ -145,7 +145,7 @@ bool AssetMultiCommand::mergeWith(const QUndoCommand *other)
 
 AssetKeyframeCommand::AssetKeyframeCommand(const std::shared_ptr<AssetParameterModel> &model, const QModelIndex &index, QVariant value, GenTime pos,
                                            QUndoCommand *parent)
-    : QUndoCommand(parent)
+    : MeasuredUndoCommand(parent)
     , m_model(model)
     , m_index(index)
     , m_value(std::move(value))
@@ -191,7 +191,7 @@ bool AssetKeyframeCommand::mergeWith(const QUndoCommand *other)
 }
 
 AssetUpdateCommand::AssetUpdateCommand(const std::shared_ptr<AssetParameterModel> &model, QVector<QPair<QString, QVariant>> parameters, QUndoCommand *parent)
-    : QUndoCommand(parent)
+    : MeasuredUndoCommand(parent)
     , m_model(model)
     , m_value(std::move(parameters))
 {
@@ -219,3 +219,37 @@ int AssetUpdateCommand::id() const
 {
     return 3;
 }
+
+qint64 AssetCommand::memoryCost() const
+{
+    return qint64(sizeof(AssetCommand)) + (m_value.size() + m_oldValue.size() + m_name.size()) * qint64(sizeof(QChar));
+}
+
+qint64 AssetMultiCommand::memoryCost() const
+{
+    qint64 cost = qint64(sizeof(AssetMultiCommand)) + m_indexes.size() * qint64(sizeof(QModelIndex));
+    for (const QString &value : m_values) {
+        cost += value.size() * qint64(sizeof(QChar));
+    }
+    for (const QString &value : m_oldValues) {
+        cost += value.size() * qint64(sizeof(QChar));
+    }
+    return cost;
+}
+
+qint64 AssetKeyframeCommand::memoryCost() const
+{
+    return qint64(sizeof(AssetKeyframeCommand)) + (m_value.toString().size() + m_oldValue.toString().size()) * qint64(sizeof(QChar));
+}
+
+qint64 AssetUpdateCommand::memoryCost() const
+{
+    qint64 cost = qint64(sizeof(AssetUpdateCommand));
+    for (const auto &param : m_value) {
+        cost += (param.first.size() + param.second.toString().size()) * qint64(sizeof(QChar));
+    }
+    for (const auto &param : m_oldValue) {
+        cost += (param.first.size() + param.second.toString().size()) * qint64(sizeof(QChar));
+    }
+    return cost;
+}
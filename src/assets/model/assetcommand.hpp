@@ -6,15 +6,15 @@
 #pragma once
 
 #include "assetparametermodel.hpp"
+#include "undohelper.hpp"
 #include <QPersistentModelIndex>
 #include <QTime>
-#include <QUndoCommand>
 
 /** @class AssetCommand
     @brief \@todo Describe class AssetCommand
     @todo Describe class AssetCommand
  */
-class AssetCommand : public QUndoCommand
+class AssetCommand : public MeasuredUndoCommand
 {
 public:
     AssetCommand(const std::shared_ptr<AssetParameterModel> &model, const QModelIndex &index, QString value, QUndoCommand *parent = nullptr);
@@ -22,6 +22,7 @@ public:
     void redo() override;
     int id() const override;
     bool mergeWith(const QUndoCommand *other) override;
+    qint64 memoryCost() const override;
 
 private:
     std::shared_ptr<AssetParameterModel> m_model;
@@ -37,7 +38,7 @@ private:
     @brief \@todo Describe class AssetMultiCommand
     @todo Describe class AssetMultiCommand
  */
-class AssetMultiCommand : public QUndoCommand
+class AssetMultiCommand : public MeasuredUndoCommand
 {
 public:
     AssetMultiCommand(const std::shared_ptr<AssetParameterModel> &model, const QList<QModelIndex> &indexes, const QStringList &values, QUndoCommand *parent = nullptr);
@@ -45,6 +46,7 @@ public:
     void redo() override;
     int id() const override;
     bool mergeWith(const QUndoCommand *other) override;
+    qint64 memoryCost() const override;
 
 private:
     std::shared_ptr<AssetParameterModel> m_model;
@@ -60,7 +62,7 @@ private:
     @brief \@todo Describe class AssetKeyframeCommand
     @todo Describe class AssetKeyframeCommand
  */
-class AssetKeyframeCommand : public QUndoCommand
+class AssetKeyframeCommand : public MeasuredUndoCommand
 {
 public:
     AssetKeyframeCommand(const std::shared_ptr<AssetParameterModel> &model, const QModelIndex &index, QVariant value, GenTime pos,
@@ -69,6 +71,7 @@ public:
     void redo() override;
     int id() const override;
     bool mergeWith(const QUndoCommand *other) override;
+    qint64 memoryCost() const override;
 
 private:
     std::shared_ptr<AssetParameterModel> m_model;
@@ -84,13 +87,14 @@ private:
     @brief \@todo Describe class AssetUpdateCommand
     @todo Describe class AssetUpdateCommand
  */
-class AssetUpdateCommand : public QUndoCommand
+class AssetUpdateCommand : public MeasuredUndoCommand
 {
 public:
     AssetUpdateCommand(const std::shared_ptr<AssetParameterModel> &model, QVector<QPair<QString, QVariant>> parameters, QUndoCommand *parent = nullptr);
     void undo() override;
     void redo() override;
     int id() const override;
+    qint64 memoryCost() const override;
 
 private:
     std::shared_ptr<AssetParameterModel> m_model;
@@ -10,6 +10,7 @@
 #include "kdenlivesettings.h"
 #include "klocalizedstring.h"
 #include "profiles/profilemodel.hpp"
+#include "undohelper.hpp"
 #include <QDebug>
 #include <QDir>
 #include <QDir>
@@ -899,6 +900,18 @@ QVector<QPair<QString, QVariant>> AssetParameterModel::getAllParameters() const
     return res;
 }
 
+qint64 AssetParameterModel::dataSize() const
+{
+    qint64 size = qint64(sizeof(AssetParameterModel));
+    for (const auto &fixed : m_fixedParams) {
+        size += UndoPayload::stringSize(fixed.first) + UndoPayload::stringSize(fixed.second.toString());
+    }
+    for (const auto &param : m_params) {
+        size += UndoPayload::stringSize(param.first) + UndoPayload::stringSize(param.second.value.toString());
+    }
+    return size;
+}
+
 QJsonDocument AssetParameterModel::toJson(bool includeFixed) const
 {
     QJsonArray list;
@@ -148,6 +148,8 @@ public:
 
     /** @brief Return all the parameters as pairs (parameter name, parameter value) */
     QVector<QPair<QString, QVariant>> getAllParameters() const;
+    /** @brief Memory used by the parameter values, to account for the asset when it is kept by the undo history */
+    qint64 dataSize() const;
     /** @brief Get a parameter value from its name */
     const QVariant getParamFromName(const QString &paramName);
     /** @brief Returns a json definition of the effect with all param values */
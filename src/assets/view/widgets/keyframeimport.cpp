@@ -313,6 +313,18 @@ KeyframeImport::KeyframeImport(const QString &animData, std::shared_ptr<AssetPar
     connect(m_limitKeyframes, &QCheckBox::toggled, m_limitNumber, &QSpinBox::setEnabled);
     connect(m_limitKeyframes, &QAbstractButton::toggled, this, &KeyframeImport::updateDisplay);
     connect(m_limitNumber, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &KeyframeImport::updateDisplay);
+    l1 = new QHBoxLayout;
+    m_simplifyKeyframes = new QCheckBox(i18n("Simplify keyframes, maximum deviation"), this);
+    m_simplifyKeyframes->setToolTip(i18n("Remove keyframes that can be interpolated from their neighbours (in pixels for rectangles, in value units otherwise)"));
+    m_simplifyTolerance = new QDoubleSpinBox(this);
+    m_simplifyTolerance->setRange(0., 1000.);
+    m_simplifyTolerance->setValue(KdenliveSettings::keyframesimplifytolerance());
+    m_simplifyTolerance->setEnabled(false);
+    l1->addWidget(m_simplifyKeyframes);
+    l1->addWidget(m_simplifyTolerance);
+    l1->addStretch(10);
+    lay->addLayout(l1);
+    connect(m_simplifyKeyframes, &QCheckBox::toggled, m_simplifyTolerance, &QDoubleSpinBox::setEnabled);
     connect(m_dataCombo, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &KeyframeImport::updateDataDisplay);
     QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
     connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
@@ -343,6 +355,8 @@ void KeyframeImport::updateDataDisplay()
     m_previewLabel->setVisible(!onlyOne);
     m_limitKeyframes->setVisible(!onlyOne);
     m_limitNumber->setVisible(!onlyOne);
+    m_simplifyKeyframes->setVisible(!onlyOne);
+    m_simplifyTolerance->setVisible(!onlyOne);
     m_inPoint->setVisible(!onlyOne);
     m_outPoint->setVisible(!onlyOne);
 
@@ -1088,6 +1102,14 @@ void KeyframeImport::importSelectedData()
             }
         }
     }
+    if (m_simplifyKeyframes->isChecked() && m_simplifyKeyframes->isVisible()) {
+        KdenliveSettings::setKeyframesimplifytolerance(m_simplifyTolerance->value());
+        int removed = kfrModel->simplifyKeyframes(m_simplifyTolerance->value(), undo, redo);
+        if (removed > 0) {
+            pCore->displayMessage(i18np("Imported keyframes simplified, %1 keyframe removed", "Imported keyframes simplified, %1 keyframes removed", removed),
+                                  InformationMessage);
+        }
+    }
     pCore->pushUndo(undo, redo, i18n("Import keyframes from clipboard"));
 }
 
@@ -32,6 +32,7 @@
 #include <QCheckBox>
 #include <QClipboard>
 #include <QDialogButtonBox>
+#include <QInputDialog>
 #include <QJsonDocument>
 #include <QMenu>
 #include <QPointer>
@@ -147,6 +148,13 @@ KeyframeWidget::KeyframeWidget(std::shared_ptr<AssetParameterModel> model, QMode
     // Remove keyframes
     QAction *removeNext = new QAction(i18n("Remove all Keyframes After Cursor"), this);
     connect(removeNext, &QAction::triggered, this, &KeyframeWidget::slotRemoveNextKeyframes);
+    // Reduce the number of keyframes, useful for motion tracking data
+    QAction *simplify = new QAction(i18n("Simplify Keyframes…"), this);
+    connect(simplify, &QAction::triggered, this, &KeyframeWidget::slotSimplifyKeyframes);
+    ParamType paramType = m_model->data(index, AssetParameterModel::TypeRole).value<ParamType>();
+    if (paramType != ParamType::KeyframeParam && paramType != ParamType::AnimatedRect) {
+        simplify->setVisible(false);
+    }
 
     // Default kf interpolation
     KSelectAction *kfType = new KSelectAction(i18n("Default Keyframe Type"), this);
@@ -198,6 +206,7 @@ KeyframeWidget::KeyframeWidget(std::shared_ptr<AssetParameterModel> model, QMode
     menuAction->addSeparator();
     menuAction->addAction(kfType);
     menuAction->addAction(removeNext);
+    menuAction->addAction(simplify);
     m_toolbar->addAction(menuAction);
 
     m_lay->addWidget(m_keyframeview);
@@ -748,6 +757,26 @@ void KeyframeWidget::slotRemoveNextKeyframes()
 }
 
 
+void KeyframeWidget::slotSimplifyKeyframes()
+{
+    bool ok;
+    double tolerance = QInputDialog::getDouble(this, i18n("Simplify Keyframes"),
+                                               i18n("Maximum deviation (pixels for rectangles, value units otherwise):"),
+                                               KdenliveSettings::keyframesimplifytolerance(), 0., 1000., 2, &ok);
+    if (!ok) {
+        return;
+    }
+    KdenliveSettings::setKeyframesimplifytolerance(tolerance);
+    int before = m_keyframes->count();
+    int removed = m_keyframes->simplifyKeyframes(tolerance);
+    if (removed < 0) {
+        pCore->displayMessage(i18n("Cannot simplify these keyframes"), ErrorMessage);
+    } else {
+        pCore->displayMessage(i18np("Removed %1 keyframe", "Removed %1 keyframes", removed) + QStringLiteral(" (%1 → %2)").arg(before).arg(before - removed),
+                              InformationMessage);
+    }
+}
+
 void KeyframeWidget::slotSeekToKeyframe(int ix)
 {
     int pos = m_keyframes->getPosAtIndex(ix).frames(pCore->getCurrentFps());
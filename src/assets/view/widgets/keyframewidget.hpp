@@ -67,6 +67,8 @@ private slots:
     void slotCopyValueAtCursorPos();
     void slotImportKeyframes();
     void slotRemoveNextKeyframes();
+    /** @brief Ask for a tolerance and remove keyframes that can be interpolated */
+    void slotSimplifyKeyframes();
     void slotSeekToKeyframe(int ix);
     void monitorSeek(int pos);
     void disconnectEffectStack();
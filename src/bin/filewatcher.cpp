@@ -6,14 +6,27 @@
 #include "filewatcher.hpp"
 
 #include <KDirWatch>
+#include <QDir>
 #include <QFileInfo>
 
+namespace {
+/// Number of queued folders registered at once, so that the UI stays responsive when loading large projects
+const int watchBatchSize = 500;
+/// Delay in ms without any event or size change before a modified file is reloaded
+const qint64 settleDelay = 2000;
+
+QString watchedPath(const QString &url)
+{
+    return QDir::cleanPath(QFileInfo(url).absoluteFilePath());
+}
+} // namespace
+
 FileWatcher::FileWatcher(QObject *parent)
     : QObject(parent)
     , m_fileWatcher(new KDirWatch)
 {
     // Init clip modification tracker
-    m_modifiedTimer.setInterval(1500);
+    m_modifiedTimer.setInterval(1000);
     connect(m_fileWatcher.get(), &KDirWatch::dirty, this, &FileWatcher::slotUrlModified);
     connect(m_fileWatcher.get(), &KDirWatch::deleted, this, &FileWatcher::slotUrlMissing);
     connect(m_fileWatcher.get(), &KDirWatch::created, this, &FileWatcher::slotUrlAdded);
@@ -26,40 +39,41 @@ FileWatcher::FileWatcher(QObject *parent)
 
 void FileWatcher::slotProcessQueue()
 {
-    if (m_pendingUrls.size() == 0) {
-        return;
+    int count = 0;
+    auto iter = m_pendingDirs.begin();
+    while (iter != m_pendingDirs.end() && count < watchBatchSize) {
+        // The folder watch also reports changes, creation and deletion of the files it contains
+        m_fileWatcher->addDir(*iter, KDirWatch::WatchFiles);
+        iter = m_pendingDirs.erase(iter);
+        count++;
     }
-    auto iter = m_pendingUrls.begin();
-    doAddFile(iter->first, iter->second);
-    m_pendingUrls.erase(iter->first);
-    if (m_pendingUrls.size() > 0 && !m_queueTimer.isActive()) {
-        m_queueTimer.start();
+    if (!m_pendingDirs.empty()) {
+        // Process the next batch once pending events are handled
+        QMetaObject::invokeMethod(this, "slotProcessQueue", Qt::QueuedConnection);
     }
 }
 
 void FileWatcher::addFile(const QString &binId, const QString &url)
-{
-    if (m_occurences.count(url) > 0) {
-        // Already queued
-        return;
-    }
-    m_pendingUrls[binId] = url;
-    if (!m_queueTimer.isActive()) {
-        m_queueTimer.start();
-    }
-}
-
-void FileWatcher::doAddFile(const QString &binId, const QString &url)
 {
     if (url.isEmpty()) {
         return;
     }
-    if (m_occurences.count(url) == 0) {
-        //QtConcurrent::run([=] { KDirWatch::self()->addFile(url); });
-        m_fileWatcher->addFile(url);
+    const QString path = watchedPath(url);
+    auto current = m_binClipPaths.find(binId);
+    if (current != m_binClipPaths.end() && current->second != path) {
+        removeFile(binId);
+    }
+    if (m_occurences.count(path) == 0) {
+        const QString dir = QFileInfo(path).absolutePath();
+        if (m_watchedDirs[dir]++ == 0) {
+            m_pendingDirs.insert(dir);
+            if (!m_queueTimer.isActive()) {
+                m_queueTimer.start();
+            }
+        }
     }
-    m_occurences[url].insert(binId);
-    m_binClipPaths[binId] = url;
+    m_occurences[path].insert(binId);
+    m_binClipPaths[binId] = path;
 }
 
 void FileWatcher::removeFile(const QString &binId)
@@ -71,47 +85,93 @@ void FileWatcher::removeFile(const QString &binId)
     m_occurences[url].erase(binId);
     m_binClipPaths.erase(binId);
     if (m_occurences[url].empty()) {
-        KDirWatch::self()->removeFile(url);
         m_occurences.erase(url);
+        m_modifiedUrls.erase(url);
+        const QString dir = QFileInfo(url).absolutePath();
+        if (--m_watchedDirs[dir] <= 0) {
+            if (m_pendingDirs.erase(dir) == 0) {
+                m_fileWatcher->removeDir(dir);
+            }
+            m_watchedDirs.erase(dir);
+        }
     }
 }
 
-void FileWatcher::slotUrlModified(const QString &path)
+void FileWatcher::queueModification(const QString &path)
 {
-    if (m_modifiedUrls.insert(path).second) {
+    auto it = m_modifiedUrls.find(path);
+    if (it == m_modifiedUrls.end()) {
+        it = m_modifiedUrls.emplace(path, PendingChange()).first;
         for (const QString &id : m_occurences[path]) {
             emit binClipWaiting(id);
         }
     }
+    it->second.lastEvent = QDateTime::currentDateTime();
     if (!m_modifiedTimer.isActive()) {
         m_modifiedTimer.start();
     }
 }
 
+void FileWatcher::slotUrlModified(const QString &path)
+{
+    const QString file = QDir::cleanPath(path);
+    if (m_occurences.count(file) == 0) {
+        // Another file or the folder itself
+        return;
+    }
+    queueModification(file);
+}
+
 void FileWatcher::slotUrlAdded(const QString &path)
 {
-    for (const QString &id : m_occurences[path]) {
-        emit binClipModified(id);
+    const QString file = QDir::cleanPath(path);
+    if (m_occurences.count(file) == 0) {
+        return;
     }
+    // The file may still be written, for example when copied from a card, wait until it settles
+    queueModification(file);
 }
 
 void FileWatcher::slotUrlMissing(const QString &path)
 {
-    for (const QString &id : m_occurences[path]) {
+    const QString file = QDir::cleanPath(path);
+    if (m_occurences.count(file) == 0) {
+        return;
+    }
+    m_modifiedUrls.erase(file);
+    for (const QString &id : m_occurences[file]) {
         emit binClipMissing(id);
     }
 }
 
 void FileWatcher::slotProcessModifiedUrls()
 {
-    auto checkList = m_modifiedUrls;
-    for (const QString &path : checkList) {
-        if (KDirWatch::self()->ctime(path).msecsTo(QDateTime::currentDateTime()) > 2000) {
-            for (const QString &id : m_occurences[path]) {
-                emit binClipModified(id);
-            }
-            m_modifiedUrls.erase(path);
+    const QDateTime now = QDateTime::currentDateTime();
+    auto iter = m_modifiedUrls.begin();
+    while (iter != m_modifiedUrls.end()) {
+        PendingChange &change = iter->second;
+        QFileInfo info(iter->first);
+        if (!info.exists()) {
+            // Deleted, handled by slotUrlMissing
+            iter = m_modifiedUrls.erase(iter);
+            continue;
+        }
+        qint64 size = info.size();
+        if (size != change.size) {
+            // Still growing, check again on next tick
+            change.size = size;
+            change.lastEvent = now;
+            ++iter;
+            continue;
         }
+        if (change.lastEvent.msecsTo(now) < settleDelay) {
+            ++iter;
+            continue;
+        }
+        for (const QString &id : m_occurences[iter->first]) {
+            emit binClipModified(id);
+        }
+        iter = m_modifiedUrls.erase(iter);
     }
     if (m_modifiedUrls.empty()) {
         m_modifiedTimer.stop();
@@ -120,17 +180,21 @@ void FileWatcher::slotProcessModifiedUrls()
 
 void FileWatcher::clear()
 {
-    KDirWatch::self()->stopScan();
-    for (const auto &f : m_occurences) {
-        KDirWatch::self()->removeFile(f.first);
+    m_fileWatcher->stopScan();
+    for (const auto &dir : m_watchedDirs) {
+        if (m_pendingDirs.count(dir.first) == 0) {
+            m_fileWatcher->removeDir(dir.first);
+        }
     }
+    m_watchedDirs.clear();
+    m_pendingDirs.clear();
     m_occurences.clear();
     m_modifiedUrls.clear();
     m_binClipPaths.clear();
-    KDirWatch::self()->startScan();
+    m_fileWatcher->startScan();
 }
 
 bool FileWatcher::contains(const QString &path) const
 {
-    return KDirWatch::self()->contains(path);
+    return m_occurences.count(watchedPath(path)) > 0;
 }
@@ -7,6 +7,7 @@
 
 #include "definitions.h"
 #include <KDirWatch>
+#include <QDateTime>
 #include <QTimer>
 #include <unordered_map>
 #include <unordered_set>
@@ -14,6 +15,7 @@
 /** @class FileWatcher
     @brief This class is responsible for watching all files used in the project
     and triggers a reload notification when a file changes.
+    Instead of one watch per file, the parent folders of the files are watched, and the events are mapped back to the bin clips through a path index.
  */
 class FileWatcher : public QObject
 {
@@ -32,8 +34,8 @@ public:
     void clear();
 
 signals:
-    /** @brief This signal is triggered whenever the file corresponding to a bin clip has been modified and should be reloaded. Note that this signal is sent no
-     * more than every 1500 ms. We also make sure that at least 1000ms has passed since the last modification of the file. */
+    /** @brief This signal is triggered whenever the file corresponding to a bin clip has been modified and should be reloaded. Modifications are
+     * coalesced: the signal is only sent once the file has not changed (events, size) for 2 seconds, so a file still being written triggers a single reload. */
     void binClipModified(const QString &binId);
     /** @brief Same signal than binClipModified, but triggers immediately. Can be useful to refresh UI without actually reloading the file (yet)*/
     void binClipWaiting(const QString &binId);
@@ -47,21 +49,29 @@ private slots:
     void slotProcessQueue();
 
 private:
-    /// This is a handle to the watcher singleton, not owned by this class.
+    /** @brief A file for which we received events that is waiting to settle before triggering a reload */
+    struct PendingChange
+    {
+        QDateTime lastEvent;
+        qint64 size = -1;
+    };
+    /// The watcher, watching the parent folders of the files
     std::unique_ptr<KDirWatch> m_fileWatcher;
     /// A list with urls as keys, and the corresponding clip ids as value
     std::unordered_map<QString, std::unordered_set<QString>> m_occurences;
     /// keys are binId, keys are stored paths
     std::unordered_map<QString, QString> m_binClipPaths;
+    /// The watched folders, with the number of watched files they contain
+    std::unordered_map<QString, int> m_watchedDirs;
 
     /// List of files for which we received an update since the last send
-    std::unordered_set<QString> m_modifiedUrls;
+    std::unordered_map<QString, PendingChange> m_modifiedUrls;
     
-    /// When loading a project or adding many clips, adding many files to the watcher causes a freeze, so queue them
-    std::unordered_map<QString, QString> m_pendingUrls;
+    /// When loading a project or adding many clips, adding many folders to the watcher causes a freeze, so queue them
+    std::unordered_set<QString> m_pendingDirs;
 
     QTimer m_modifiedTimer;
     QTimer m_queueTimer;
-    /// Add a file to the list of watched items
-    void doAddFile(const QString &binId, const QString &url);
+    /// Register a file change and start the timer that will trigger the reload
+    void queueModification(const QString &path);
 };
@@ -9,6 +9,7 @@
 #include "core.h"
 #include "dialogs/markerdialog.h"
 #include "doc/docundostack.hpp"
+#include "kdenlive_debug.h"
 #include "kdenlivesettings.h"
 #include "macros.hpp"
 #include "project/projectmanager.h"
@@ -18,6 +19,7 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <unordered_set>
 #include <utility>
 
 std::array<QColor, 9> MarkerListModel::markerTypes{{QColor(QLatin1String("#9b59b6")), QColor(QLatin1String("#3daee9")),QColor(QLatin1String("#1abc9c")),QColor(QLatin1String("#1cdc9a")),QColor(QLatin1String("#c9ce3b")),QColor(QLatin1String("#fdbc4b")),QColor(QLatin1String("#f39c1f")),QColor(QLatin1String("#f47750")),QColor(QLatin1String("#da4453"))}};
@@ -54,29 +56,72 @@ void MarkerListModel::setup()
     connect(this, &MarkerListModel::dataChanged, this, &MarkerListModel::modelChanged);
 }
 
-bool MarkerListModel::hasMarker(GenTime pos) const
+std::multimap<double, int>::const_iterator MarkerListModel::findPosition(const GenTime &pos) const
 {
-    std::map<int, CommentedTime>::const_iterator it = m_markerList.begin();
-    while (it != m_markerList.end()) {
-        if (it->second.time() == pos) {
-            return true;
+    // GenTime comparison is fuzzy, so a matching marker is either the first one after pos or the last one before it
+    auto it = m_markerPositions.lower_bound(pos.seconds());
+    if (it != m_markerPositions.end() && m_markerList.at(it->second).time() == pos) {
+        return it;
+    }
+    if (it != m_markerPositions.begin()) {
+        auto previous = std::prev(it);
+        if (m_markerList.at(previous->second).time() == pos) {
+            return previous;
         }
-        it++;
     }
-    return false;
+    return m_markerPositions.end();
 }
 
+void MarkerListModel::insertMarker(int mid, const CommentedTime &marker)
+{
+    m_markerList[mid] = marker;
+    m_markerPositions.emplace(marker.time().seconds(), mid);
+    m_markerRows.insert(std::lower_bound(m_markerRows.begin(), m_markerRows.end(), mid), mid);
+}
 
-CommentedTime MarkerListModel::marker(GenTime pos) const
+void MarkerListModel::eraseRows(int first, int last)
 {
-    std::map<int, CommentedTime>::const_iterator it = m_markerList.begin();
-    while (it != m_markerList.end()) {
-        if (it->second.time() == pos) {
-            return it->second;
+    for (int row = first; row <= last; ++row) {
+        int mid = m_markerRows.at(size_t(row));
+        auto range = m_markerPositions.equal_range(m_markerList.at(mid).time().seconds());
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == mid) {
+                m_markerPositions.erase(it);
+                break;
+            }
         }
-        it++;
+        m_markerList.erase(mid);
     }
-    return CommentedTime();
+    m_markerRows.erase(m_markerRows.begin() + first, m_markerRows.begin() + last + 1);
+}
+
+void MarkerListModel::setMarkerTime(int mid, const GenTime &pos)
+{
+    auto range = m_markerPositions.equal_range(m_markerList.at(mid).time().seconds());
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == mid) {
+            m_markerPositions.erase(it);
+            break;
+        }
+    }
+    m_markerList[mid].setTime(pos);
+    m_markerPositions.emplace(pos.seconds(), mid);
+}
+
+bool MarkerListModel::hasMarker(GenTime pos) const
+{
+    READ_LOCK();
+    return findPosition(pos) != m_markerPositions.end();
+}
+
+CommentedTime MarkerListModel::marker(GenTime pos) const
+{
+    READ_LOCK();
+    auto it = findPosition(pos);
+    if (it == m_markerPositions.end()) {
+        return CommentedTime();
+    }
+    return m_markerList.at(it->second);
 }
 
 bool MarkerListModel::addMarker(GenTime pos, const QString &comment, int type, Fun &undo, Fun &redo)
@@ -110,16 +155,17 @@ bool MarkerListModel::addMarkers(const QMap <GenTime, QString> &markers, int typ
     Fun undo = []() { return true; };
     Fun redo = []() { return true; };
 
-    QMapIterator<GenTime, QString> i(markers);
+    QList<CommentedTime> list;
     bool rename = false;
-    bool res = true;
-    while (i.hasNext() && res) {
+    QMapIterator<GenTime, QString> i(markers);
+    while (i.hasNext()) {
         i.next();
         if (hasMarker(i.key())) {
             rename = true;
         }
-        res = addMarker(i.key(), i.value(), type, undo, redo);
+        list << CommentedTime(i.key(), i.value(), type);
     }
+    bool res = addMarkers(list, undo, redo);
     if (res) {
         if (rename) {
             PUSH_UNDO(undo, redo, m_guide ? i18n("Rename guide") : i18n("Rename marker"));
@@ -130,6 +176,63 @@ bool MarkerListModel::addMarkers(const QMap <GenTime, QString> &markers, int typ
     return res;
 }
 
+bool MarkerListModel::addMarkers(const QList<CommentedTime> &markers, Fun &undo, Fun &redo)
+{
+    QWriteLocker locker(&m_lock);
+    QList<CommentedTime> sorted = markers;
+    std::stable_sort(sorted.begin(), sorted.end());
+    QList<CommentedTime> added;
+    QList<GenTime> addedPositions;
+    QList<CommentedTime> renamed;
+    QList<CommentedTime> previous;
+    for (int i = 0; i < sorted.size(); ++i) {
+        CommentedTime marker = sorted.at(i);
+        if (i + 1 < sorted.size() && sorted.at(i + 1).time() == marker.time()) {
+            // Several markers at the same position, the last one wins
+            continue;
+        }
+        if (marker.markerType() == -1) {
+            marker.setMarkerType(KdenliveSettings::default_marker_type());
+        }
+        if (marker.markerType() < 0 || marker.markerType() >= int(markerTypes.size())) {
+            qCWarning(KDENLIVE_LOG) << "Invalid marker type" << marker.markerType();
+            return false;
+        }
+        auto it = findPosition(marker.time());
+        if (it != m_markerPositions.end()) {
+            // Existing marker, we simply change the comment and type
+            const CommentedTime &current = m_markerList.at(it->second);
+            previous << CommentedTime(current.time(), current.comment(), current.markerType());
+            renamed << CommentedTime(current.time(), marker.comment(), marker.markerType());
+        } else {
+            added << marker;
+            addedPositions << marker.time();
+        }
+    }
+    Fun local_undo = []() { return true; };
+    Fun local_redo = []() { return true; };
+    if (!renamed.isEmpty()) {
+        Fun operation = changeComments_lambda(renamed);
+        Fun reverse = changeComments_lambda(previous);
+        if (!operation()) {
+            return false;
+        }
+        UPDATE_UNDO_REDO(operation, reverse, local_undo, local_redo);
+    }
+    if (!added.isEmpty()) {
+        Fun operation = addMarkers_lambda(added);
+        Fun reverse = deleteMarkers_lambda(addedPositions);
+        if (!operation()) {
+            bool undone = local_undo();
+            Q_ASSERT(undone);
+            return false;
+        }
+        UPDATE_UNDO_REDO(operation, reverse, local_undo, local_redo);
+    }
+    UPDATE_UNDO_REDO(local_redo, local_undo, undo, redo);
+    return true;
+}
+
 bool MarkerListModel::addMarker(GenTime pos, const QString &comment, int type)
 {
     QWriteLocker locker(&m_lock);
@@ -177,6 +280,47 @@ bool MarkerListModel::removeMarker(GenTime pos)
     return res;
 }
 
+bool MarkerListModel::removeMarkers(const QList<GenTime> &positions, Fun &undo, Fun &redo)
+{
+    QWriteLocker locker(&m_lock);
+    QList<CommentedTime> removed;
+    QList<GenTime> removedPositions;
+    std::unordered_set<int> ids;
+    for (const auto &pos : positions) {
+        auto it = findPosition(pos);
+        if (it == m_markerPositions.end()) {
+            return false;
+        }
+        if (ids.insert(it->second).second) {
+            removed << m_markerList.at(it->second);
+            removedPositions << m_markerList.at(it->second).time();
+        }
+    }
+    if (removed.isEmpty()) {
+        return true;
+    }
+    Fun local_undo = addMarkers_lambda(removed);
+    Fun local_redo = deleteMarkers_lambda(removedPositions);
+    if (local_redo()) {
+        UPDATE_UNDO_REDO(local_redo, local_undo, undo, redo);
+        return true;
+    }
+    return false;
+}
+
+bool MarkerListModel::removeMarkers(const QList<GenTime> &positions)
+{
+    QWriteLocker locker(&m_lock);
+    Fun undo = []() { return true; };
+    Fun redo = []() { return true; };
+
+    bool res = removeMarkers(positions, undo, redo);
+    if (res) {
+        PUSH_UNDO(undo, redo, m_guide ? i18n("Delete guides") : i18n("Delete markers"));
+    }
+    return res;
+}
+
 bool MarkerListModel::editMarker(GenTime oldPos, GenTime pos, QString comment, int type)
 {
     QWriteLocker locker(&m_lock);
@@ -208,20 +352,14 @@ int MarkerListModel::getRowfromId(int mid) const
 {
     READ_LOCK();
     Q_ASSERT(m_markerList.count(mid) > 0);
-    return (int)std::distance(m_markerList.begin(), m_markerList.find(mid));
+    return int(std::lower_bound(m_markerRows.begin(), m_markerRows.end(), mid) - m_markerRows.begin());
 }
 
 int MarkerListModel::getIdFromPos(const GenTime &pos) const
 {
     READ_LOCK();
-    std::map<int, CommentedTime>::const_iterator it = m_markerList.begin();
-    while (it != m_markerList.end()) {
-        if (it->second.time() == pos) {
-            return it->first;
-        }
-        it++;
-    }
-    return -1;
+    auto it = findPosition(pos);
+    return it == m_markerPositions.end() ? -1 : it->second;
 }
 
 bool MarkerListModel::moveMarker(int mid, GenTime pos)
@@ -233,7 +371,7 @@ bool MarkerListModel::moveMarker(int mid, GenTime pos)
         return false;
     }
     int row = getRowfromId(mid);
-    m_markerList[mid].setTime(pos);
+    setMarkerTime(mid, pos);
     emit dataChanged(index(row), index(row), {FrameRole});
     return true;
 }
@@ -249,7 +387,7 @@ void MarkerListModel::moveMarkersWithoutUndo(const QVector<int> &markersId, int
     for (auto mid : markersId) {
         Q_ASSERT(m_markerList.count(mid) > 0);
         GenTime t = m_markerList.at(mid).time() + GenTime(offset, pCore->getCurrentFps());
-        m_markerList[mid].setTime(t);
+        setMarkerTime(mid, t);
         if (!updateView) {
             continue;
         }
@@ -325,7 +463,7 @@ Fun MarkerListModel::addMarker_lambda(GenTime pos, const QString &comment, int t
         int mid = TimelineModel::getNextId();
         int insertionRow = static_cast<int>(model->m_markerList.size());
         model->beginInsertRows(QModelIndex(), insertionRow, insertionRow);
-        model->m_markerList[mid] = CommentedTime(pos, comment, type);
+        model->insertMarker(mid, CommentedTime(pos, comment, type));
         model->endInsertRows();
         model->addSnapPoint(pos);
         return true;
@@ -343,13 +481,105 @@ Fun MarkerListModel::deleteMarker_lambda(GenTime pos)
         int mid = model->getIdFromPos(pos);
         int row = model->getRowfromId(mid);
         model->beginRemoveRows(QModelIndex(), row, row);
-        model->m_markerList.erase(mid);
+        model->eraseRows(row, row);
         model->endRemoveRows();
         model->removeSnapPoint(pos);
         return true;
     };
 }
 
+Fun MarkerListModel::changeComments_lambda(const QList<CommentedTime> &markers)
+{
+    QWriteLocker locker(&m_lock);
+    auto guide = m_guide;
+    auto clipId = m_clipId;
+    return [guide, clipId, markers]() {
+        auto model = getModel(guide, clipId);
+        int firstRow = -1;
+        int lastRow = -1;
+        for (const auto &marker : markers) {
+            int mid = model->getIdFromPos(marker.time());
+            Q_ASSERT(mid > -1);
+            if (mid == -1) {
+                continue;
+            }
+            model->m_markerList[mid].setComment(marker.comment());
+            model->m_markerList[mid].setMarkerType(marker.markerType());
+            int row = model->getRowfromId(mid);
+            firstRow = firstRow == -1 ? row : qMin(firstRow, row);
+            lastRow = qMax(lastRow, row);
+        }
+        if (firstRow > -1) {
+            emit model->dataChanged(model->index(firstRow), model->index(lastRow), {CommentRole, ColorRole});
+        }
+        return true;
+    };
+}
+
+Fun MarkerListModel::addMarkers_lambda(const QList<CommentedTime> &markers)
+{
+    QWriteLocker locker(&m_lock);
+    auto guide = m_guide;
+    auto clipId = m_clipId;
+    return [guide, clipId, markers]() {
+        auto model = getModel(guide, clipId);
+        if (markers.isEmpty()) {
+            return true;
+        }
+        // New ids are always larger than the existing ones, so the markers are appended
+        int insertionRow = static_cast<int>(model->m_markerList.size());
+        std::vector<int> frames;
+        frames.reserve(size_t(markers.size()));
+        model->beginInsertRows(QModelIndex(), insertionRow, insertionRow + markers.size() - 1);
+        for (const auto &marker : markers) {
+            Q_ASSERT(model->hasMarker(marker.time()) == false);
+            model->insertMarker(TimelineModel::getNextId(), marker);
+            frames.push_back(marker.time().frames(pCore->getCurrentFps()));
+        }
+        model->endInsertRows();
+        model->addSnapPoints(frames);
+        return true;
+    };
+}
+
+Fun MarkerListModel::deleteMarkers_lambda(const QList<GenTime> &positions)
+{
+    QWriteLocker locker(&m_lock);
+    auto guide = m_guide;
+    auto clipId = m_clipId;
+    return [guide, clipId, positions]() {
+        auto model = getModel(guide, clipId);
+        std::vector<int> rows;
+        std::vector<int> frames;
+        rows.reserve(size_t(positions.size()));
+        frames.reserve(size_t(positions.size()));
+        for (const auto &pos : positions) {
+            int mid = model->getIdFromPos(pos);
+            Q_ASSERT(mid > -1);
+            if (mid == -1) {
+                continue;
+            }
+            rows.push_back(model->getRowfromId(mid));
+            frames.push_back(pos.frames(pCore->getCurrentFps()));
+        }
+        std::sort(rows.begin(), rows.end());
+        // Remove each block of consecutive rows at once, starting from the end so that the remaining rows don't move
+        size_t end = rows.size();
+        while (end > 0) {
+            size_t start = end - 1;
+            while (start > 0 && rows[start - 1] == rows[start] - 1) {
+                --start;
+            }
+            model->beginRemoveRows(QModelIndex(), rows[start], rows[end - 1]);
+            model->eraseRows(rows[start], rows[end - 1]);
+            model->endRemoveRows();
+            end = start;
+        }
+        model->removeSnapPoints(frames);
+        return true;
+    };
+}
+
 std::shared_ptr<MarkerListModel> MarkerListModel::getModel(bool guide, const QString &clipId)
 {
     if (guide) {
@@ -371,13 +601,20 @@ QHash<int, QByteArray> MarkerListModel::roleNames() const
 }
 
 void MarkerListModel::addSnapPoint(GenTime pos)
+{
+    addSnapPoints({pos.frames(pCore->getCurrentFps())});
+}
+
+void MarkerListModel::addSnapPoints(const std::vector<int> &frames)
 {
     QWriteLocker locker(&m_lock);
     std::vector<std::weak_ptr<SnapInterface>> validSnapModels;
     for (const auto &snapModel : m_registeredSnaps) {
         if (auto ptr = snapModel.lock()) {
             validSnapModels.push_back(snapModel);
-            ptr->addPoint(pos.frames(pCore->getCurrentFps()));
+            for (int frame : frames) {
+                ptr->addPoint(frame);
+            }
         }
     }
     // Update the list of snapModel known to be valid
@@ -385,13 +622,20 @@ void MarkerListModel::addSnapPoint(GenTime pos)
 }
 
 void MarkerListModel::removeSnapPoint(GenTime pos)
+{
+    removeSnapPoints({pos.frames(pCore->getCurrentFps())});
+}
+
+void MarkerListModel::removeSnapPoints(const std::vector<int> &frames)
 {
     QWriteLocker locker(&m_lock);
     std::vector<std::weak_ptr<SnapInterface>> validSnapModels;
     for (const auto &snapModel : m_registeredSnaps) {
         if (auto ptr = snapModel.lock()) {
             validSnapModels.push_back(snapModel);
-            ptr->removePoint(pos.frames(pCore->getCurrentFps()));
+            for (int frame : frames) {
+                ptr->removePoint(frame);
+            }
         }
     }
     // Update the list of snapModel known to be valid
@@ -404,25 +648,25 @@ QVariant MarkerListModel::data(const QModelIndex &index, int role) const
     if (index.row() < 0 || index.row() >= static_cast<int>(m_markerList.size()) || !index.isValid()) {
         return QVariant();
     }
-    auto it = m_markerList.begin();
-    std::advance(it, index.row());
+    int mid = m_markerRows.at(size_t(index.row()));
+    const CommentedTime &marker = m_markerList.at(mid);
     switch (role) {
     case Qt::DisplayRole:
     case Qt::EditRole:
     case CommentRole:
-        return it->second.comment();
+        return marker.comment();
     case PosRole:
-        return it->second.time().seconds();
+        return marker.time().seconds();
     case FrameRole:
     case Qt::UserRole:
-        return it->second.time().frames(pCore->getCurrentFps());
+        return marker.time().frames(pCore->getCurrentFps());
     case ColorRole:
     case Qt::DecorationRole:
-        return markerTypes[size_t(it->second.markerType())];
+        return markerTypes[size_t(marker.markerType())];
     case TypeRole:
-        return it->second.markerType();
+        return marker.markerType();
     case IdRole:
-        return it->first;
+        return mid;
     }
     return QVariant();
 }
@@ -450,12 +694,12 @@ QList<CommentedTime> MarkerListModel::getAllMarkers(int type) const
 {
     READ_LOCK();
     QList<CommentedTime> markers;
-    for (const auto &marker : m_markerList) {
-        if (type == -1 || marker.second.markerType() == type) {
-            markers << marker.second;
+    for (const auto &entry : m_markerPositions) {
+        const CommentedTime &marker = m_markerList.at(entry.second);
+        if (type == -1 || marker.markerType() == type) {
+            markers << marker;
         }
     }
-    std::sort(markers.begin(), markers.end());
     return markers;
 }
 
@@ -463,13 +707,10 @@ QList<CommentedTime> MarkerListModel::getMarkersInRange(int start, int end) cons
 {
     READ_LOCK();
     QList<CommentedTime> markers;
-    for (const auto &marker : m_markerList) {
-        int pos = marker.second.time().frames(pCore->getCurrentFps());
-        if(pos >= start && (end == -1 || pos <= end)) {
-            markers << marker.second;
-        }
+    const QVector<int> ids = getMarkersIdInRange(start, end);
+    for (int mid : ids) {
+        markers << m_markerList.at(mid);
     }
-    std::sort(markers.begin(), markers.end());
     return markers;
 }
 
@@ -485,16 +726,16 @@ QVector<int> MarkerListModel::getMarkersIdInRange(int start, int end) const
 {
     READ_LOCK();
     QVector<int> markers;
-    // Ensure we provide sorted markers list
-    std::map<CommentedTime,int> sortedList;
-
-    for(std::map<int, CommentedTime>::const_iterator it = m_markerList.begin(); it != m_markerList.end(); ++it)
-        sortedList.insert(std::pair<CommentedTime, int>(it -> second, it -> first));
-
-    for (const auto &marker : sortedList) {
-        int pos = marker.first.time().frames(pCore->getCurrentFps());
-        if(pos >= start && (end == -1 || pos <= end)) {
-            markers << marker.second;
+    double fps = pCore->getCurrentFps();
+    // Start one frame early, a marker slightly before start can be rounded to the start frame
+    auto it = m_markerPositions.lower_bound(GenTime(start - 1, fps).seconds());
+    for (; it != m_markerPositions.end(); ++it) {
+        int pos = m_markerList.at(it->second).time().frames(fps);
+        if (end > -1 && pos > end) {
+            break;
+        }
+        if (pos >= start) {
+            markers << it->second;
         }
     }
     return markers;
@@ -504,8 +745,9 @@ std::vector<int> MarkerListModel::getSnapPoints() const
 {
     READ_LOCK();
     std::vector<int> markers;
-    for (const auto &marker : m_markerList) {
-        markers.push_back(marker.second.time().frames(pCore->getCurrentFps()));
+    markers.reserve(m_markerPositions.size());
+    for (const auto &entry : m_markerPositions) {
+        markers.push_back(m_markerList.at(entry.second).time().frames(pCore->getCurrentFps()));
     }
     return markers;
 }
@@ -526,7 +768,6 @@ void MarkerListModel::registerSnapModel(const std::weak_ptr<SnapInterface> &snap
 
         // we now add the already existing markers to the snap
         for (const auto &marker : m_markerList) {
-            qDebug() << " *- *-* REGISTERING MARKER: " << marker.second.time().frames(pCore->getCurrentFps());
             ptr->addPoint(marker.second.time().frames(pCore->getCurrentFps()));
         }
     } else {
@@ -555,6 +796,7 @@ bool MarkerListModel::importFromJson(const QString &data, bool ignoreConflicts,
         return false;
     }
     auto list = json.array();
+    QList<CommentedTime> markers;
     for (const auto &entry : qAsConst(list)) {
         if (!entry.isObject()) {
             qDebug() << "Warning : Skipping invalid marker data";
@@ -572,22 +814,17 @@ bool MarkerListModel::importFromJson(const QString &data, bool ignoreConflicts,
             qDebug() << "Warning : invalid type found:" << type << " Defaulting to 0";
             type = 0;
         }
-        bool res = true;
-        if (!ignoreConflicts && hasMarker(GenTime(pos, pCore->getCurrentFps()))) {
+        GenTime markerPos(pos, pCore->getCurrentFps());
+        if (!ignoreConflicts && hasMarker(markerPos)) {
             // potential conflict found, checking
-            CommentedTime oldMarker = marker(GenTime(pos, pCore->getCurrentFps()));
-            res = (oldMarker.comment() == comment) && (type == oldMarker.markerType());
-        }
-        qDebug() << "// ADDING MARKER AT POS: " << pos << ", FPS: " << pCore->getCurrentFps();
-        res = res && addMarker(GenTime(pos, pCore->getCurrentFps()), comment, type, undo, redo);
-        if (!res) {
-            bool undone = undo();
-            Q_ASSERT(undone);
-            return false;
+            CommentedTime oldMarker = marker(markerPos);
+            if (oldMarker.comment() != comment || type != oldMarker.markerType()) {
+                return false;
+            }
         }
+        markers << CommentedTime(markerPos, comment, type);
     }
-
-    return true;
+    return addMarkers(markers, undo, redo);
 }
 
 QString MarkerListModel::toJson() const
@@ -608,20 +845,14 @@ QString MarkerListModel::toJson() const
 bool MarkerListModel::removeAllMarkers()
 {
     QWriteLocker locker(&m_lock);
-    std::vector<GenTime> all_pos;
+    QList<GenTime> all_pos;
     Fun local_undo = []() { return true; };
     Fun local_redo = []() { return true; };
     for (const auto &m : m_markerList) {
-        all_pos.push_back(m.second.time());
+        all_pos << m.second.time();
     }
-    bool res = true;
-    for (const auto &p : all_pos) {
-        res = removeMarker(p, local_undo, local_redo);
-        if (!res) {
-            bool undone = local_undo();
-            Q_ASSERT(undone);
-            return false;
-        }
+    if (!removeMarkers(all_pos, local_undo, local_redo)) {
+        return false;
     }
     PUSH_UNDO(local_undo, local_redo, m_guide ? i18n("Delete all guides") : i18n("Delete all markers"));
     return true;
@@ -23,7 +23,7 @@ class SnapInterface;
 /** @class MarkerListModel
     @brief This class is the model for a list of markers.
     A marker is defined by a time, a type (the color used to represent it) and a comment string.
-    We store them in a sorted fashion using a std::map
+    We store them in a std::map indexed by id, along with a secondary index sorted by time so that position and range lookups don't need to walk the whole list
 
     A marker is essentially bound to a clip. We can also define guides, that are timeline-wise markers. For that, use the constructors without clipId
  */
@@ -47,6 +47,11 @@ public:
      */
     bool addMarker(GenTime pos, const QString &comment, int type = -1);
     bool addMarkers(const QMap <GenTime, QString> &markers, int type = -1);
+    /** @brief Adds a list of markers in one operation, with a single model insertion and snap update.
+       Markers at an existing position replace the comment and type of that marker, markers with a type of -1 use kdenlive's default type.
+       This is meant for large imports (scene detection, speech recognition)
+     */
+    bool addMarkers(const QList<CommentedTime> &markers, Fun &undo, Fun &redo);
 
 protected:
     /** @brief Same function but accumulates undo/redo */
@@ -63,6 +68,12 @@ public:
     /** @brief Same function but accumulates undo/redo */
     bool removeMarker(GenTime pos, Fun &undo, Fun &redo);
 
+    /** @brief Removes the markers at the given positions in one operation.
+       Returns false if a position has no marker, in which case nothing is removed
+     */
+    bool removeMarkers(const QList<GenTime> &positions);
+    bool removeMarkers(const QList<GenTime> &positions, Fun &undo, Fun &redo);
+
 public:
     /** @brief Edit a marker
        @param oldPos is the old position of the marker
@@ -92,7 +103,7 @@ public:
     /** @brief Returns all markers in model or – if a type is given – all markers of the given type */
     QList<CommentedTime> getAllMarkers(int type = -1) const;
 
-    /** @brief Returns all markers of model that are intersect with a given range.
+    /** @brief Returns all markers of model that are intersect with a given range, sorted by position.
      * @param start is the position where start to search for markers
      * @param end is the position after which markers will not be returned, set to -1 to get all markers after start
     */
@@ -153,10 +164,12 @@ protected:
     /** @brief Adds a snap point at marker position in the registered snap models
      (those that are still valid)*/
     void addSnapPoint(GenTime pos);
+    void addSnapPoints(const std::vector<int> &frames);
 
     /** @brief Deletes a snap point at marker position in the registered snap models
        (those that are still valid)*/
     void removeSnapPoint(GenTime pos);
+    void removeSnapPoints(const std::vector<int> &frames);
 
     /** @brief Helper function that generate a lambda to change comment / type of given marker */
     Fun changeComment_lambda(GenTime pos, const QString &comment, int type);
@@ -167,6 +180,11 @@ protected:
     /** @brief Helper function that generate a lambda to remove given marker */
     Fun deleteMarker_lambda(GenTime pos);
 
+    /** @brief Helper functions that generate a lambda to change / add / remove a list of markers at once */
+    Fun changeComments_lambda(const QList<CommentedTime> &markers);
+    Fun addMarkers_lambda(const QList<CommentedTime> &markers);
+    Fun deleteMarkers_lambda(const QList<GenTime> &positions);
+
     /** @brief Helper function that retrieves a pointer to the markermodel, given whether it's a guide model and its clipId*/
     static std::shared_ptr<MarkerListModel> getModel(bool guide, const QString &clipId);
 
@@ -184,9 +202,19 @@ private:
     mutable QReadWriteLock m_lock;
 
     std::map<int, CommentedTime> m_markerList;
+    /** @brief Secondary index of the marker ids sorted by position (in seconds, so that it doesn't depend on the fps) */
+    std::multimap<double, int> m_markerPositions;
+    /** @brief The marker ids in row order */
+    std::vector<int> m_markerRows;
     std::vector<std::weak_ptr<SnapInterface>> m_registeredSnaps;
     int getRowfromId(int mid) const;
     int getIdFromPos(const GenTime &pos) const;
+    /** @brief Returns the index entry of the marker at given pos, or m_markerPositions.end() */
+    std::multimap<double, int>::const_iterator findPosition(const GenTime &pos) const;
+    /** @brief Insert / remove / move a marker in the list and its indexes, without any signal */
+    void insertMarker(int mid, const CommentedTime &marker);
+    void eraseRows(int first, int last);
+    void setMarkerTime(int mid, const GenTime &pos);
 
 signals:
     void modelChanged();
@@ -17,6 +17,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "jobs/audiolevelstask.h"
 #include "jobs/cachetask.h"
 #include "jobs/cliploadtask.h"
+#include "jobs/ingestanalysistask.h"
 #include "jobs/proxytask.h"
 #include "kdenlivesettings.h"
 #include "lib/audio/audioStreamInfo.h"
@@ -558,7 +559,10 @@ bool ProjectClip::setProducer(std::shared_ptr<Mlt::Producer> producer, bool gene
         // Generate video thumb
         ClipLoadTask::start({ObjectType::BinClip,m_binId.toInt()}, QDomElement(), true, -1, -1, this);
     }
-    if (KdenliveSettings::audiothumbnails() && (m_clipType == ClipType::AV || m_clipType == ClipType::Audio || m_clipType == ClipType::Playlist || m_clipType == ClipType::Unknown)) {
+    if (KdenliveSettings::ingestanalysis() && (m_clipType == ClipType::AV || m_clipType == ClipType::Video || m_clipType == ClipType::Audio)) {
+        // Decode the file once for audio levels, hover thumbnails, loudness and optionally scene changes, audio levels of extra streams are started from there
+        IngestAnalysisTask::start({ObjectType::BinClip, m_binId.toInt()}, this, false);
+    } else if (KdenliveSettings::audiothumbnails() && (m_clipType == ClipType::AV || m_clipType == ClipType::Audio || m_clipType == ClipType::Playlist || m_clipType == ClipType::Unknown)) {
         AudioLevelsTask::start({ObjectType::BinClip, m_binId.toInt()}, this, false);
     }
     pCore->bin()->reloadMonitorIfActive(clipId());
@@ -633,7 +637,10 @@ bool ProjectClip::setProducer(std::shared_ptr<Mlt::Producer> producer, bool gene
     }
     if (!generateProxy && KdenliveSettings::hoverPreview() && (m_clipType == ClipType::AV || m_clipType == ClipType::Video || m_clipType == ClipType::Playlist)) {
         QTimer::singleShot(1000, this, [this]() {
-            CacheTask::start({ObjectType::BinClip,m_binId.toInt()}, 30, 0, 0, this);
+            // The ingest analysis already extracts the hover thumbnails
+            if (!pCore->taskManager.hasPendingJob({ObjectType::BinClip, m_binId.toInt()}, AbstractTask::INGESTJOB)) {
+                CacheTask::start({ObjectType::BinClip,m_binId.toInt()}, 30, 0, 0, this);
+            }
         });
     }
     if (generateProxy) {
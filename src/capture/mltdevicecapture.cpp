@@ -7,6 +7,7 @@
 
 #include "definitions.h"
 #include "kdenlivesettings.h"
+#include "utils/colorconversion.h"
 
 #include <mlt++/Mlt.h>
 
@@ -193,28 +194,31 @@ void MltDeviceCapture::emitFrameUpdated(Mlt::Frame &frame)
     }
     */
 
-    mlt_image_format format = mlt_image_rgb;
+    // Capture devices deliver yuv422, convert it ourselves in a reusable buffer instead of going through an rgb copy
+    mlt_image_format format = mlt_image_yuv422;
     int width = 0;
     int height = 0;
     const uchar *image = frame.get_image(format, width, height);
-    QImage qimage(width, height, QImage::Format_RGB888);
-    // QImage qimage(width, height, QImage::Format_ARGB32_Premultiplied);
-    memcpy(qimage.bits(), image, size_t(width * height * 3));
-    emit frameUpdated(qimage);
+    if (image == nullptr) {
+        return;
+    }
+    emit frameUpdated(yuv422ToImage(image, width, height));
 }
 
 void MltDeviceCapture::showFrame(Mlt::Frame &frame)
 {
-    mlt_image_format format = mlt_image_rgb;
+    mlt_image_format format = mlt_image_yuv422;
     int width = 0;
     int height = 0;
     const uchar *image = frame.get_image(format, width, height);
-    QImage qimage(width, height, QImage::Format_RGB888);
-    memcpy(qimage.scanLine(0), image, static_cast<size_t>(width * height * 3));
+    if (image == nullptr) {
+        return;
+    }
+    const QImage qimage = yuv422ToImage(image, width, height);
     emit showImageSignal(qimage);
 
     if (sendFrameForAnalysis && (frame.get_frame()->convert_image != nullptr)) {
-        emit frameUpdated(qimage.rgbSwapped());
+        emit frameUpdated(qimage);
     }
 }
 
@@ -587,84 +591,20 @@ void MltDeviceCapture::mirror(bool activate)
     mlt_service_unlock(service.get_service());
 }
 
+QImage MltDeviceCapture::yuv422ToImage(const uchar *image, int width, int height)
+{
+    return m_previewPool.fill(width, height, QImage::Format_RGB32, [image, width, height](uchar *bits, int bytesPerLine) {
+        ColorConversion::yuyvToRgb32(image, ((width + 1) / 2) * 4, bits, bytesPerLine, width, height);
+    });
+}
+
 void MltDeviceCapture::uyvy2rgb(const unsigned char *yuv_buffer, int width, int height)
 {
     processingImage = true;
-    QImage image(width, height, QImage::Format_RGB888);
-    unsigned char *rgb_buffer = image.bits();
-
-    int rgb_ptr = 0, y_ptr = 0;
-    int len = width * height / 2;
-
-    for (int t = 0; t < len; ++t) {
-        int Y = yuv_buffer[y_ptr];
-        int U = yuv_buffer[y_ptr + 1];
-        int Y2 = yuv_buffer[y_ptr + 2];
-        int V = yuv_buffer[y_ptr + 3];
-        y_ptr += 4;
-
-        int r = ((298 * (Y - 16) + 409 * (V - 128) + 128) >> 8);
-
-        int g = ((298 * (Y - 16) - 100 * (U - 128) - 208 * (V - 128) + 128) >> 8);
-
-        int b = ((298 * (Y - 16) + 516 * (U - 128) + 128) >> 8);
-
-        if (r > 255) {
-            r = 255;
-        }
-        if (g > 255) {
-            g = 255;
-        }
-        if (b > 255) {
-            b = 255;
-        }
-
-        if (r < 0) {
-            r = 0;
-        }
-        if (g < 0) {
-            g = 0;
-        }
-        if (b < 0) {
-            b = 0;
-        }
-
-        rgb_buffer[rgb_ptr] = static_cast<uchar>(r);
-        rgb_buffer[rgb_ptr + 1] = static_cast<uchar>(g);
-        rgb_buffer[rgb_ptr + 2] = static_cast<uchar>(b);
-        rgb_ptr += 3;
-
-        r = ((298 * (Y2 - 16) + 409 * (V - 128) + 128) >> 8);
-        g = ((298 * (Y2 - 16) - 100 * (U - 128) - 208 * (V - 128) + 128) >> 8);
-        b = ((298 * (Y2 - 16) + 516 * (U - 128) + 128) >> 8);
-
-        if (r > 255) {
-            r = 255;
-        }
-        if (g > 255) {
-            g = 255;
-        }
-        if (b > 255) {
-            b = 255;
-        }
-
-        if (r < 0) {
-            r = 0;
-        }
-        if (g < 0) {
-            g = 0;
-        }
-        if (b < 0) {
-            b = 0;
-        }
-
-        rgb_buffer[rgb_ptr] = static_cast<uchar>(r);
-        rgb_buffer[rgb_ptr + 1] = static_cast<uchar>(g);
-        rgb_buffer[rgb_ptr + 2] = static_cast<uchar>(b);
-        rgb_ptr += 3;
-    }
-    // emit imageReady(image);
-    // m_captureDisplayWidget->setImage(image);
+    QImage image = m_previewPool.fill(width, height, QImage::Format_RGB32, [yuv_buffer, width, height](uchar *bits, int bytesPerLine) {
+        ColorConversion::yuyvToRgb32(yuv_buffer, ((width + 1) / 2) * 4, bits, bytesPerLine, width, height);
+    });
+    emit imageReady(image);
     emit unblockPreview();
     // processingImage = false;
 }
@@ -8,6 +8,7 @@
 #include "definitions.h"
 #include "gentime.h"
 #include "monitor/abstractmonitor.h"
+#include "utils/colorconversion.h"
 
 #include <QMutex>
 #include <QTimer>
@@ -92,7 +93,12 @@ private:
     /** @brief Count captured frames, used to display only one in ten images while capturing. */
     int m_frameCount{};
 
+    /** @brief Pool of preview images, reused once the previous frames are not displayed anymore */
+    ImagePool m_previewPool;
+
     void uyvy2rgb(const unsigned char *yuv_buffer, int width, int height);
+    /** @brief Convert a yuv422 frame from MLT to an RGB32 image using the preview pool */
+    QImage yuv422ToImage(const uchar *image, int width, int height);
 
     QString m_capturePath;
 
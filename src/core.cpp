@@ -27,6 +27,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "timeline2/model/timelineitemmodel.hpp"
 #include "timeline2/view/timelinecontroller.h"
 #include "timeline2/view/timelinewidget.h"
+#include "utils/startuptimeline.hpp"
 #include <mlt++/MltRepository.h>
 
 #include <KMessageBox>
@@ -119,6 +120,7 @@ void Core::initGUI(bool inSandbox, const QString &MltPath, const QUrl &Url, cons
     m_profile = KdenliveSettings::default_profile();
     m_currentProfile = m_profile;
     m_mainWindow = new MainWindow();
+    StartupTimeline::mark(QStringLiteral("Main window created"));
     m_guiConstructed = true;
     QStringList styles = QQuickStyle::availableStyles();
     if (styles.contains(QLatin1String("org.kde.desktop"))) {
@@ -149,6 +151,7 @@ void Core::initGUI(bool inSandbox, const QString &MltPath, const QUrl &Url, cons
     m_mixerWidget = new MixerManager(m_mainWindow);
     m_textEditWidget = new TextBasedEdit(m_mainWindow);
     m_timeRemapWidget = new TimeRemap(m_mainWindow);
+    StartupTimeline::mark(QStringLiteral("Panels created"));
     connect(m_library, SIGNAL(addProjectClips(QList<QUrl>)), m_mainWindow->getBin(), SLOT(droppedUrls(QList<QUrl>)));
     connect(this, &Core::updateLibraryPath, m_library, &LibraryWidget::slotUpdateLibraryPath);
     connect(m_capture.get(), &MediaCapture::recordStateChanged, m_mixerWidget, &MixerManager::recordStateChanged);
@@ -176,6 +179,7 @@ void Core::initGUI(bool inSandbox, const QString &MltPath, const QUrl &Url, cons
         // Open connection with Mlt
         m_mainWindow->init(MltPath);
     }
+    StartupTimeline::mark(QStringLiteral("Main window initialized"));
     m_projectItemModel->buildPlaylist();
     // load the profiles from disk
     ProfileRepository::get()->refresh();
@@ -229,12 +233,14 @@ void Core::initGUI(bool inSandbox, const QString &MltPath, const QUrl &Url, cons
         emit loadingMessageUpdated(i18n("Loading project…"));
     }
     projectManager()->init(Url, clipsToLoad);
+    StartupTimeline::mark(QStringLiteral("Project manager initialized"));
     if (qApp->isSessionRestored()) {
         // NOTE: we are restoring only one window, because Kdenlive only uses one MainWindow
         m_mainWindow->restore(1, false);
     }
     QMetaObject::invokeMethod(pCore->projectManager(), "slotLoadOnOpen", Qt::QueuedConnection);
     m_mainWindow->show();
+    StartupTimeline::mark(QStringLiteral("Main window shown"));
     bin->slotUpdatePalette();
     emit m_mainWindow->GUISetupDone();
 }
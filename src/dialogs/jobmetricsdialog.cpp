@@ -0,0 +1,94 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "jobmetricsdialog.h"
+#include "core.h"
+#include "jobs/taskmanager.h"
+
+#include <KLocalizedString>
+#include <KIO/Global>
+#include <KMessageBox>
+#include <QApplication>
+#include <QClipboard>
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QJsonDocument>
+#include <QPushButton>
+#include <QSaveFile>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+JobMetricsDialog::JobMetricsDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle(i18n("Job Statistics"));
+    auto *lay = new QVBoxLayout(this);
+    m_tree = new QTreeWidget(this);
+    m_tree->setRootIsDecorated(false);
+    m_tree->setHeaderLabels({i18n("Job"), i18n("Done"), i18n("Canceled"), i18n("Average queue time"), i18n("Maximum queue time"), i18n("Average run time"),
+                             i18n("Maximum run time"), i18n("Source size"), i18n("Frames decoded"), i18n("Average cancel latency"), i18n("Running"),
+                             i18n("Maximum concurrent")});
+    lay->addWidget(m_tree);
+    auto *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    QPushButton *reset = buttonBox->addButton(i18n("Reset"), QDialogButtonBox::ResetRole);
+    QPushButton *copy = buttonBox->addButton(i18n("Copy as JSON"), QDialogButtonBox::ActionRole);
+    QPushButton *save = buttonBox->addButton(i18n("Save…"), QDialogButtonBox::ActionRole);
+    connect(reset, &QPushButton::clicked, this, &JobMetricsDialog::resetMetrics);
+    connect(copy, &QPushButton::clicked, this, &JobMetricsDialog::copyMetrics);
+    connect(save, &QPushButton::clicked, this, &JobMetricsDialog::saveMetrics);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    lay->addWidget(buttonBox);
+    // Jobs keep running while the dialog is open
+    m_refreshTimer.setInterval(1000);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &JobMetricsDialog::updateMetrics);
+    m_refreshTimer.start();
+    updateMetrics();
+    resize(900, 300);
+}
+
+void JobMetricsDialog::updateMetrics()
+{
+    auto formatTime = [](qint64 ms) { return i18n("%1 s", QString::number(ms / 1000., 'f', 2)); };
+    m_tree->clear();
+    for (const auto &metrics : pCore->taskManager.jobMetrics()) {
+        const JobMetrics &m = metrics.second;
+        const int done = m.finished + m.canceled;
+        QStringList values;
+        values << TaskManager::jobTypeName(metrics.first) << QString::number(m.finished) << QString::number(m.canceled);
+        values << formatTime(done > 0 ? m.queueTime / done : 0) << formatTime(m.maxQueueTime);
+        values << formatTime(done > 0 ? m.runTime / done : 0) << formatTime(m.maxRunTime);
+        values << KIO::convertSize(KIO::filesize_t(m.sourceBytes)) << QString::number(m.framesDecoded);
+        values << (m.canceled > 0 ? formatTime(m.cancelLatency / m.canceled) : QString());
+        values << QString::number(m.running) << QString::number(m.maxRunning);
+        new QTreeWidgetItem(m_tree, values);
+    }
+    for (int i = 0; i < m_tree->columnCount(); ++i) {
+        m_tree->resizeColumnToContents(i);
+    }
+}
+
+void JobMetricsDialog::resetMetrics()
+{
+    pCore->taskManager.resetMetrics();
+    updateMetrics();
+}
+
+void JobMetricsDialog::copyMetrics()
+{
+    QApplication::clipboard()->setText(QString::fromUtf8(QJsonDocument(pCore->taskManager.metricsJson()).toJson()));
+}
+
+void JobMetricsDialog::saveMetrics()
+{
+    const QString path = QFileDialog::getSaveFileName(this, i18n("Save Job Statistics"), QString(), i18n("JSON Files (*.json)"));
+    if (path.isEmpty()) {
+        return;
+    }
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(pCore->taskManager.metricsJson()).toJson()) < 0 || !file.commit()) {
+        KMessageBox::error(this, i18n("Cannot write to file %1", path));
+    }
+}
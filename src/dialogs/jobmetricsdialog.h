@@ -0,0 +1,35 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QDialog>
+#include <QTimer>
+
+class QTreeWidget;
+
+/**
+ * @class JobMetricsDialog
+ * @brief Displays the metrics of the background jobs collected by the TaskManager, by job type.
+ * The metrics can be exported as JSON to compare the effect of the concurrency settings.
+ */
+class JobMetricsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit JobMetricsDialog(QWidget *parent = nullptr);
+
+private slots:
+    void updateMetrics();
+    void resetMetrics();
+    void copyMetrics();
+    void saveMetrics();
+
+private:
+    QTreeWidget *m_tree;
+    QTimer m_refreshTimer;
+};
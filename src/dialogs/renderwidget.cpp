@@ -50,6 +50,7 @@
 #include <QTemporaryFile>
 #include <QThread>
 #include <QTreeWidgetItem>
+#include <QXmlStreamReader>
 #include <qglobal.h>
 #include <qstring.h>
 
@@ -71,7 +72,10 @@ enum {
     ExtraInfoRole = ProgressRole + 2, // vpinon: don't understand why, else spurious message displayed
     LastTimeRole,
     LastFrameRole,
-    OpenBrowserRole
+    OpenBrowserRole,
+    ResourcesRole,
+    OutputsRole,
+    FramesRole
 };
 
 // Running job status
@@ -209,6 +213,22 @@ RenderWidget::RenderWidget(bool enableProxy, QWidget *parent)
     connect(m_view.encoder_threads, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &KdenliveSettings::setEncodethreads);
     connect(m_view.encoder_threads, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &RenderWidget::refreshParams);
 
+    m_view.thread_budget->setMaximum(4 * QThread::idealThreadCount());
+    m_view.thread_budget->setValue(KdenliveSettings::renderthreadbudget());
+    connect(m_view.thread_budget, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, [this](int value) {
+        KdenliveSettings::setRenderthreadbudget(value);
+        checkRenderStatus();
+    });
+    m_view.extra_outputs->setMenu(new QMenu(this));
+    connect(m_view.extra_outputs->menu(), &QMenu::aboutToShow, this, &RenderWidget::buildExtraOutputsMenu);
+    updateExtraOutputsButton();
+
+    m_view.memory_budget->setValue(KdenliveSettings::rendermemorybudget());
+    connect(m_view.memory_budget, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, [this](int value) {
+        KdenliveSettings::setRendermemorybudget(value);
+        checkRenderStatus();
+    });
+
     connect(m_view.video_box, &QGroupBox::toggled, this, &RenderWidget::refreshParams);
     connect(m_view.audio_box, &QGroupBox::toggled, this, &RenderWidget::refreshParams);
     m_view.rescale_keep->setChecked(KdenliveSettings::rescalekeepratio());
@@ -883,6 +903,34 @@ void RenderWidget::generateRenderFiles(QDomDocument doc, int in, int out, QStrin
         }
     }
 
+    // Additional outputs are encoded from the same rendered frames, through MLT's multi consumer
+    int outputCount = 1;
+    if (!m_view.checkTwoPass->isChecked() && !renderArgs.contains(QLatin1String("=stills/"))) {
+        QDomElement previous = consumer;
+        const QStringList extraOutputs = KdenliveSettings::renderextraoutputs();
+        for (const QString &presetName : extraOutputs) {
+            if (presetName == m_currentProfile || !RenderPresetRepository::get()->presetExists(presetName)) {
+                continue;
+            }
+            std::unique_ptr<RenderPresetModel> &preset = RenderPresetRepository::get()->getPreset(presetName);
+            QString suffix = presetName;
+            suffix.replace(QRegularExpression(QStringLiteral("\\W+")), QStringLiteral("_"));
+            QDomElement extraConsumer = doc.createElement(QStringLiteral("consumer"));
+            extraConsumer.setAttribute(QStringLiteral("mlt_service"), QStringLiteral("avformat"));
+            extraConsumer.setAttribute(QStringLiteral("target"),
+                                       QStringLiteral("%1-%2.%3").arg(outputFile.section(QLatin1Char('.'), 0, -2), suffix, preset->extension()));
+            const QStringList extraArgs = extraOutputParams(presetName).split(QLatin1Char(' '));
+            for (const QString &param : extraArgs) {
+                if (param.contains(QLatin1Char('='))) {
+                    extraConsumer.setAttribute(param.section(QLatin1Char('='), 0, 0), param.section(QLatin1Char('='), 1));
+                }
+            }
+            doc.documentElement().insertAfter(extraConsumer, previous);
+            previous = extraConsumer;
+            outputCount++;
+        }
+    }
+
     QDomDocument clone;
     int passes = m_view.checkTwoPass->isChecked() ? 2 : 1;
     if (passes == 2) {
@@ -946,7 +994,7 @@ void RenderWidget::generateRenderFiles(QDomDocument doc, int in, int out, QStrin
     QList<RenderJobItem *> jobList;
     QMap<QString, QString>::const_iterator i = renderFiles.constBegin();
     while (i != renderFiles.constEnd()) {
-        RenderJobItem *renderItem = createRenderJob(i.key(), i.value(), in, out);
+        RenderJobItem *renderItem = createRenderJob(i.key(), i.value(), in, out, i.value() == outputFile ? outputCount : 1);
         if (renderItem != nullptr) {
             jobList << renderItem;
         }
@@ -960,7 +1008,7 @@ void RenderWidget::generateRenderFiles(QDomDocument doc, int in, int out, QStrin
     checkRenderStatus();
 }
 
-RenderJobItem *RenderWidget::createRenderJob(const QString &playlist, const QString &outputFile, int in, int out)
+RenderJobItem *RenderWidget::createRenderJob(const QString &playlist, const QString &outputFile, int in, int out, int outputs)
 {
     QList<QTreeWidgetItem *> existing = m_view.running_jobs->findItems(outputFile, Qt::MatchExactly, 1);
     RenderJobItem *renderItem = nullptr;
@@ -997,32 +1045,114 @@ RenderJobItem *RenderWidget::createRenderJob(const QString &playlist, const QStr
     } else {
         renderItem->setData(1, ExtraInfoRole, QString());
     }
+    renderItem->setData(1, OutputsRole, outputs);
+    renderItem->setData(1, FramesRole, out - in + 1);
+    if (outputs > 1) {
+        renderItem->setData(1, ExtraInfoRole, i18np("Also rendering %1 additional output", "Also rendering %1 additional outputs", outputs - 1));
+    }
     return renderItem;
 }
 
+QPair<int, int> RenderWidget::jobResources(RenderJobItem *item) const
+{
+    const QVariant cached = item->data(1, ResourcesRole);
+    if (cached.isValid()) {
+        const QPoint resources = cached.toPoint();
+        return {resources.x(), resources.y()};
+    }
+    int threads = QThread::idealThreadCount();
+    int memory = 0;
+    QStringList jobData = item->data(1, ParametersRole).toStringList();
+    QFile file(jobData.size() > 1 ? jobData.at(1) : QString());
+    if (file.open(QIODevice::ReadOnly)) {
+        // Read the frame size from the profile and the thread counts from the consumer, that come first in the playlist
+        int width = 0;
+        int height = 0;
+        QXmlStreamReader xml(&file);
+        while (!xml.atEnd() && xml.readNextStartElement()) {
+            if (xml.name() == QLatin1String("mlt")) {
+                continue;
+            }
+            const QXmlStreamAttributes attributes = xml.attributes();
+            if (xml.name() == QLatin1String("profile")) {
+                width = attributes.value(QLatin1String("width")).toInt();
+                height = attributes.value(QLatin1String("height")).toInt();
+            } else if (xml.name() == QLatin1String("consumer")) {
+                // threads=0 lets the encoder use all cores, real_time=-n uses n threads to render frames
+                int encoderThreads = attributes.value(QLatin1String("threads")).toInt();
+                encoderThreads = encoderThreads > 0 ? encoderThreads : QThread::idealThreadCount();
+                int outputWidth = attributes.hasAttribute(QLatin1String("width")) ? attributes.value(QLatin1String("width")).toInt() : width;
+                int outputHeight = attributes.hasAttribute(QLatin1String("height")) ? attributes.value(QLatin1String("height")).toInt() : height;
+                if (memory == 0) {
+                    // Main consumer, rough estimate: the frames buffered by the consumer and the render threads, plus the decoders
+                    int renderThreads = qMax(1, qAbs(attributes.value(QLatin1String("real_time")).toInt()));
+                    threads = encoderThreads + renderThreads;
+                    memory = int(qint64(outputWidth) * outputHeight * 4 * (25 + renderThreads) / 1048576) + 256;
+                } else {
+                    // Additional output of a multi output render, only adds an encoder
+                    threads += encoderThreads;
+                    memory += int(qint64(outputWidth) * outputHeight * 4 * 25 / 1048576);
+                }
+            } else if (memory > 0) {
+                // All consumers were read
+                break;
+            }
+            xml.skipCurrentElement();
+        }
+        file.close();
+    }
+    // A job cannot keep more threads busy than there are cores, even if its encoder uses all of them
+    threads = qMin(threads, QThread::idealThreadCount());
+    item->setData(1, ResourcesRole, QPoint(threads, memory));
+    return {threads, memory};
+}
+
 void RenderWidget::checkRenderStatus()
 {
     // check if we have a job waiting to render
     if (m_blockProcessing) {
         return;
     }
-
-    // Make sure no other rendering is running
-    if (runningJobsCount() > 0) {
-        return;
-    }
+    // By default, allow two jobs using all cores to overlap, so that one job's encoding idle times are used by the other
+    int threadBudget = KdenliveSettings::renderthreadbudget() > 0 ? KdenliveSettings::renderthreadbudget() : 2 * QThread::idealThreadCount();
+    int memoryBudget = KdenliveSettings::rendermemorybudget();
+    int usedThreads = 0;
+    int usedMemory = 0;
+    int running = 0;
+    QStringList runningOutputs;
 
     auto *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
+    while (item != nullptr) {
+        if (item->status() == RUNNINGJOB || item->status() == STARTINGJOB) {
+            QPair<int, int> resources = jobResources(item);
+            usedThreads += resources.first;
+            usedMemory += resources.second;
+            running++;
+            runningOutputs << item->text(1);
+        }
+        item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
+    }
 
     bool waitingJob = false;
 
-    // Find first waiting job
+    // Start waiting jobs in queue order while they fit in the thread and memory budgets
+    item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
     while (item != nullptr) {
         if (item->status() == WAITINGJOB) {
+            waitingJob = true;
+            QPair<int, int> resources = jobResources(item);
+            // A job is always started if nothing else runs, even if it exceeds the budget. Later jobs
+            // never overtake a waiting one, which also keeps the passes of a 2 pass encoding in order.
+            if (running > 0 && (usedThreads + resources.first > threadBudget || (memoryBudget > 0 && usedMemory + resources.second > memoryBudget))) {
+                break;
+            }
+            if (runningOutputs.contains(item->text(1))) {
+                // Wait for the previous job writing this file (first pass) to finish
+                break;
+            }
             QDateTime t = QDateTime::currentDateTime();
             item->setData(1, StartTimeRole, t);
             item->setData(1, LastTimeRole, t);
-            waitingJob = true;
             startRendering(item);
             // Check for 2 pass encoding
             QStringList jobData = item->data(1, ParametersRole).toStringList();
@@ -1040,12 +1170,19 @@ void RenderWidget::checkRenderStatus()
                     above = m_view.running_jobs->itemAbove(above);
                 }
             }
-            item->setStatus(STARTINGJOB);
-            break;
+            if (item->status() == WAITINGJOB) {
+                item->setStatus(STARTINGJOB);
+            }
+            if (item->status() == STARTINGJOB) {
+                usedThreads += resources.first;
+                usedMemory += resources.second;
+                running++;
+                runningOutputs << item->text(1);
+            }
         }
         item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
     }
-    if (!waitingJob && m_view.shutdown->isChecked()) {
+    if (!waitingJob && running == 0 && m_view.shutdown->isChecked()) {
         emit shutdown();
     }
 }
@@ -1335,11 +1472,21 @@ void RenderWidget::refreshParams()
 
     double percent = double(m_view.quality->value()) / double(m_view.quality->maximum());
     m_view.qualityPercent->setText(QStringLiteral("%1%").arg(qRound(percent * 100)));
+    params = substitutePresetParams(params, preset, percent, m_view.qualityGroup->isChecked(), m_view.checkTwoPass->isChecked());
+
+    newParams.prepend(params);
+
+    m_view.advanced_params->setPlainText(newParams.join(QStringLiteral(" ")));
+}
+
+QString RenderWidget::substitutePresetParams(QString params, const std::unique_ptr<RenderPresetModel> &preset, double percent, bool customQuality,
+                                             bool twoPass) const
+{
     // historically qualities are sorted from best to worse for some reason
     int min = preset->videoQualities().last().toInt();
     int max = preset->videoQualities().first().toInt();
     int val = preset->defaultVQuality().toInt();
-    if (m_view.qualityGroup->isChecked()) {
+    if (customQuality) {
         if (min < max) {
             int range = max - min;
             val = min + int(range * percent);
@@ -1354,7 +1501,7 @@ void RenderWidget::refreshParams()
     params.replace(QStringLiteral("%bitrate"), QStringLiteral("%1").arg(preset->defaultVBitrate()));
 
     val = preset->defaultABitrate().toInt() * 1000;
-    if (m_view.qualityGroup->isChecked()) {
+    if (customQuality) {
         val *= percent;
     }
     // cvbr = Constrained Variable Bit Rate
@@ -1364,7 +1511,7 @@ void RenderWidget::refreshParams()
     min = preset->audioQualities().last().toInt();
     max = preset->audioQualities().first().toInt();
     val = preset->defaultAQuality().toInt();
-    if (m_view.qualityGroup->isChecked()) {
+    if (customQuality) {
         if (min < max) {
             int range = max - min;
             val = min + int(range * percent);
@@ -1393,11 +1540,69 @@ void RenderWidget::refreshParams()
     }
 
     params.replace(QLatin1String("%dar"), QStringLiteral("@%1/%2").arg(QString::number(projectProfile->display_aspect_num())).arg(QString::number(projectProfile->display_aspect_den())));
-    params.replace(QLatin1String("%passes"), QString::number(static_cast<int>(m_view.checkTwoPass->isChecked()) + 1));
+    params.replace(QLatin1String("%passes"), QString::number(twoPass ? 2 : 1));
 
-    newParams.prepend(params);
+    return params;
+}
 
-    m_view.advanced_params->setPlainText(newParams.join(QStringLiteral(" ")));
+QString RenderWidget::extraOutputParams(const QString &presetName) const
+{
+    std::unique_ptr<RenderPresetModel> &preset = RenderPresetRepository::get()->getPreset(presetName);
+    QStringList newParams;
+    if (!preset->hasParam(QStringLiteral("channels"))) {
+        newParams.append(QStringLiteral("channels=%1").arg(pCore->audioChannels()));
+    }
+    // Frames are rendered once for all outputs by the main consumer
+    QString params = preset->params({QStringLiteral("real_time")});
+    if (!params.contains(QStringLiteral("threads="))) {
+        newParams.append(QStringLiteral("threads=%1").arg(KdenliveSettings::encodethreads()));
+    }
+    newParams.prepend(substitutePresetParams(params, preset, 1., false, false));
+    return newParams.join(QLatin1Char(' '));
+}
+
+void RenderWidget::buildExtraOutputsMenu()
+{
+    QMenu *menu = m_view.extra_outputs->menu();
+    menu->clear();
+    const QStringList selected = KdenliveSettings::renderextraoutputs();
+    QMap<QString, QMenu *> groups;
+    const QVector<QString> presets = RenderPresetRepository::get()->getAllPresets();
+    for (const QString &name : presets) {
+        std::unique_ptr<RenderPresetModel> &preset = RenderPresetRepository::get()->getPreset(name);
+        if (!preset->error().isEmpty()) {
+            continue;
+        }
+        QMenu *groupMenu = groups.value(preset->groupName());
+        if (groupMenu == nullptr) {
+            groupMenu = menu->addMenu(preset->groupName());
+            groups.insert(preset->groupName(), groupMenu);
+        }
+        QAction *ac = groupMenu->addAction(name);
+        ac->setCheckable(true);
+        ac->setChecked(selected.contains(name));
+        connect(ac, &QAction::toggled, this, [this, name](bool checked) {
+            QStringList outputs = KdenliveSettings::renderextraoutputs();
+            outputs.removeAll(name);
+            if (checked) {
+                outputs.append(name);
+            }
+            KdenliveSettings::setRenderextraoutputs(outputs);
+            updateExtraOutputsButton();
+        });
+    }
+    updateExtraOutputsButton();
+}
+
+void RenderWidget::updateExtraOutputsButton()
+{
+    int count = 0;
+    for (const QString &name : KdenliveSettings::renderextraoutputs()) {
+        if (RenderPresetRepository::get()->presetExists(name)) {
+            count++;
+        }
+    }
+    m_view.extra_outputs->setText(count > 0 ? i18np("%1 Additional Output", "%1 Additional Outputs", count) : i18n("Additional Outputs"));
 }
 
 void RenderWidget::parseProfiles(const QString &selectedProfile)
@@ -1486,6 +1691,13 @@ void RenderWidget::setRenderStatus(const QString &dest, int status, const QStrin
         QString est = (days > 0) ? i18np("%1 day ", "%1 days ", days) : QString();
         est.append(when.toString(QStringLiteral("hh:mm:ss")));
         QString t = i18n("Rendering finished in %1", est);
+        int outputs = item->data(1, OutputsRole).toInt();
+        if (outputs > 1 && elapsedTime > 0) {
+            // Report the combined throughput of all outputs encoded from the same frames
+            int frames = item->data(1, FramesRole).toInt();
+            t = i18n("Rendering of %1 outputs finished in %2 (%3 fps, %4 encoded frames per second)", outputs, est, int(frames / elapsedTime),
+                     int(qint64(frames) * outputs / elapsedTime));
+        }
         item->setData(1, Qt::UserRole, t);
 
 #ifdef KF5_USE_PURPOSE
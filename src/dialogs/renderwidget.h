@@ -23,6 +23,7 @@ class Menu;
 
 class QDomElement;
 class QKeyEvent;
+class RenderPresetModel;
 
 // RenderViewDelegate is used to draw the progress bars.
 class RenderViewDelegate : public QStyledItemDelegate
@@ -218,8 +219,10 @@ private:
 #endif
     void parseProfiles(const QString &selectedProfile = QString());
     QUrl filenameWithExtension(QUrl url, const QString &extension);
-    /** @brief Check if a job needs to be started. */
+    /** @brief Start the waiting jobs that fit in the render thread and memory budgets. */
     void checkRenderStatus();
+    /** @brief The number of threads and the estimated memory (in MB) used by a job, read from its playlist. */
+    QPair<int, int> jobResources(RenderJobItem *item) const;
     void startRendering(RenderJobItem *item);
     /** @brief Create a rendering profile from MLT preset. */
     QTreeWidgetItem *loadFromMltPreset(const QString &groupName, const QString &path, QString profileName, bool codecInName = false);
@@ -227,7 +230,15 @@ private:
     /** @brief Create a new empty playlist (*.mlt) file and @returns the filename of the created file */
     QString generatePlaylistFile(bool delayedRendering);
     void generateRenderFiles(QDomDocument doc, int in, int out, QString outputFile, bool delayedRendering);
-    RenderJobItem *createRenderJob(const QString &playlist, const QString &outputFile, int in, int out);
+    /** @brief Create a job rendering @param playlist, that writes @param outputFile and @param outputs - 1 additional outputs */
+    RenderJobItem *createRenderJob(const QString &playlist, const QString &outputFile, int in, int out, int outputs = 1);
+    /** @brief Replace the quality, bitrate and other placeholders of a preset's params */
+    QString substitutePresetParams(QString params, const std::unique_ptr<RenderPresetModel> &preset, double percent, bool customQuality, bool twoPass) const;
+    /** @brief The consumer params of an additional output, using the preset's default quality */
+    QString extraOutputParams(const QString &presetName) const;
+    /** @brief Fill the menu used to select the presets rendered as additional outputs */
+    void buildExtraOutputsMenu();
+    void updateExtraOutputsButton();
 
 signals:
     void abortProcess(const QString &url);
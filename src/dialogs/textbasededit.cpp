@@ -12,6 +12,7 @@
 #include "kdenlivesettings.h"
 #include "mainwindow.h"
 #include "monitor/monitor.h"
+#include "pythoninterfaces/speechpipeline.h"
 #include "widgets/timecodedisplay.h"
 #include "timeline2/view/timelinecontroller.h"
 #include "timeline2/view/timelinewidget.h"
@@ -566,6 +567,14 @@ TextBasedEdit::TextBasedEdit(QWidget *parent)
     setupUi(this);
     setFocusPolicy(Qt::StrongFocus);
     m_stt = new SpeechToText();
+    m_speechPipeline = new SpeechPipeline(m_stt, this);
+    connect(m_speechPipeline, &SpeechPipeline::result, this, &TextBasedEdit::slotProcessSpeech);
+    connect(m_speechPipeline, &SpeechPipeline::errorOutput, this, &TextBasedEdit::slotProcessSpeechError);
+    connect(m_speechPipeline, &SpeechPipeline::progress, speech_progress, &QProgressBar::setValue);
+    connect(m_speechPipeline, &SpeechPipeline::finished, this, [this](bool success) {
+        m_playlistWav.remove();
+        slotProcessSpeechStatus(success);
+    });
     m_voskConfig = new QAction(i18n("Configure"), this);
     connect(m_voskConfig, &QAction::triggered, []() {
         pCore->window()->slotPreferences(8);
@@ -599,8 +608,8 @@ TextBasedEdit::TextBasedEdit(QWidget *parent)
     frame_progress->setVisible(false);
     button_abort->setIcon(QIcon::fromTheme(QStringLiteral("process-stop")));
     connect(button_abort, &QToolButton::clicked, this, [this]() {
-        if (m_speechJob && m_speechJob->state() == QProcess::Running) {
-            m_speechJob->kill();
+        if (m_speechPipeline->isRunning()) {
+            m_speechPipeline->abort();
         } else if (m_tCodeJob && m_tCodeJob->state() == QProcess::Running) {
             m_tCodeJob->kill();
         }
@@ -732,10 +741,8 @@ TextBasedEdit::TextBasedEdit(QWidget *parent)
 
 TextBasedEdit::~TextBasedEdit()
 {
-    if (m_speechJob && m_speechJob->state() == QProcess::Running) {
-        m_speechJob->kill();
-        m_speechJob->waitForFinished();
-    }
+    // Stops the recognizer processes
+    delete m_speechPipeline;
 }
 
 bool TextBasedEdit::eventFilter(QObject *obj, QEvent *event)
@@ -756,10 +763,15 @@ bool TextBasedEdit::eventFilter(QObject *obj, QEvent *event)
 
 void TextBasedEdit::startRecognition()
 {
-    if (m_speechJob && m_speechJob->state() != QProcess::NotRunning) {
+    if (m_speechPipeline->isRunning() || (m_tCodeJob && m_tCodeJob->state() != QProcess::NotRunning)) {
         if (KMessageBox::questionYesNo(this, i18n("Another recognition job is running. Abort it ?")) !=  KMessageBox::Yes) {
             return;
         }
+        if (m_tCodeJob) {
+            m_tCodeJob->disconnect(this);
+            m_tCodeJob->kill();
+        }
+        m_speechPipeline->abort();
     }
     info_message->hide();
     m_errorString.clear();
@@ -783,7 +795,6 @@ void TextBasedEdit::startRecognition()
         return;
     }
 
-    m_speechJob = std::make_unique<QProcess>(this);
     showMessage(i18n("Starting speech recognition"), KMessageWidget::Information);
     qApp->processEvents();
     QString modelDirectory = m_stt->voskModelPath();
@@ -791,9 +802,11 @@ void TextBasedEdit::startRecognition()
     
     m_sourceUrl.clear();
     QString clipName;
+    QString clipHash;
     m_clipOffset = 0;
     m_lastPosition = 0;
-    double endPos = 0;
+    m_audioLevels.clear();
+    m_audioChannels = 0;
     bool hasAudio = false;
     if (clip->itemType() == AbstractProjectItem::ClipItem) {
         std::shared_ptr<ProjectClip> clipItem = std::static_pointer_cast<ProjectClip>(clip);
@@ -801,13 +814,17 @@ void TextBasedEdit::startRecognition()
             m_sourceUrl = clipItem->url();
             clipName = clipItem->clipName();
             hasAudio = clipItem->hasAudio();
+            if (hasAudio) {
+                clipHash = clipItem->hash();
+                m_audioLevels = clipItem->audioFrameCache();
+                m_audioChannels = clipItem->audioChannels();
+            }
             if (speech_zone->isChecked()) {
                 // Analyse clip zone only
                 QPoint zone = clipItem->zone();
                 m_lastPosition = zone.x();
                 m_clipOffset = GenTime(zone.x(), pCore->getCurrentFps()).seconds();
                 m_clipDuration = GenTime(zone.y() - zone.x(), pCore->getCurrentFps()).seconds();
-                endPos = m_clipDuration;
             } else {
                 m_clipDuration = clipItem->duration().seconds();
             }
@@ -819,11 +836,15 @@ void TextBasedEdit::startRecognition()
             m_sourceUrl = master->url();
             hasAudio = master->hasAudio();
             clipName = master->clipName();
+            if (hasAudio) {
+                clipHash = master->hash();
+                m_audioLevels = master->audioFrameCache();
+                m_audioChannels = master->audioChannels();
+            }
             QPoint zone = clipItem->zone();
             m_lastPosition = zone.x();
             m_clipOffset = GenTime(zone.x(), pCore->getCurrentFps()).seconds();
             m_clipDuration = GenTime(zone.y() - zone.x(), pCore->getCurrentFps()).seconds();
-            endPos = m_clipDuration;
         }
     }
     if (m_sourceUrl.isEmpty() || !hasAudio) {
@@ -831,6 +852,20 @@ void TextBasedEdit::startRecognition()
         return;
     }
     clipNameLabel->setText(clipName);
+    m_speechCache = SpeechPipeline::cachePath(clipHash, language, m_clipOffset, m_clipDuration);
+    QJsonArray cachedResults;
+    if (SpeechPipeline::loadCache(m_speechCache, cachedResults)) {
+        // This media zone was already analysed with the same model
+        m_speechCache.clear();
+        for (const auto &entry : qAsConst(cachedResults)) {
+            QJsonObject obj = entry.toObject();
+            slotProcessSpeech(obj.value(QLatin1String("result")).toObject(), obj.value(QLatin1String("offset")).toDouble());
+        }
+        slotProcessSpeechStatus(true);
+        return;
+    }
+    const QVector<QPair<double, double>> chunks =
+        SpeechPipeline::splitAtSilences(m_audioLevels, m_audioChannels, pCore->getCurrentFps(), m_clipOffset, m_clipDuration);
     if (clip->clipType() == ClipType::Playlist) {
         // We need to extract audio first
         m_playlistWav.remove();
@@ -846,7 +881,7 @@ void TextBasedEdit::startRecognition()
         m_tCodeJob = std::make_unique<QProcess>(this);
         m_tCodeJob->setProcessChannelMode(QProcess::MergedChannels);
         connect(m_tCodeJob.get(), static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
-                this, [this, language, clipName, modelDirectory, endPos](int code, QProcess::ExitStatus status) {
+                this, [this, language, clipName, modelDirectory, chunks](int code, QProcess::ExitStatus status) {
             Q_UNUSED(code)
             qDebug()<<"++++++++++++++++++++++ TCODE JOB FINISHED\n";
             if (status == QProcess::CrashExit) {
@@ -858,14 +893,7 @@ void TextBasedEdit::startRecognition()
             }
             showMessage(i18n("Starting speech recognition on %1.", clipName), KMessageWidget::Information);
             qApp->processEvents();
-            connect(m_speechJob.get(), &QProcess::readyReadStandardError, this, &TextBasedEdit::slotProcessSpeechError);
-            connect(m_speechJob.get(), &QProcess::readyReadStandardOutput, this, &TextBasedEdit::slotProcessSpeech);
-            connect(m_speechJob.get(), static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, [this](int code, QProcess::ExitStatus status) {
-                m_playlistWav.remove();
-                slotProcessSpeechStatus(code, status);
-            });
-            m_speechJob->start(m_stt->pythonExec(), {m_stt->speechScript(), modelDirectory, language, m_playlistWav.fileName(), QString::number(m_clipOffset), QString::number(endPos)});
-            speech_progress->setValue(0);
+            m_speechPipeline->start(m_playlistWav.fileName(), modelDirectory, language, chunks);
             frame_progress->setVisible(true);
         });
         connect(m_tCodeJob.get(), &QProcess::readyReadStandardOutput, this, [this]() {
@@ -881,20 +909,16 @@ void TextBasedEdit::startRecognition()
     } else {
         showMessage(i18n("Starting speech recognition on %1.", clipName), KMessageWidget::Information);
         qApp->processEvents();
-        connect(m_speechJob.get(), &QProcess::readyReadStandardError, this, &TextBasedEdit::slotProcessSpeechError);
-        connect(m_speechJob.get(), &QProcess::readyReadStandardOutput, this, &TextBasedEdit::slotProcessSpeech);
-        connect(m_speechJob.get(), static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, &TextBasedEdit::slotProcessSpeechStatus);
-        qDebug()<<"=== STARTING RECO: "<<m_stt->speechScript()<<" / "<<modelDirectory<<" / "<<language<<" / "<<m_sourceUrl<<", START: "<<m_clipOffset<<", DUR: "<<endPos;
+        qDebug()<<"=== STARTING RECO: "<<m_stt->speechScript()<<" / "<<modelDirectory<<" / "<<language<<" / "<<m_sourceUrl<<", START: "<<m_clipOffset<<", DUR: "<<m_clipDuration;
         button_add->setEnabled(false);
-        m_speechJob->start(m_stt->pythonExec(), {m_stt->speechScript(), modelDirectory, language, m_sourceUrl, QString::number(m_clipOffset), QString::number(endPos)});
-        speech_progress->setValue(0);
+        m_speechPipeline->start(m_sourceUrl, modelDirectory, language, chunks);
         frame_progress->setVisible(true);
     }
 }
 
-void TextBasedEdit::slotProcessSpeechStatus(int, QProcess::ExitStatus status)
+void TextBasedEdit::slotProcessSpeechStatus(bool success)
 {
-    if (status == QProcess::CrashExit) {
+    if (!success) {
         showMessage(i18n("Speech recognition aborted."), KMessageWidget::Warning, m_errorString.isEmpty() ? nullptr : m_logAction);
     } else if (m_visualEditor->toPlainText().isEmpty()) {
         if (m_errorString.contains(QStringLiteral("ModuleNotFoundError"))) {
@@ -919,6 +943,9 @@ void TextBasedEdit::slotProcessSpeechStatus(int, QProcess::ExitStatus status)
 
         button_add->setEnabled(true);
         showMessage(i18n("Speech recognition finished."), KMessageWidget::Positive);
+        if (!m_speechCache.isEmpty()) {
+            SpeechPipeline::storeCache(m_speechCache, m_speechPipeline->results());
+        }
         // Store speech analysis in clip properties
         std::shared_ptr<AbstractProjectItem> clip = pCore->projectItemModel()->getItemByBinId(m_binId);
         if (clip) {
@@ -940,80 +967,64 @@ void TextBasedEdit::slotProcessSpeechStatus(int, QProcess::ExitStatus status)
     frame_progress->setVisible(false);
 }
 
-void TextBasedEdit::slotProcessSpeechError()
+void TextBasedEdit::slotProcessSpeechError(const QString &text)
 {
-    m_errorString.append(QString::fromUtf8(m_speechJob->readAllStandardError()));
+    m_errorString.append(text);
 }
 
-void TextBasedEdit::slotProcessSpeech()
+void TextBasedEdit::slotProcessSpeech(const QJsonObject &obj, double offset)
 {
-    QString saveData = QString::fromUtf8(m_speechJob->readAllStandardOutput());
-    qDebug()<<"=== GOT DATA:\n"<<saveData;
-    QJsonParseError error;
-    auto loadDoc = QJsonDocument::fromJson(saveData.toUtf8(), &error);
-    qDebug()<<"===JSON ERROR: "<<error.errorString();
     QTextCursor cursor = m_visualEditor->textCursor();
     QTextCharFormat fmt = cursor.charFormat();
     //fmt.setForeground(palette().text().color());
-    if (loadDoc.isObject()) {
-        QJsonObject obj = loadDoc.object();
-        if (!obj.isEmpty()) {
-            //QString itemText = obj["text"].toString();
-            bool textFound = false;
-            QPair <double, double>sentenceZone;
-            if (obj["result"].isArray()) {
-                QJsonArray obj2 = obj["result"].toArray();
-                
-                // Get start time for first word
-                QJsonValue val = obj2.first();
-                if (val.isObject() && val.toObject().keys().contains("start")) {
-                    double ms = val.toObject().value("start").toDouble() + m_clipOffset;
-                    GenTime startPos(ms);
-                    sentenceZone.first = ms;
-                    if (startPos.frames(pCore->getCurrentFps()) > m_lastPosition + 1) {
-                        // Insert space
-                        GenTime silenceStart(m_lastPosition, pCore->getCurrentFps());
-                        m_visualEditor->moveCursor(QTextCursor::End);
-                        fmt.setAnchorHref(QString("%1#%2:%3").arg(m_binId).arg(silenceStart.seconds()).arg(GenTime(startPos.frames(pCore->getCurrentFps()) - 1, pCore->getCurrentFps()).seconds()));
-                        fmt.setAnchor(true);
-                        cursor.insertText(i18n("No speech"), fmt);
-                        m_visualEditor->textCursor().insertBlock(cursor.blockFormat());
-                        m_visualEditor->speechZones << QPair<double, double>(silenceStart.seconds(), GenTime(startPos.frames(pCore->getCurrentFps()) - 1, pCore->getCurrentFps()).seconds());
-                    }
-                    val = obj2.last();
-                    if (val.isObject() && val.toObject().keys().contains("end")) {
-                        ms = val.toObject().value("end").toDouble() + m_clipOffset;
-                        sentenceZone.second = ms;
-                        m_lastPosition = GenTime(ms).frames(pCore->getCurrentFps());
-                        if (m_clipDuration > 0.) {
-                            speech_progress->setValue(static_cast<int>(100 * ms / ( + m_clipOffset + m_clipDuration)));
-                        }
-                    }
-                }
-                // Store words with their start/end time
-                foreach (const QJsonValue & v, obj2) {
-                    textFound = true;
+    if (!obj.isEmpty()) {
+        bool textFound = false;
+        QPair <double, double>sentenceZone;
+        if (obj["result"].isArray()) {
+            QJsonArray obj2 = obj["result"].toArray();
+
+            // Get start time for first word
+            QJsonValue val = obj2.first();
+            if (val.isObject() && val.toObject().keys().contains("start")) {
+                double ms = val.toObject().value("start").toDouble() + offset;
+                GenTime startPos(ms);
+                sentenceZone.first = ms;
+                if (startPos.frames(pCore->getCurrentFps()) > m_lastPosition + 1) {
+                    // Insert space
+                    GenTime silenceStart(m_lastPosition, pCore->getCurrentFps());
+                    m_visualEditor->moveCursor(QTextCursor::End);
+                    fmt.setAnchorHref(QString("%1#%2:%3").arg(m_binId).arg(silenceStart.seconds()).arg(GenTime(startPos.frames(pCore->getCurrentFps()) - 1, pCore->getCurrentFps()).seconds()));
                     fmt.setAnchor(true);
-                    fmt.setAnchorHref(QString("%1#%2:%3").arg(m_binId).arg(v.toObject().value("start").toDouble() + m_clipOffset).arg(v.toObject().value("end").toDouble() + m_clipOffset));
-                    cursor.insertText(v.toObject().value("word").toString(), fmt);
-                    fmt.setAnchor(false);
-                    cursor.insertText(QStringLiteral(" "), fmt);
-                }
-            } else {
-                // Last empty object - no speech detected
-            }
-            if (textFound) {
-                if (sentenceZone.second < m_clipOffset + m_clipDuration) {
+                    cursor.insertText(i18n("No speech"), fmt);
                     m_visualEditor->textCursor().insertBlock(cursor.blockFormat());
+                    m_visualEditor->speechZones << QPair<double, double>(silenceStart.seconds(), GenTime(startPos.frames(pCore->getCurrentFps()) - 1, pCore->getCurrentFps()).seconds());
+                }
+                val = obj2.last();
+                if (val.isObject() && val.toObject().keys().contains("end")) {
+                    ms = val.toObject().value("end").toDouble() + offset;
+                    sentenceZone.second = ms;
+                    m_lastPosition = GenTime(ms).frames(pCore->getCurrentFps());
                 }
-                m_visualEditor->speechZones << sentenceZone;
             }
+            // Store words with their start/end time
+            foreach (const QJsonValue & v, obj2) {
+                textFound = true;
+                fmt.setAnchor(true);
+                fmt.setAnchorHref(QString("%1#%2:%3").arg(m_binId).arg(v.toObject().value("start").toDouble() + offset).arg(v.toObject().value("end").toDouble() + offset));
+                cursor.insertText(v.toObject().value("word").toString(), fmt);
+                fmt.setAnchor(false);
+                cursor.insertText(QStringLiteral(" "), fmt);
+            }
+        } else {
+            // Last empty object - no speech detected
+        }
+        if (textFound) {
+            if (sentenceZone.second < m_clipOffset + m_clipDuration) {
+                m_visualEditor->textCursor().insertBlock(cursor.blockFormat());
+            }
+            m_visualEditor->speechZones << sentenceZone;
         }
-    } else if (loadDoc.isEmpty()) {
-        qDebug()<<"==== EMPTY OBJECT DOC";
     }
-    qDebug()<<"==== GOT BLOCKS: "<<m_document.blockCount();
-    qDebug()<<"=== LINES: "<<m_document.firstBlock().lineCount();
     m_visualEditor->repaintLines();
 }
 
@@ -1138,7 +1149,7 @@ void TextBasedEdit::showMessage(const QString &text, KMessageWidget::MessageType
 
 void TextBasedEdit::openClip(std::shared_ptr<ProjectClip> clip)
 {
-    if (m_speechJob && m_speechJob->state() == QProcess::Running) {
+    if (m_speechPipeline->isRunning()) {
         // TODO: ask for job cancelation
         return;
     }
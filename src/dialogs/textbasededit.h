@@ -15,8 +15,10 @@
 #include <QMouseEvent>
 #include <QTimer>
 #include <QTemporaryFile>
+#include <QJsonObject>
 
 class ProjectClip;
+class SpeechPipeline;
 
 /**
  * @class VideoTextEdit: Video speech text editor
@@ -145,9 +147,10 @@ public slots:
 
 private slots:
     void startRecognition();
-    void slotProcessSpeech();
-    void slotProcessSpeechError();
-    void slotProcessSpeechStatus(int, QProcess::ExitStatus status);
+    /** @brief Insert a recognition result, @param offset is the position of its chunk in the source */
+    void slotProcessSpeech(const QJsonObject &obj, double offset);
+    void slotProcessSpeechError(const QString &text);
+    void slotProcessSpeechStatus(bool success);
     /** @brief insert currently selected zones to timeline */
     void insertToTimeline();
     /** @brief Preview current edited text in the clip monitor */
@@ -160,8 +163,13 @@ protected:
     bool eventFilter(QObject *obj, QEvent *event) override;
 
 private:
-    std::unique_ptr<QProcess> m_speechJob;
+    SpeechPipeline *m_speechPipeline;
     std::unique_ptr<QProcess> m_tCodeJob;
+    /** @brief The transcript cache file of the current recognition */
+    QString m_speechCache;
+    /** @brief The audio levels of the analysed clip, used to split the recognition at silences */
+    QVector<uint8_t> m_audioLevels;
+    int m_audioChannels{0};
     /** @brief Id of the master bin clip on which speech processing is done */
     QString m_binId;
     /** @brief Id of the playlist which is processed from the master clip */
@@ -53,6 +53,7 @@ DocumentChecker::DocumentChecker(QUrl url, const QDomDocument &doc)
     , m_dialog(nullptr)
     , m_abortSearch(false)
     , m_checkRunning(false)
+    , m_changed(false)
 {
     connect(this, &DocumentChecker::showScanning, [this](const QString &message) {
         m_ui.infoLabel->setText(message);
@@ -82,6 +83,7 @@ bool DocumentChecker::hasErrorInClips()
             m_rootReplacement.first = dir.absolutePath() + QDir::separator();
             root = m_url.adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile();
             baseElement.setAttribute(QStringLiteral("root"), root);
+            m_changed = true;
             root = QDir::cleanPath(root) + QDir::separator();
             m_rootReplacement.second = root;
         } else {
@@ -100,6 +102,7 @@ bool DocumentChecker::hasErrorInClips()
                 m_documentid = QString::number(QDateTime::currentMSecsSinceEpoch());
                 // TODO: Warn on invalid doc id
                 Xml::setXmlProperty(playlists.at(i).toElement(), QStringLiteral("kdenlive:docproperties.documentid"), m_documentid);
+                m_changed = true;
             }
             storageFolder = Xml::getXmlProperty(playlists.at(i).toElement(), QStringLiteral("kdenlive:docproperties.storagefolder"));
             if (!storageFolder.isEmpty() && QFileInfo(storageFolder).isRelative()) {
@@ -110,6 +113,7 @@ bool DocumentChecker::hasErrorInClips()
                 Xml::setXmlProperty(playlists.at(i).toElement(), QStringLiteral("kdenlive:docproperties.storagefolder"),
                                     projectDir.absoluteFilePath(m_documentid));
                 m_doc.documentElement().setAttribute(QStringLiteral("modified"), 1);
+                m_changed = true;
             }
             break;
         }
@@ -265,6 +269,7 @@ bool DocumentChecker::hasErrorInClips()
 
     if (!m_missingFilters.isEmpty()) {
         // Delete missing effects
+        m_changed = true;
         for (int i = 0; i < effs.count(); ++i) {
             QDomElement e = effs.item(i).toElement();
             if (m_missingFilters.contains(getProperty(e, QStringLiteral("kdenlive_id")))) {
@@ -278,6 +283,8 @@ bool DocumentChecker::hasErrorInClips()
         m_missingFilters.isEmpty() && m_changedClips.isEmpty()) {
         return false;
     }
+    // The user can fix the document from the dialog
+    m_changed = true;
 
     m_dialog = new QDialog();
     m_dialog->setFont(QFontDatabase::systemFont(QFontDatabase::SmallestReadableFont));
@@ -817,6 +824,7 @@ QString DocumentChecker::getProperty(const QDomElement &effect, const QString &n
 
 void DocumentChecker::updateProperty(const QDomElement &effect, const QString &name, const QString &value)
 {
+    m_changed = true;
     QDomNodeList params = effect.elementsByTagName(QStringLiteral("property"));
     for (int i = 0; i < params.count(); ++i) {
         QDomElement e = params.item(i).toElement();
@@ -829,6 +837,7 @@ void DocumentChecker::updateProperty(const QDomElement &effect, const QString &n
 
 void DocumentChecker::setProperty(QDomElement &effect, const QString &name, const QString &value)
 {
+    m_changed = true;
     QDomNodeList params = effect.elementsByTagName(QStringLiteral("property"));
     bool found = false;
     for (int i = 0; i < params.count(); ++i) {
@@ -958,6 +967,11 @@ void DocumentChecker::slotSearchClips(const QString &newpath)
     m_checkRunning = false;
 }
 
+bool DocumentChecker::documentChanged() const
+{
+    return m_changed;
+}
+
 QString DocumentChecker::searchLuma(const QDir &dir, const QString &file)
 {
     QDir searchPath(KdenliveSettings::mltpath());
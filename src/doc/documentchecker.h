@@ -29,6 +29,8 @@ public:
      */
     bool hasErrorInClips();
     QString searchLuma(const QDir &dir, const QString &file);
+    /** @brief Returns true if the document was changed while checking it, so that it has to be serialized again */
+    bool documentChanged() const;
 
 private slots:
     void acceptDialog();
@@ -70,6 +72,7 @@ private:
     QList<QDomElement> m_missingSources;
     bool m_abortSearch;
     bool m_checkRunning;
+    bool m_changed;
 
     void fixClipItem(QTreeWidgetItem *child, const QDomNodeList &producers, const QDomNodeList &trans);
     void fixSourceClipItem(QTreeWidgetItem *child, const QDomNodeList &producers);
@@ -38,6 +38,7 @@ DocumentValidator::DocumentValidator(const QDomDocument &doc, QUrl documentUrl)
     : m_doc(doc)
     , m_url(std::move(documentUrl))
     , m_modified(false)
+    , m_changed(false)
 {
 }
 
@@ -55,10 +56,12 @@ QPair<bool, QString> DocumentValidator::validate(const double currentVersion)
         QString playlist = m_doc.toString();
         playlist.replace(QLatin1String("$CURRENTPATH"), m_url.adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile());
         m_doc.setContent(playlist);
+        m_changed = true;
         mlt = m_doc.firstChildElement(QStringLiteral("mlt"));
         kdenliveDoc = mlt.firstChildElement(QStringLiteral("kdenlivedoc"));
     } else if (rootDir.isEmpty()) {
         mlt.setAttribute(QStringLiteral("root"), m_url.adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile());
+        m_changed = true;
     }
 
     QLocale documentLocale = QLocale::c(); // Document locale for conversion. Previous MLT / Kdenlive versions used C locale by default
@@ -166,6 +169,7 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
         return false;
     }
 
+    m_changed = true;
     // <kdenlivedoc />
     QDomNode infoXmlNode;
     QDomElement infoXml;
@@ -2200,6 +2204,11 @@ bool DocumentValidator::isModified() const
     return m_modified;
 }
 
+bool DocumentValidator::documentChanged() const
+{
+    return m_changed || m_modified;
+}
+
 bool DocumentValidator::checkMovit()
 {
     QString playlist = m_doc.toString();
@@ -2212,6 +2221,7 @@ bool DocumentValidator::checkMovit()
                                         "project to a non-GPU version?\nThis might result in data loss.")) != KMessageBox::Yes) {
         return false;
     }
+    m_changed = true;
     // Try to convert Movit filters to their non GPU equivalent
     QStringList convertedFilters;
     QStringList discardedFilters;
@@ -21,6 +21,8 @@ public:
     bool isProject() const;
     QPair<bool, QString> validate(const double currentVersion);
     bool isModified() const;
+    /** @brief Returns true if the document was changed in any way by validate() or checkMovit(), so that it has to be serialized again */
+    bool documentChanged() const;
     /** @brief Check if the project contains references to Movit stuff (GLSL), and try to convert if wanted. */
     bool checkMovit();
 
@@ -28,6 +30,7 @@ private:
     QDomDocument m_doc;
     QUrl m_url;
     bool m_modified;
+    bool m_changed;
     /** @brief Upgrade from a previous Kdenlive document version. */
     bool upgrade(double version, const double currentVersion);
 
@@ -4,12 +4,75 @@
 */
 
 #include "docundostack.hpp"
+#include "kdenlive_debug.h"
+#include "kdenlivesettings.h"
+#include "undohelper.hpp"
 #include <QUndoCommand>
+#include <QSignalBlocker>
 #include <QUndoGroup>
+#include <memory>
+#include <vector>
+
+/** @brief Stack entry wrapping the pushed command.
+  QUndoStack cannot drop commands from the bottom of a non empty stack, so the entries share their command: the stack can then be
+  rebuilt without its oldest entries, which deletes the commands that are not referenced anymore.
+ */
+class HistoryEntry : public QUndoCommand
+{
+public:
+    HistoryEntry(DocUndoStack *stack, std::shared_ptr<QUndoCommand> command, qint64 cost)
+        : m_stack(stack)
+        , m_command(std::move(command))
+        , m_cost(cost)
+        , m_silent(false)
+    {
+        setText(m_command->text());
+    }
+    void undo() override
+    {
+        if (!m_silent) {
+            m_command->undo();
+        }
+    }
+    void redo() override
+    {
+        if (!m_silent) {
+            m_command->redo();
+        }
+    }
+    int id() const override { return m_command->id(); }
+    bool mergeWith(const QUndoCommand *other) override
+    {
+        auto *entry = static_cast<const HistoryEntry *>(other);
+        if (m_silent || !m_command->mergeWith(entry->m_command.get())) {
+            return false;
+        }
+        // The cost of the merged entry was added when it was pushed
+        qint64 cost = DocUndoStack::commandCost(m_command.get());
+        m_stack->m_memoryUsage += cost - m_cost - entry->m_cost;
+        m_cost = cost;
+        setText(m_command->text());
+        return true;
+    }
+    DocUndoStack *m_stack;
+    std::shared_ptr<QUndoCommand> m_command;
+    qint64 m_cost;
+    /** @brief Set while the stack is rebuilt, so that the command is not executed again */
+    bool m_silent;
+};
 
 DocUndoStack::DocUndoStack(QUndoGroup *parent)
     : QUndoStack(parent)
+    , m_memoryBudget(-1)
+    , m_memoryUsage(0)
 {
+    connect(this, &QUndoStack::indexChanged, this, [this]() {
+        if (count() == 0) {
+            // The stack was cleared
+            m_memoryUsage = 0;
+        }
+        emit memoryUsageChanged(m_memoryUsage);
+    });
 }
 
 // TODO: custom undostack everywhere do that
@@ -17,6 +80,103 @@ void DocUndoStack::push(QUndoCommand *cmd)
 {
     if (index() < count()) {
         emit invalidate(index());
+        // These commands are deleted by the push
+        for (int i = index(); i < count(); ++i) {
+            m_memoryUsage -= static_cast<const HistoryEntry *>(command(i))->m_cost;
+        }
+    }
+    qint64 cost = commandCost(cmd);
+    m_memoryUsage += cost;
+    QUndoStack::push(new HistoryEntry(this, std::shared_ptr<QUndoCommand>(cmd), cost));
+    compact();
+}
+
+qint64 DocUndoStack::commandCost(const QUndoCommand *cmd)
+{
+    qint64 cost;
+    if (auto *measured = dynamic_cast<const MeasuredUndoCommand *>(cmd)) {
+        cost = measured->memoryCost();
+    } else {
+        cost = qint64(sizeof(QUndoCommand)) + cmd->text().size() * qint64(sizeof(QChar));
+    }
+    for (int i = 0; i < cmd->childCount(); ++i) {
+        cost += commandCost(cmd->child(i));
+    }
+    return cost;
+}
+
+qint64 DocUndoStack::memoryUsage() const
+{
+    return m_memoryUsage;
+}
+
+void DocUndoStack::setMemoryBudget(qint64 bytes)
+{
+    m_memoryBudget = bytes;
+}
+
+qint64 DocUndoStack::memoryBudget() const
+{
+    if (m_memoryBudget >= 0) {
+        return m_memoryBudget;
+    }
+    return qint64(KdenliveSettings::undomemorylimit()) * 1024 * 1024;
+}
+
+int DocUndoStack::compact()
+{
+    const qint64 budget = memoryBudget();
+    if (budget <= 0 || m_memoryUsage <= budget) {
+        return 0;
+    }
+    // Drop the oldest entries, always keeping the last done command
+    int removed = 0;
+    qint64 usage = m_memoryUsage;
+    while (removed < index() - 1 && usage > budget) {
+        usage -= static_cast<const HistoryEntry *>(command(removed))->m_cost;
+        removed++;
+    }
+    if (removed == 0) {
+        return 0;
+    }
+    // Rebuild the stack with the remaining entries, without executing them
+    std::vector<std::pair<std::shared_ptr<QUndoCommand>, qint64>> kept;
+    for (int i = removed; i < count(); ++i) {
+        auto *entry = static_cast<const HistoryEntry *>(command(i));
+        kept.emplace_back(entry->m_command, entry->m_cost);
+    }
+    const int currentIndex = index() - removed;
+    // The clean state is lost if it was in the removed part of the history
+    const int cleanIx = cleanIndex() >= removed ? cleanIndex() - removed : -1;
+    QSignalBlocker bk(this);
+    clear();
+    std::vector<HistoryEntry *> entries;
+    for (const auto &item : kept) {
+        auto *entry = new HistoryEntry(this, item.first, item.second);
+        entry->m_silent = true;
+        QUndoStack::push(entry);
+        entries.push_back(entry);
+    }
+    if (cleanIx >= 0) {
+        setIndex(cleanIx);
+        setClean();
+    } else {
+        resetClean();
+    }
+    setIndex(currentIndex);
+    for (HistoryEntry *entry : entries) {
+        entry->m_silent = false;
     }
-    QUndoStack::push(cmd);
+    m_memoryUsage = usage;
+    bk.unblock();
+    emit indexChanged(index());
+    emit cleanChanged(isClean());
+    emit canUndoChanged(canUndo());
+    emit canRedoChanged(canRedo());
+    emit undoTextChanged(undoText());
+    emit redoTextChanged(redoText());
+    // Stack indexes moved, shift the cached data indexed on them
+    emit removedOldest(removed);
+    qCDebug(KDENLIVE_LOG) << "Undo history over budget, removed" << removed << "commands, now using" << usage << "bytes";
+    return removed;
 }
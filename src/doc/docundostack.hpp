@@ -16,6 +16,27 @@ class DocUndoStack : public QUndoStack
 public:
     explicit DocUndoStack(QUndoGroup *parent = Q_NULLPTR);
     void push(QUndoCommand *cmd);
+    /** @brief Memory kept alive by the undo history, in bytes */
+    qint64 memoryUsage() const;
+    /** @brief Set the memory budget of the undo history in bytes, 0 to disable it and -1 to use the value from the settings */
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryBudget() const;
+    /** @brief Delete the oldest commands until the history fits in the memory budget
+       @returns the number of deleted commands
+    */
+    int compact();
+    /** @brief Memory used by a command and its children */
+    static qint64 commandCost(const QUndoCommand *cmd);
+
 signals:
     void invalidate(int ix);
+    /** @brief The @param count oldest commands were removed, the index of the others decreased by @param count */
+    void removedOldest(int count);
+    void memoryUsageChanged(qint64 bytes);
+
+private:
+    qint64 m_memoryBudget;
+    /** @brief Running total of the cost of the commands in the stack */
+    qint64 m_memoryUsage;
+    friend class HistoryEntry;
 };
@@ -41,6 +41,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kdenlive_debug.h"
 #include <QCryptographicHash>
 #include <QDomImplementation>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QFileDialog>
 #include <QUndoGroup>
@@ -48,6 +49,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include <KJobWidgets/KJobWidgets>
 #include <QStandardPaths>
+#include <QTextCodec>
 #include <mlt++/Mlt.h>
 
 #include <locale>
@@ -57,6 +59,21 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 const double DOCUMENTVERSION = 1.04;
 
+/** @brief Returns true if @param data contains characters that are not allowed in XML and would be dropped by the parser */
+static bool containsInvalidXmlChars(const QByteArray &data)
+{
+    for (const char c : data) {
+        const auto byte = static_cast<unsigned char>(c);
+        if (byte < 0x20 && byte != '\t' && byte != '\n' && byte != '\r') {
+            return true;
+        }
+    }
+    // Invalid UTF-8 sequences and the U+FFFE / U+FFFF non characters
+    QTextCodec::ConverterState state;
+    const QString text = QTextCodec::codecForName("UTF-8")->toUnicode(data.constData(), data.size(), &state);
+    return state.invalidChars > 0 || text.contains(QChar(0xFFFE)) || text.contains(QChar(0xFFFF));
+}
+
 KdenliveDoc::KdenliveDoc(const QUrl &url, QString projectFolder, QUndoGroup *undoGroup, const QString &profileName, const QMap<QString, QString> &properties,
                          const QMap<QString, QString> &metadata, const QPair<int, int> &tracks, int audioChannels, bool *openBackup, MainWindow *parent)
     : QObject(parent)
@@ -75,6 +92,7 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, QString projectFolder, QUndoGroup *und
     bool success = false;
     connect(m_commandStack.get(), &QUndoStack::indexChanged, this, &KdenliveDoc::slotModified);
     connect(m_commandStack.get(), &DocUndoStack::invalidate, this, &KdenliveDoc::checkPreviewStack, Qt::DirectConnection);
+    connect(m_commandStack.get(), &DocUndoStack::removedOldest, this, &KdenliveDoc::removeOldestUndo, Qt::DirectConnection);
     // connect(m_commandStack, SIGNAL(cleanChanged(bool)), this, SLOT(setModified(bool)));
     
     // init default document properties
@@ -129,12 +147,22 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, QString projectFolder, QUndoGroup *und
             // KMessageBox::error(parent, KIO::NetAccess::lastErrorString());
         } else {
             qCDebug(KDENLIVE_LOG) << " // / processing file open";
+            QElapsedTimer phaseTimer;
+            phaseTimer.start();
             QString errorMsg;
             int line;
             int col;
-            QDomImplementation::setInvalidDataPolicy(QDomImplementation::DropInvalidChars);
-            success = m_document.setContent(&file, false, &errorMsg, &line, &col);
+            // Keep the file data, it can be passed as is to MLT if validation does not change anything
+            m_projectData = file.readAll();
             file.close();
+            recordOpenPhase(QStringLiteral("read"), phaseTimer.restart());
+            QDomImplementation::setInvalidDataPolicy(QDomImplementation::DropInvalidChars);
+            success = m_document.setContent(m_projectData, false, &errorMsg, &line, &col);
+            if (success && containsInvalidXmlChars(m_projectData)) {
+                // Some characters were dropped by the parser, the raw data cannot be reused
+                m_documentChanged = true;
+            }
+            recordOpenPhase(QStringLiteral("parse"), phaseTimer.restart());
 
             if (!success) {
                 // It is corrupted
@@ -172,6 +200,7 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, QString projectFolder, QUndoGroup *und
                             // Document was modified, ask for backup
                             QDomElement mlt = m_document.documentElement();
                             mlt.setAttribute(QStringLiteral("modified"), 1);
+                            m_documentChanged = true;
                         }
                     }
                 }
@@ -206,14 +235,19 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, QString projectFolder, QUndoGroup *und
                     if (success && !KdenliveSettings::gpu_accel()) {
                         success = validator.checkMovit();
                     }
+                    m_documentChanged = m_documentChanged || validator.documentChanged();
+                    recordOpenPhase(QStringLiteral("validate"), phaseTimer.restart());
                     if (success) { // Let the validator handle error messages
                         qCDebug(KDENLIVE_LOG) << " // / processing file validate ok";
                         pCore->displayMessage(i18n("Check missing clips"), InformationMessage, 300);
                         qApp->processEvents();
                         DocumentChecker d(m_url, m_document);
                         success = !d.hasErrorInClips();
+                        m_documentChanged = m_documentChanged || d.documentChanged();
+                        recordOpenPhase(QStringLiteral("check clips"), phaseTimer.restart());
                         if (success) {
                             loadDocumentProperties();
+                            recordOpenPhase(QStringLiteral("properties"), phaseTimer.restart());
                             if (m_document.documentElement().hasAttribute(QStringLiteral("upgraded"))) {
                                 m_documentOpenStatus = UpgradedProject;
                                 pCore->displayMessage(i18n("Your project was upgraded, a backup will be created on next save"), ErrorMessage);
@@ -235,6 +269,7 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, QString projectFolder, QUndoGroup *und
         m_url.clear();
         pCore->setCurrentProfile(profileName);
         m_document = createEmptyDocument(tracks.first, tracks.second);
+        m_projectData.clear();
         updateProjectProfile(false);
     } else {
         m_clipsCount = m_document.elementsByTagName(QLatin1String("entry")).size();
@@ -297,12 +332,35 @@ int KdenliveDoc::clipsCount() const
 
 const QByteArray KdenliveDoc::getAndClearProjectXml()
 {
-    const QByteArray result = m_document.toString().toUtf8();
+    QByteArray result;
+    if (!m_documentChanged && !m_projectData.isEmpty()) {
+        // The document was not changed since it was read, avoid serializing it again
+        result = m_projectData;
+    } else {
+        result = m_document.toString().toUtf8();
+    }
     // We don't need the xml data anymore, throw away
     m_document.clear();
+    m_projectData.clear();
     return result;
 }
 
+void KdenliveDoc::recordOpenPhase(const QString &phase, qint64 ms)
+{
+    m_openTimings.append({phase, ms});
+}
+
+QString KdenliveDoc::openTimings() const
+{
+    QStringList phases;
+    qint64 total = 0;
+    for (const auto &timing : m_openTimings) {
+        phases << QStringLiteral("%1: %2ms").arg(timing.first).arg(timing.second);
+        total += timing.second;
+    }
+    return QStringLiteral("%1 (total %2ms)").arg(phases.join(QStringLiteral(", "))).arg(total);
+}
+
 QDomDocument KdenliveDoc::createEmptyDocument(int videotracks, int audiotracks)
 {
     QList<TrackInfo> tracks;
@@ -428,23 +486,34 @@ bool KdenliveDoc::autoGenerateImageProxy(int width) const
 void KdenliveDoc::slotAutoSave(const QString &scene)
 {
     if (m_autosave != nullptr) {
-        if (!m_autosave->isOpen() && !m_autosave->open(QIODevice::ReadWrite)) {
-            // show error: could not open the autosave file
-            qCDebug(KDENLIVE_LOG) << "ERROR; CANNOT CREATE AUTOSAVE FILE";
-            pCore->displayMessage(i18n("Cannot create autosave file %1", m_autosave->fileName()), ErrorMessage);
-            return;
-        }
         if (scene.isEmpty()) {
             // Make sure we don't save if scenelist is corrupted
             KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1, scene list is corrupted.", m_autosave->fileName()));
             return;
         }
-        m_autosave->resize(0);
-        if (m_autosave->write(scene.toUtf8()) < 0) {
+        if (!writeAutoSave(scene.toUtf8())) {
             pCore->displayMessage(i18n("Cannot create autosave file %1", m_autosave->fileName()), ErrorMessage);
-        };
-        m_autosave->flush();
+        }
+    }
+}
+
+bool KdenliveDoc::writeAutoSave(const QByteArray &scene)
+{
+    if (m_autosave == nullptr) {
+        return false;
+    }
+    QMutexLocker lock(&m_autoSaveMutex);
+    if (!m_autosave->isOpen() && !m_autosave->open(QIODevice::ReadWrite)) {
+        // show error: could not open the autosave file
+        qCDebug(KDENLIVE_LOG) << "ERROR; CANNOT CREATE AUTOSAVE FILE";
+        return false;
     }
+    m_autosave->resize(0);
+    if (m_autosave->write(scene) < 0) {
+        return false;
+    }
+    m_autosave->flush();
+    return true;
 }
 
 void KdenliveDoc::setZoom(int horizontal, int vertical)
@@ -1691,6 +1760,7 @@ void KdenliveDoc::initCacheDirs()
     dir.mkdir(QStringLiteral("preview"));
     dir.mkdir(QStringLiteral("audiothumbs"));
     dir.mkdir(QStringLiteral("videothumbs"));
+    dir.mkdir(QStringLiteral("analysis"));
     QDir cacheDir(kdenliveCacheDir);
     cacheDir.mkdir(QStringLiteral("proxy"));
 }
@@ -1731,6 +1801,9 @@ QDir KdenliveDoc::getCacheDir(CacheType type, bool *ok) const
     case CacheThumbs:
         basePath.append(QStringLiteral("/videothumbs"));
         break;
+    case CacheAnalysis:
+        basePath.append(QStringLiteral("/analysis"));
+        break;
     default:
         break;
     }
@@ -16,6 +16,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QDir>
 #include <QList>
 #include <QMap>
+#include <QMutex>
 #include <QUuid>
 #include <memory>
 #include <qdom.h>
@@ -51,8 +52,13 @@ public:
                 const QMap<QString, QString> &metadata, const QPair<int, int> &tracks, int audioChannels, bool *openBackup, MainWindow *parent = nullptr);
     ~KdenliveDoc() override;
     friend class LoadJob;
-    /** @brief Get current document's producer. */
+    /** @brief Returns the project xml to be passed to MLT and clears it.
+     *  This is the original file data if the document did not need to be changed when it was parsed and validated. */
     const QByteArray getAndClearProjectXml();
+    /** @brief Store the duration of a project opening phase, for diagnostics */
+    void recordOpenPhase(const QString &phase, qint64 ms);
+    /** @brief A readable summary of the durations of the project opening phases */
+    QString openTimings() const;
     double fps() const;
     int width() const;
     int height() const;
@@ -206,6 +212,13 @@ private:
     std::weak_ptr<SubtitleModel> m_subtitleModel;
 
     QString m_modifiedDecimalPoint;
+    /** @brief The project file data as read on disk, cleared once passed to MLT */
+    QByteArray m_projectData;
+    /** @brief True if m_document was changed (upgraded, fixed) after parsing m_projectData */
+    bool m_documentChanged{false};
+    QList<QPair<QString, qint64>> m_openTimings;
+    /** @brief Serializes writes to the autosave file, that can happen from a background thread */
+    QMutex m_autoSaveMutex;
 
     QString searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash) const;
 
@@ -240,6 +253,10 @@ public slots:
      * 
      * The autosave files are in ~/.kde/data/stalefiles/kdenlive/ */
     void slotAutoSave(const QString &scene);
+    /** @brief Write @param scene to the autosave file, can be called from a background thread.
+     *  Errors are not reported to the user, it is up to the caller to do so from the GUI thread.
+     *  @returns false if the file could not be written */
+    bool writeAutoSave(const QByteArray &scene);
     /** @brief Groups were changed, save to MLT. */
     void groupsChanged(const QString &groups);
     void switchProfile(ProfileParam* pf, const QString clipName);
@@ -270,6 +287,8 @@ signals:
     void updateFps(double changed);
     /** @brief If a command is pushed when we are in the middle of undo stack, invalidate further undo history */
     void removeInvalidUndo(int ix);
+    /** @brief The oldest commands were removed from the undo stack, shift the undo history */
+    void removeOldestUndo(int count);
     /** @brief Update compositing info */
     void updateCompositionMode(int);
 };
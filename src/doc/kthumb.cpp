@@ -9,6 +9,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "core.h"
 #include "kdenlivesettings.h"
 #include "profiles/profilemodel.hpp"
+#include "utils/colorconversion.h"
 
 #include <mlt++/Mlt.h>
 
@@ -98,12 +99,12 @@ QImage KThumb::getFrame(Mlt::Frame *frame, int width, int height, int scaledWidt
     mlt_image_format format = mlt_image_rgba;
     const uchar *imagedata = frame->get_image(format, ow, oh);
     if (imagedata) {
-        QImage temp(ow, oh, QImage::Format_ARGB32);
-        memcpy(temp.scanLine(0), imagedata, unsigned(ow * oh * 4));
+        // Convert directly from MLT's buffer, avoiding a copy and a separate rgbSwapped() pass
+        QImage temp = ColorConversion::fromRgba(imagedata, ow, oh);
         if (scaledWidth == 0 || scaledWidth == width) {
-            return temp.rgbSwapped();
+            return temp;
         }
-        return temp.rgbSwapped().scaled(scaledWidth, height == 0 ? oh : height);
+        return temp.scaled(scaledWidth, height == 0 ? oh : height);
     }
     return QImage();
 }
@@ -102,7 +102,8 @@ void EffectStackModel::removeAllEffects(Fun &undo, Fun & redo)
         std::shared_ptr<EffectItemModel> effect = std::static_pointer_cast<EffectItemModel>(rootItem->child(0));
         int parentId = -1;
         if (auto ptr = effect->parentItem().lock()) parentId = ptr->getId();
-        Fun local_undo = addItem_lambda(effect, parentId);
+        // The removed effect is only kept alive by the undo lambda
+        Fun local_undo = UndoPayload::attach(addItem_lambda(effect, parentId), effect->dataSize());
         Fun local_redo = removeItem_lambda(effect->getId());
         local_redo();
         UPDATE_UNDO_REDO(local_redo, local_undo, undo, redo);
@@ -161,7 +162,7 @@ void EffectStackModel::removeEffect(const std::shared_ptr<EffectItemModel> &effe
     }
     setActiveEffect(current);
     int currentRow = effect->row();
-    Fun undo = addItem_lambda(effect, parentId);
+    Fun undo = UndoPayload::attach(addItem_lambda(effect, parentId), effect->dataSize());
     if (currentRow != rowCount() - 1) {
         Fun move = moveItem_lambda(effect->getId(), currentRow, true);
         PUSH_LAMBDA(move, undo);
@@ -235,6 +236,15 @@ bool EffectStackModel::copyXmlEffect(const QDomElement &effect)
     return result;
 }
 
+qint64 EffectStackModel::dataSize() const
+{
+    qint64 size = 0;
+    for (int i = 0; i < rootItem->childCount(); ++i) {
+        size += std::static_pointer_cast<EffectItemModel>(rootItem->child(i))->dataSize();
+    }
+    return size;
+}
+
 QDomElement EffectStackModel::toXml(QDomDocument &document)
 {
     QDomElement container = document.createElement(QStringLiteral("effects"));
@@ -1299,7 +1309,7 @@ void EffectStackModel::cleanFadeEffects(bool outEffects, Fun &undo, Fun &redo)
         auto effect = std::static_pointer_cast<EffectItemModel>(getItemById(id));
         Fun operation = removeItem_lambda(id);
         if (operation()) {
-            Fun reverse = addItem_lambda(effect, rootItem->getId());
+            Fun reverse = UndoPayload::attach(addItem_lambda(effect, rootItem->getId()), effect->dataSize());
             UPDATE_UNDO_REDO(operation, reverse, undo, redo);
         }
     }
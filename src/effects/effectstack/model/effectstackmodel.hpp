@@ -116,6 +116,8 @@ public:
 
     bool isStackEnabled() const;
 
+    /** @brief Memory used by the parameters of all effects in the stack */
+    qint64 dataSize() const;
     /** @brief Returns an XML representation of the effect stack with all parameters */
     QDomElement toXml(QDomDocument &document);
     /** @brief Returns an XML representation of one of the effect in the stack with all parameters */
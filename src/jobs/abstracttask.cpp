@@ -32,8 +32,13 @@ AbstractTask::AbstractTask(const ObjectId &owner, JOBTYPE type, QObject* object)
     , m_isForce(false)
     , m_running(false)
     , m_type(type)
+    , m_runStart(-1)
+    , m_canceledAt(-1)
+    , m_sourceBytes(0)
+    , m_framesDecoded(0)
 {
     setAutoDelete(true);
+    m_lifeTimer.start();
     switch (type) {
         case AbstractTask::LOADJOB:
             m_priority = 10;
@@ -56,7 +61,9 @@ AbstractTask::AbstractTask(const ObjectId &owner, JOBTYPE type, QObject* object)
 
 void AbstractTask::cancelJob(bool softDelete)
 {
-    m_isCanceled.testAndSetAcquire(0, 1);
+    if (m_isCanceled.testAndSetAcquire(0, 1)) {
+        m_canceledAt.testAndSetRelaxed(-1, m_lifeTimer.elapsed());
+    }
     if (softDelete) {
         m_softDelete.testAndSetAcquire(0, 1);
     }
@@ -82,3 +89,19 @@ void AbstractTask::run()
 {
     qDebug()<<"============0\n\nABSTRACT TASKSTARTRING\n\n==================";
 }
+
+void AbstractTask::beginRun()
+{
+    m_runStart = m_lifeTimer.elapsed();
+    pCore->taskManager.taskStarted(this);
+}
+
+void AbstractTask::addSourceBytes(qint64 bytes)
+{
+    m_sourceBytes.fetchAndAddRelaxed(bytes);
+}
+
+void AbstractTask::addFramesDecoded(qint64 frames)
+{
+    m_framesDecoded.fetchAndAddRelaxed(frames);
+}
@@ -10,6 +10,8 @@
 
 #include <QRunnable>
 #include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QObject>
 
@@ -31,7 +33,8 @@ public:
         LOADJOB = 8,
         AUDIOTHUMBJOB = 9,
         SPEEDJOB = 10,
-        CACHEJOB = 11
+        CACHEJOB = 11,
+        INGESTJOB = 12
     };
     AbstractTask(const ObjectId &owner, JOBTYPE type, QObject* object);
     virtual ~AbstractTask();
@@ -48,14 +51,28 @@ protected:
     QAtomicInt m_softDelete;
     bool m_isForce;
     bool m_running;
+    /** @brief Priority in the thread pool, higher priority tasks are started first */
+    int m_priority;
     void run() override;
     void cleanup();
+    /** @brief Called at the start of run(), the time spent before that is counted as queue time in the job metrics */
+    void beginRun();
+    /** @brief Account the size of the source files of a successfully processed clip, and the number of decoded frames in the job metrics */
+    void addSourceBytes(qint64 bytes);
+    void addFramesDecoded(qint64 frames);
 
 private:
     //QString cacheKey();
     JOBTYPE m_type;
-    int m_priority;
     void cancelJob(bool softDelete = false);
+    /** @brief Started when the task is queued, job metrics timestamps are relative to it */
+    QElapsedTimer m_lifeTimer;
+    /** @brief Time (ms) at which run() started, or -1 */
+    qint64 m_runStart;
+    /** @brief Time (ms) at which the task was canceled, or -1 */
+    QAtomicInteger<qint64> m_canceledAt;
+    QAtomicInteger<qint64> m_sourceBytes;
+    QAtomicInteger<qint64> m_framesDecoded;
     
 signals:
     void jobCanceled();
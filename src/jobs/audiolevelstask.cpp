@@ -10,6 +10,8 @@
 #include "bin/projectclip.h"
 #include "bin/projectitemmodel.h"
 #include "core.h"
+#include "kdenlive_debug.h"
+#include "utils/audiopeaks.h"
 
 #include <KMessageWidget>
 #include <QElapsedTimer>
@@ -24,6 +26,8 @@
 #include <QVariantList>
 #include <klocalizedstring.h>
 
+#include <vector>
+
 static QList<AudioLevelsTask*> tasksList;
 static QMutex tasksListMutex;
 
@@ -53,8 +57,34 @@ void AudioLevelsTask::start(const ObjectId &owner, QObject* object, bool force)
     }
 }
 
+bool AudioLevelsTask::saveLevels(const QVector<uint8_t> &levels, int channels, const QString &path)
+{
+    if (levels.isEmpty() || channels <= 0) {
+        return false;
+    }
+    int count = levels.size();
+    QImage image((count + 3) / 4 / channels, channels, QImage::Format_ARGB32);
+    int n = image.width() * image.height();
+    for (int i = 0; i < n; i ++) {
+        QRgb p;
+        if ((4*i + 3) < count) {
+            p = qRgba(levels.at(4*i), levels.at(4*i+1), levels.at(4*i+2), levels.at(4*i+3));
+        } else {
+            int last = levels.last();
+            int r = (4*i+0) < count? levels.at(4*i+0) : last;
+            int g = (4*i+1) < count? levels.at(4*i+1) : last;
+            int b = (4*i+2) < count? levels.at(4*i+2) : last;
+            int a = last;
+            p = qRgba(r, g, b, a);
+        }
+        image.setPixel(i / channels, i % channels, p);
+    }
+    return image.save(path);
+}
+
 void AudioLevelsTask::run()
 {
+    beginRun();
     m_running = true;
     // 2 channels interleaved of uchar values
     if (m_isCanceled) {
@@ -95,153 +125,218 @@ void AudioLevelsTask::run()
 
     QMap <int, QString> streams = binClip->audioInfo()->streams();
     QMap <int, int> audioChannels = binClip->audioInfo()->streamChannels();
-    QMapIterator<int, QString> st(streams);
-    bool audioCreated = false;
-    while (st.hasNext() && !m_isCanceled) {
-        st.next();
-        int stream = st.key();
-        if (audioChannels.contains(stream)) {
-            channels = audioChannels.value(stream);
+    // Load the cached thumbs and list the streams that have to be decoded
+    QList<int> missingStreams;
+    for (int stream : streams.keys()) {
+        if (m_isCanceled) {
+            break;
         }
-        // Generate one thumb per stream
-        QString cachePath = binClip->getAudioThumbPath(stream);
-        QVector <uint8_t> mltLevels;
-        if (!m_isForce && QFile::exists(cachePath)) {
-            // Audio thumb already exists
-            QImage image(cachePath);
-            if (!m_isCanceled && !image.isNull()) {
-                // convert cached image
-                int n = image.width() * image.height();
-                for (int i = 0; n > 1 && i < n; i++) {
-                    QRgb p = image.pixel(i / channels, i % channels);
-                    mltLevels << qRed(p);
-                    mltLevels << qGreen(p);
-                    mltLevels << qBlue(p);
-                    mltLevels << qAlpha(p);
-                }
-                if (mltLevels.size() > 0) {
-                    QVector <uint8_t>* levelsCopy = new QVector <uint8_t>(mltLevels);
-                    producer->lock();
-                    QString key = QString("_kdenlive:audio%1").arg(stream);
-                    producer->set(key.toUtf8().constData(), levelsCopy, 0, (mlt_destructor) deleteQVariantList);
-                    producer->unlock();
-                    continue;
-                }
-            }
+        if (m_isForce || !loadCachedLevels(producer, stream, audioChannels.value(stream, channels), binClip->getAudioThumbPath(stream))) {
+            missingStreams << stream;
         }
+    }
+    bool audioCreated = false;
+    if (!missingStreams.isEmpty() && !m_isCanceled) {
         QString service = producer->get("mlt_service");
         if (service == QLatin1String("avformat-novalidate")) {
             service = QStringLiteral("avformat");
         } else if (service.startsWith(QLatin1String("xml"))) {
             service = QStringLiteral("xml-nogl");
         }
-        QScopedPointer<Mlt::Producer> audioProducer(new Mlt::Producer(*producer->profile(), service.toUtf8().constData(), producer->get("resource")));
-        if (!audioProducer->is_valid()) {
-            QMetaObject::invokeMethod(pCore.get(), "displayBinMessage", Qt::QueuedConnection, Q_ARG(QString, i18n("Audio thumbs: cannot open file %1", producer->get("resource"))),
-                                  Q_ARG(int, int(KMessageWidget::Warning)));
-            pCore->taskManager.taskDone(m_owner.second, this);
-            return;
+        bool decoded = false;
+        if (missingStreams.size() > 1 && service == QLatin1String("avformat") && audioChannels.keys() == streams.keys()) {
+            // Decode all streams in a single demux pass, their channels are appended in stream order
+            decoded = decodeStreams(producer, service, QStringLiteral("all"), streams.keys(), audioChannels.values(), missingStreams, lengthInFrames, frequency,
+                                    binClip, 0, 100);
+            if (!decoded && !m_isCanceled) {
+                qCDebug(KDENLIVE_LOG) << "Audio thumbs: cannot decode all streams at once, decoding them separately" << producer->get("resource");
+            }
         }
-        audioProducer->set("video_index", "-1");
-        audioProducer->set("audio_index", stream);
-        Mlt::Filter chans(*producer->profile(), "audiochannels");
-        Mlt::Filter converter(*producer->profile(), "audioconvert");
-        Mlt::Filter levels(*producer->profile(), "audiolevel");
+        for (int i = 0; !decoded && i < missingStreams.size() && !m_isCanceled; ++i) {
+            const int stream = missingStreams.at(i);
+            if (!decodeStreams(producer, service, QString::number(stream), {stream}, {audioChannels.value(stream, channels)}, {stream}, lengthInFrames,
+                               frequency, binClip, 100 * i / missingStreams.size(), 100 / missingStreams.size())) {
+                QMetaObject::invokeMethod(pCore.get(), "displayBinMessage", Qt::QueuedConnection, Q_ARG(QString, i18n("Audio thumbs: cannot open file %1", producer->get("resource"))),
+                                          Q_ARG(int, int(KMessageWidget::Warning)));
+                break;
+            }
+        }
+        audioCreated = !m_isCanceled;
+    }
+    m_progress = 100;
+    QMetaObject::invokeMethod(m_object, "updateJobProgress");
+    if (!audioCreated && !m_isCanceled) {
+        // Audio was cached, ensure the bin thumbnail is loaded
+        QMetaObject::invokeMethod(m_object, "updateAudioThumbnail", Q_ARG(bool, true));
+    }
+    pCore->taskManager.taskDone(m_owner.second, this);
+    QMetaObject::invokeMethod(m_object, "updateJobProgress");
+}
+
+bool AudioLevelsTask::loadCachedLevels(const std::shared_ptr<Mlt::Producer> &producer, int stream, int channels, const QString &cachePath)
+{
+    if (!QFile::exists(cachePath)) {
+        return false;
+    }
+    QImage image(cachePath);
+    if (image.isNull()) {
+        return false;
+    }
+    // convert cached image
+    QVector <uint8_t> mltLevels;
+    int n = image.width() * image.height();
+    for (int i = 0; n > 1 && i < n; i++) {
+        QRgb p = image.pixel(i / channels, i % channels);
+        mltLevels << qRed(p);
+        mltLevels << qGreen(p);
+        mltLevels << qBlue(p);
+        mltLevels << qAlpha(p);
+    }
+    if (mltLevels.isEmpty()) {
+        return false;
+    }
+    storeLevels(producer, stream, mltLevels, -1);
+    return true;
+}
+
+void AudioLevelsTask::storeLevels(const std::shared_ptr<Mlt::Producer> &producer, int stream, const QVector<uint8_t> &levels, int maxLevel)
+{
+    QVector <uint8_t>* levelsCopy = new QVector <uint8_t>(levels);
+    producer->lock();
+    QString key = QString("_kdenlive:audio%1").arg(stream);
+    if (maxLevel > -1) {
+        QString key2 = QString("kdenlive:audio_max%1").arg(stream);
+        producer->set(key2.toUtf8().constData(), maxLevel);
+    }
+    producer->set(key.toUtf8().constData(), levelsCopy, 0, (mlt_destructor) deleteQVariantList);
+    producer->unlock();
+}
+
+bool AudioLevelsTask::decodeStreams(const std::shared_ptr<Mlt::Producer> &producer, const QString &service, const QString &audioIndex,
+                                    const QList<int> &streams, const QList<int> &streamChannels, const QList<int> &wanted, int lengthInFrames,
+                                    int frequency, const std::shared_ptr<ProjectClip> &binClip, int progressStart, int progressRange)
+{
+    // Decode media files in blocks of several frames: the producer uses a frame rate divided by the block size, so that each
+    // of its frames carries the audio of blockFrames clip frames, and the peaks are computed here for each clip frame.
+    // Playlists keep the project frame rate since their content is positioned in frames.
+    const int blockFrames = service == QLatin1String("avformat") ? 50 : 1;
+    Mlt::Profile blockProfile;
+    blockProfile.set_frame_rate(producer->profile()->frame_rate_num(), producer->profile()->frame_rate_den() * blockFrames);
+    blockProfile.set_explicit(1);
+    Mlt::Profile *profile = blockFrames > 1 ? &blockProfile : producer->profile();
+    QScopedPointer<Mlt::Producer> audioProducer(new Mlt::Producer(*profile, service.toUtf8().constData(), producer->get("resource")));
+    if (!audioProducer->is_valid()) {
+        return false;
+    }
+    // Channel layout of the decoded audio
+    int channels = 0;
+    QVector<int> offsets;
+    for (int count : streamChannels) {
+        offsets << channels;
+        channels += count;
+    }
+    audioProducer->set("video_index", "-1");
+    audioProducer->set("audio_index", audioIndex.toUtf8().constData());
+    Mlt::Filter chans(*profile, "audiochannels");
+    Mlt::Filter converter(*profile, "audioconvert");
+    if (streams.size() == 1) {
+        // With all streams, the channel count must stay the sum of the streams channels
         audioProducer->attach(chans);
-        audioProducer->attach(converter);
-        audioProducer->attach(levels);
+    }
+    audioProducer->attach(converter);
 
-        double framesPerSecond = audioProducer->get_fps();
+    // Limit the number of files decoded at the same time from one disk
+    const QByteArray device = pCore->taskManager.acquireReadSlot(QString::fromUtf8(producer->get("resource")), m_isCanceled);
+    if (device.isEmpty()) {
+        return true;
+    }
+    const float framesPerSecond = float(producer->get_fps());
+    std::vector<int> peaks(size_t(channels), 0);
+    QVector<QVector<uint8_t>> levels(streams.size());
+    QVector<uint> maxLevels(streams.size(), 1);
+    for (int ix = 0; ix < streams.size(); ++ix) {
+        if (wanted.contains(streams.at(ix))) {
+            levels[ix].reserve(lengthInFrames * streamChannels.at(ix));
+        }
+    }
+    bool validLayout = true;
+    QElapsedTimer updateTime;
+    updateTime.start();
+    for (int first = 0; first < lengthInFrames && !m_isCanceled; first += blockFrames) {
+        int val = progressStart + int(double(progressRange) * first / lengthInFrames);
+        if (m_progress != val) {
+            m_progress = val;
+            QMetaObject::invokeMethod(m_object, "updateJobProgress");
+        }
+        const int last = qMin(lengthInFrames, first + blockFrames);
+        const int64_t blockStart = mlt_audio_calculate_samples_to_position(framesPerSecond, frequency, first);
+        int samples = int(mlt_audio_calculate_samples_to_position(framesPerSecond, frequency, last) - blockStart);
+        const int requestedSamples = samples;
+        int blockChannels = channels;
+        int blockFrequency = frequency;
         mlt_audio_format audioFormat = mlt_audio_s16;
-        QStringList keys;
-        keys.reserve(channels);
-        for (int i = 0; i < channels; i++) {
-            keys << "meta.media.audio_level." + QString::number(i);
+        const int16_t *data = nullptr;
+        QScopedPointer<Mlt::Frame> mltFrame(audioProducer->get_frame());
+        if ((mltFrame != nullptr) && mltFrame->is_valid() && (mltFrame->get_int("test_audio") == 0)) {
+            data = static_cast<const int16_t *>(mltFrame->get_audio(audioFormat, blockFrequency, blockChannels, samples));
+            if (audioFormat != mlt_audio_s16 || blockChannels != channels) {
+                validLayout = false;
+                break;
+            }
+            addFramesDecoded(last - first);
         }
-        uint maxLevel = 1;
-        QElapsedTimer updateTime;
-        updateTime.start();
-        for (int z = 0; z < lengthInFrames && !m_isCanceled; ++z) {
-            int val = int(100.0 * z / lengthInFrames);
-            if (m_progress != val) {
-                m_progress = val;
-                QMetaObject::invokeMethod(m_object, "updateJobProgress");
+        for (int z = first; z < last; ++z) {
+            const int offset = int(mlt_audio_calculate_samples_to_position(framesPerSecond, frequency, z) - blockStart);
+            const int count = mlt_audio_calculate_frame_samples(framesPerSecond, frequency, z);
+            const bool valid = data != nullptr && offset + count <= qMin(samples, requestedSamples);
+            if (valid) {
+                AudioPeaks::channelPeaks(data + offset * channels, count, channels, peaks.data());
             }
-            QScopedPointer<Mlt::Frame> mltFrame(audioProducer->get_frame());
-            if ((mltFrame != nullptr) && mltFrame->is_valid() && (mltFrame->get_int("test_audio") == 0)) {
-                int samples = mlt_audio_calculate_frame_samples(float(framesPerSecond), frequency, z);
-                mltFrame->get_audio(audioFormat, frequency, channels, samples);
-                for (int channel = 0; channel < channels; ++channel) {
-                    uint lev = 256 * qMin(mltFrame->get_double(keys.at(channel).toUtf8().constData()) * 0.9, 1.0);
-                    mltLevels << lev;
-                    //double lev = mltFrame->get_double(keys.at(channel).toUtf8().constData());
-                    //mltLevels << lev;
-                    maxLevel = qMax(lev, maxLevel);
+            for (int ix = 0; ix < streams.size(); ++ix) {
+                QVector<uint8_t> &streamLevels = levels[ix];
+                if (!wanted.contains(streams.at(ix))) {
+                    continue;
                 }
-            } else if (!mltLevels.isEmpty()) {
-                for (int channel = 0; channel < channels; channel++) {
-                    mltLevels << mltLevels.last();
+                if (valid) {
+                    for (int channel = 0; channel < streamChannels.at(ix); ++channel) {
+                        uint8_t lev = AudioPeaks::level(peaks[size_t(offsets.at(ix) + channel)]);
+                        streamLevels << lev;
+                        maxLevels[ix] = qMax(uint(lev), maxLevels.at(ix));
+                    }
+                } else if (!streamLevels.isEmpty()) {
+                    for (int channel = 0; channel < streamChannels.at(ix); channel++) {
+                        streamLevels << streamLevels.last();
+                    }
                 }
             }
-            // Incrementally update the audio levels every 3 seconds.
-            if (updateTime.elapsed() > 3000 && !m_isCanceled) {
-                updateTime.restart();
-                QVector <uint8_t>* levelsCopy = new  QVector <uint8_t>(mltLevels);
-                producer->lock();
-                QString key = QString("_kdenlive:audio%1").arg(stream);
-                producer->set(key.toUtf8().constData(), levelsCopy, 0, (mlt_destructor) deleteQVariantList);
-                producer->unlock();
-                QMetaObject::invokeMethod(m_object, "updateAudioThumbnail", Q_ARG(bool, false));
-            }
-        }
-        
-        /*// Normalize
-        for (double &v : mltLevels) {
-            m_audioLevels << uchar(255 * v / maxLevel);
-        }*/
-        if (m_isCanceled) {
-            mltLevels.clear();
-            m_progress = 100;
-            QMetaObject::invokeMethod(m_object, "updateJobProgress");
         }
-        if (mltLevels.size() > 0) {
-            QVector <uint8_t>* levelsCopy = new  QVector <uint8_t>(mltLevels);
-            producer->lock();
-            QString key = QString("_kdenlive:audio%1").arg(stream);
-            QString key2 = QString("kdenlive:audio_max%1").arg(stream);
-            producer->set(key2.toUtf8().constData(), int(maxLevel));
-            producer->set(key.toUtf8().constData(), levelsCopy, 0, (mlt_destructor) deleteQVariantList);
-            producer->unlock();
-            //qDebug()<<"=== FINISHED PRODUCING AUDIO FOR: "<<key<<", SIZE: "<<levelsCopy->size();
-            m_progress = 100;
-            QMetaObject::invokeMethod(m_object, "updateJobProgress");
-            // Put into an image for caching.
-            int count = mltLevels.size();
-            QImage image((count + 3) / 4 / channels, channels, QImage::Format_ARGB32);
-            int n = image.width() * image.height();
-            for (int i = 0; i < n; i ++) {
-                QRgb p;
-                if ((4*i + 3) < count) {
-                    p = qRgba(mltLevels.at(4*i), mltLevels.at(4*i+1), mltLevels.at(4*i+2), mltLevels.at(4*i+3));
-                } else {
-                    int last = mltLevels.last();
-                    int r = (4*i+0) < count? mltLevels.at(4*i+0) : last;
-                    int g = (4*i+1) < count? mltLevels.at(4*i+1) : last;
-                    int b = (4*i+2) < count? mltLevels.at(4*i+2) : last;
-                    int a = last;
-                    p = qRgba(r, g, b, a);
+        // Incrementally update the audio levels every 3 seconds.
+        if (updateTime.elapsed() > 3000 && !m_isCanceled) {
+            updateTime.restart();
+            for (int ix = 0; ix < streams.size(); ++ix) {
+                if (!levels.at(ix).isEmpty()) {
+                    storeLevels(producer, streams.at(ix), levels.at(ix), -1);
                 }
-                image.setPixel(i / channels, i % channels, p);
             }
-            image.save(cachePath);
-            audioCreated = true;
             QMetaObject::invokeMethod(m_object, "updateAudioThumbnail", Q_ARG(bool, false));
         }
     }
-    if (!audioCreated && !m_isCanceled) {
-        // Audio was cached, ensure the bin thumbnail is loaded
-        QMetaObject::invokeMethod(m_object, "updateAudioThumbnail", Q_ARG(bool, true));
+    pCore->taskManager.releaseReadSlot(device);
+    if (!validLayout) {
+        return false;
     }
-    pCore->taskManager.taskDone(m_owner.second, this);
-    QMetaObject::invokeMethod(m_object, "updateJobProgress");
+    if (m_isCanceled) {
+        return true;
+    }
+    addSourceBytes(QFileInfo(QString::fromUtf8(producer->get("resource"))).size());
+    for (int ix = 0; ix < streams.size(); ++ix) {
+        if (levels.at(ix).isEmpty()) {
+            continue;
+        }
+        storeLevels(producer, streams.at(ix), levels.at(ix), int(maxLevels.at(ix)));
+        // Put into an image for caching.
+        saveLevels(levels.at(ix), streamChannels.at(ix), binClip->getAudioThumbPath(streams.at(ix)));
+    }
+    QMetaObject::invokeMethod(m_object, "updateAudioThumbnail", Q_ARG(bool, false));
+    return true;
 }
@@ -10,16 +10,41 @@
 
 #include "abstracttask.h"
 
+#include <QList>
 #include <QRunnable>
 #include <QObject>
+#include <QVector>
+
+#include <memory>
+
+class ProjectClip;
+namespace Mlt {
+class Producer;
+}
 
 class AudioLevelsTask : public AbstractTask
 {
 public:
     AudioLevelsTask(const ObjectId &owner, QObject* object);
     static void start(const ObjectId &owner, QObject* object, bool force = false);
+    /** @brief Save interleaved audio levels as the cached audio thumbnail image in @param path */
+    static bool saveLevels(const QVector<uint8_t> &levels, int channels, const QString &path);
 
 protected:
     void run() override;
 
+private:
+    /** @brief Load the levels of @param stream from its cached thumbnail image, returns false if there is no usable cache */
+    bool loadCachedLevels(const std::shared_ptr<Mlt::Producer> &producer, int stream, int channels, const QString &cachePath);
+    /** @brief Pass levels to the producer, @param maxLevel is only set for complete levels */
+    void storeLevels(const std::shared_ptr<Mlt::Producer> &producer, int stream, const QVector<uint8_t> &levels, int maxLevel);
+    /** @brief Decode the audio selected by @param audioIndex ("all" or a stream index) in one pass, and cache the levels of the @param wanted streams.
+        @param streams and @param streamChannels describe the streams contained in the decoded audio, in order.
+        Progress goes from @param progressStart to progressStart + @param progressRange
+        @returns false if the file cannot be opened or if the decoded audio does not match the expected channels
+     */
+    bool decodeStreams(const std::shared_ptr<Mlt::Producer> &producer, const QString &service, const QString &audioIndex, const QList<int> &streams,
+                       const QList<int> &streamChannels, const QList<int> &wanted, int lengthInFrames, int frequency,
+                       const std::shared_ptr<ProjectClip> &binClip, int progressStart, int progressRange);
+
 };
@@ -11,6 +11,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "core.h"
 #include "doc/kthumb.h"
 #include "kdenlivesettings.h"
+#include "thumbnailextractor.h"
 #include "utils/thumbnailcache.hpp"
 
 #include "xml/xml.hpp"
@@ -64,51 +65,46 @@ void CacheTask::generateThumbnail(std::shared_ptr<ProjectClip>binClip)
             frames.insert(pos);
             pos = m_in + (steps * i);
         }
-        int size = int(frames.size());
-        int count = 0;
         const QString clipId = QString::number(m_owner.second);
-        for (int i : frames) {
-            m_progress = 100 * count / size;
-            QMetaObject::invokeMethod(m_object, "updateJobProgress");
-            count++;
-            if (m_isCanceled) {
-                break;
-            }
-            if (ThumbnailCache::get()->hasThumbnail(clipId, i)) {
-                continue;
-            }
-            if (thumbProd == nullptr) {
-                thumbProd = binClip->thumbProducer();
-            }
-            if (thumbProd == nullptr) {
-                // Thumb producer not available
-                break;
-            }
-            thumbProd->seek(i);
-            QScopedPointer<Mlt::Frame> frame(thumbProd->get_frame());
-            if (frame != nullptr && frame->is_valid()) {
-#if LIBMLT_VERSION_INT < QT_VERSION_CHECK(7, 5, 0)
-                frame->set("deinterlace_method", "onefield");
-                frame->set("top_field_first", -1);
-                frame->set("rescale.interp", "nearest");
-#else
-                frame->set("consumer.deinterlacer", "onefield");
-                frame->set("consumer.top_field_first", -1);
-                frame->set("consumer.rescale", "nearest");
-#endif
-                QImage result = KThumb::getFrame(frame.data(), 0, 0, m_fullWidth);
-                if (!result.isNull()) {
-                    qDebug()<<"==== CACHING FRAME: "<<i;
-                    ThumbnailCache::get()->storeThumbnail(clipId, i, result, true);
-                }
+        // Skip the thumbnails that are already cached
+        for (auto it = frames.begin(); it != frames.end();) {
+            if (ThumbnailCache::get()->hasThumbnail(clipId, *it)) {
+                it = frames.erase(it);
+            } else {
+                ++it;
             }
         }
+        if (frames.empty() || m_isCanceled) {
+            return;
+        }
+        thumbProd = binClip->thumbProducer();
+        if (thumbProd == nullptr) {
+            // Thumb producer not available
+            return;
+        }
+        // Decode close frames sequentially instead of seeking
+        ThumbnailExtractor::Plan plan = ThumbnailExtractor::plan(frames, ThumbnailExtractor::sequentialGap(*thumbProd.get()));
+        int size = plan.steps.size();
+        int count = 0;
+        ThumbnailExtractor::Stats stats = ThumbnailExtractor::extract(
+            *thumbProd.get(), plan, m_fullWidth,
+            [this, clipId, size, &count](int pos, const QImage &result) {
+                // Thumbnails are stored as soon as they are decoded so that they can be displayed progressively
+                ThumbnailCache::get()->storeThumbnail(clipId, pos, result, true);
+                count++;
+                m_progress = 100 * count / size;
+                QMetaObject::invokeMethod(m_object, "updateJobProgress");
+                return !m_isCanceled;
+            },
+            &m_isCanceled);
+        addFramesDecoded(stats.decoded);
     }
 }
 
 
 void CacheTask::run()
 {
+    beginRun();
     if (!m_isCanceled) {
         auto binClip = pCore->projectItemModel()->getClipByBinID(QString::number(m_owner.second));
         if (binClip) {
@@ -14,6 +14,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "doc/kthumb.h"
 #include "kdenlivesettings.h"
 #include "project/dialogs/slideshowclip.h"
+#include "utils/mediaprobecache.hpp"
 #include "utils/thumbnailcache.hpp"
 
 #include "xml/xml.hpp"
@@ -309,6 +310,7 @@ void ClipLoadTask::generateThumbnail(std::shared_ptr<ProjectClip>binClip, std::s
 
 void ClipLoadTask::run()
 {
+    beginRun();
     // 2 channels interleaved of uchar values
     if (m_isCanceled) {
         abort();
@@ -599,16 +601,23 @@ void ClipLoadTask::run()
         }
     } else if (mltService == QLatin1String("avformat")) {
         // Get a frame to init properties
-        mlt_image_format format = mlt_image_none;
-        QSize frameSize = pCore->getCurrentFrameSize();
-        int w = frameSize.width();
-        int h = frameSize.height();
         std::unique_ptr<Mlt::Frame> frame(producer->get_frame());
-        frame->get_image(format, w, h);
-        // Check audio / video
-        bool hasAudio = frame->get_int("test_audio") == 0;
-        bool hasVideo = frame->get_int("test_image") == 0;
+        // Check audio / video, the image only has to be decoded if the file was not already probed
+        const QString fileHash = Xml::getXmlProperty(m_xml, QStringLiteral("kdenlive:file_hash"));
+        MediaProbeInfo probe;
+        if (!MediaProbeCache::get()->find(resource, fileHash, probe)) {
+            mlt_image_format format = mlt_image_none;
+            QSize frameSize = pCore->getCurrentFrameSize();
+            int w = frameSize.width();
+            int h = frameSize.height();
+            frame->get_image(format, w, h);
+            probe.hasAudio = frame->get_int("test_audio") == 0;
+            probe.hasVideo = frame->get_int("test_image") == 0;
+            MediaProbeCache::get()->store(resource, fileHash, probe);
+        }
         frame.reset();
+        bool hasAudio = probe.hasAudio;
+        bool hasVideo = probe.hasVideo;
         if (hasAudio) {
             if (hasVideo) {
                 producer->set("kdenlive:clip_type", 0);
@@ -196,6 +196,7 @@ void CutTask::start(const ObjectId &owner, int in , int out, QObject* object, bo
 
 void CutTask::run()
 {
+    beginRun();
     if (m_isCanceled) {
         pCore->taskManager.taskDone(m_owner.second, this);
         return;
@@ -51,6 +51,7 @@ void FilterTask::start(const ObjectId &owner, const QString &binId, const std::w
 
 void FilterTask::run()
 {
+    beginRun();
     if (m_isCanceled) {
         pCore->taskManager.taskDone(m_owner.second, this);
         return;
@@ -0,0 +1,316 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "ingestanalysistask.h"
+#include "audio/audioStreamInfo.h"
+#include "audiolevelstask.h"
+#include "bin/projectclip.h"
+#include "bin/projectitemmodel.h"
+#include "core.h"
+#include "doc/kdenlivedoc.h"
+#include "ingestanalyzers.h"
+#include "kdenlive_debug.h"
+#include "kdenlivesettings.h"
+
+#include <KMessageWidget>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <klocalizedstring.h>
+
+#include <mlt++/MltFilter.h>
+#include <mlt++/MltFrame.h>
+#include <mlt++/MltProducer.h>
+#include <mlt++/MltProfile.h>
+
+
+IngestAnalysisTask::IngestAnalysisTask(const ObjectId &owner, QObject* object)
+    : AbstractTask(owner, AbstractTask::INGESTJOB, object)
+{
+}
+
+void IngestAnalysisTask::start(const ObjectId &owner, QObject* object, bool force)
+{
+    if (pCore->taskManager.hasPendingJob(owner, AbstractTask::INGESTJOB)) {
+        return;
+    }
+    IngestAnalysisTask* task = new IngestAnalysisTask(owner, object);
+    task->m_isForce = force;
+    pCore->taskManager.startTask(owner.second, task);
+}
+
+QString IngestAnalysisTask::cachePrefix(const std::shared_ptr<ProjectClip> &binClip)
+{
+    bool ok = false;
+    QDir analysisFolder = pCore->currentDoc()->getCacheDir(CacheAnalysis, &ok);
+    if (!ok) {
+        return QString();
+    }
+    const QString clipHash = binClip->hash();
+    if (clipHash.isEmpty()) {
+        return QString();
+    }
+    return analysisFolder.absoluteFilePath(QStringLiteral("%1_%2_").arg(clipHash).arg(int(pCore->getCurrentFps())));
+}
+
+void IngestAnalysisTask::run()
+{
+    beginRun();
+    if (m_isCanceled) {
+        pCore->taskManager.taskDone(m_owner.second, this);
+        return;
+    }
+    m_running = true;
+    auto binClip = pCore->projectItemModel()->getClipByBinID(QString::number(m_owner.second));
+    if (binClip == nullptr) {
+        // Clip was deleted
+        pCore->taskManager.taskDone(m_owner.second, this);
+        return;
+    }
+    ClipType::ProducerType type = binClip->clipType();
+    bool withAudioThumbs = KdenliveSettings::audiothumbnails() && (type == ClipType::AV || type == ClipType::Audio);
+    const QString prefix = cachePrefix(binClip);
+    std::shared_ptr<Mlt::Producer> producer = binClip->originalProducer();
+    int length = producer ? producer->get_length() : 0;
+    if (prefix.isEmpty() || producer == nullptr || !producer->is_valid() || length == INT_MAX || length == 0) {
+        // Cannot analyse, use the regular audio levels job
+        pCore->taskManager.taskDone(m_owner.second, this);
+        if (withAudioThumbs) {
+            AudioLevelsTask::start(m_owner, m_object, false);
+        }
+        return;
+    }
+    bool hasVideo = type != ClipType::Audio && producer->get_int("video_index") > -1;
+    int audioStream = -1;
+    int channels = 0;
+    int frequency = 48000;
+    if (binClip->audioInfo() && binClip->audioChannels() > 0) {
+        // Only the default stream is analysed in this pass, AudioLevelsTask will handle the other ones
+        audioStream = binClip->audioInfo()->audio_index();
+        channels = binClip->audioInfo()->channelsForStream(audioStream);
+        channels = channels <= 0 ? 2 : channels;
+        frequency = binClip->audioInfo()->samplingRate();
+        frequency = frequency <= 0 ? 48000 : frequency;
+    }
+    bool hasAudio = audioStream > -1;
+
+    const QString resource = producer->get("resource");
+    std::vector<std::unique_ptr<IngestAnalyzer>> analyzers;
+    if (hasVideo && KdenliveSettings::hoverPreview()) {
+        analyzers.emplace_back(new ThumbnailSampler(QString::number(m_owner.second), ThumbnailSampler::cachePositions(binClip->getFramePlaytime(), 30, pCore->getCurrentFps())));
+    }
+    // Scene detection needs a full video decode, only do it when requested
+    bool detectScenes = m_isForce || KdenliveSettings::ingestscenedetection();
+    if (hasVideo && detectScenes && (m_isForce || !QFile::exists(IngestAnalyzer::cacheFile(prefix, QStringLiteral("scenes"))))) {
+        analyzers.emplace_back(new SceneChangeMetric());
+    }
+    if (hasAudio && (withAudioThumbs || m_isForce)) {
+        QString thumbPath;
+        if (withAudioThumbs && !binClip->audioThumbCreated()) {
+            thumbPath = binClip->getAudioThumbPath(audioStream);
+            if (!m_isForce && QFile::exists(thumbPath)) {
+                thumbPath.clear();
+            }
+        }
+        if (!thumbPath.isEmpty() || m_isForce || !QFile::exists(IngestAnalyzer::cacheFile(prefix, QStringLiteral("peaks")))) {
+            analyzers.emplace_back(new AudioPeakPyramid(thumbPath));
+        }
+        if (m_isForce || !QFile::exists(IngestAnalyzer::cacheFile(prefix, QStringLiteral("loudness")))) {
+            analyzers.emplace_back(new LoudnessMeter());
+        }
+    }
+    bool decodeVideo = false;
+    bool decodeAudio = false;
+    for (const auto &analyzer : analyzers) {
+        decodeVideo |= analyzer->wantsVideo();
+        decodeAudio |= analyzer->wantsAudio();
+    }
+    if (!decodeVideo && !decodeAudio) {
+        // Everything is already cached
+        pCore->taskManager.taskDone(m_owner.second, this);
+        if (withAudioThumbs) {
+            AudioLevelsTask::start(m_owner, m_object, false);
+        }
+        return;
+    }
+
+    std::unique_ptr<Mlt::Producer> analysisProducer = openProducer(producer, decodeVideo ? producer->get_int("video_index") : -1, decodeAudio ? audioStream : -1);
+    if (analysisProducer == nullptr) {
+        QMetaObject::invokeMethod(pCore.get(), "displayBinMessage", Qt::QueuedConnection, Q_ARG(QString, i18n("Clip analysis: cannot open file %1", resource)),
+                                  Q_ARG(int, int(KMessageWidget::Warning)));
+        pCore->taskManager.taskDone(m_owner.second, this);
+        if (withAudioThumbs) {
+            AudioLevelsTask::start(m_owner, m_object, false);
+        }
+        return;
+    }
+    IngestMediaInfo info = mediaInfo(*analysisProducer.get(), length, decodeVideo, decodeAudio ? channels : 0, frequency);
+    std::vector<IngestAnalyzer *> feed;
+    for (const auto &analyzer : analyzers) {
+        feed.push_back(analyzer.get());
+    }
+    QElapsedTimer timer;
+    timer.start();
+    bool completed = decode(*analysisProducer.get(), info, feed, [this](int progress) {
+        if (m_progress != progress) {
+            m_progress = progress;
+            QMetaObject::invokeMethod(m_object, "updateJobProgress");
+        }
+        return !m_isCanceled;
+    });
+    if (!completed) {
+        m_progress = 100;
+        pCore->taskManager.taskDone(m_owner.second, this);
+        QMetaObject::invokeMethod(m_object, "updateJobProgress");
+        return;
+    }
+    addFramesDecoded(length);
+    addSourceBytes(QFileInfo(resource).size());
+    QStringList done;
+    for (const auto &analyzer : analyzers) {
+        if (analyzer->finish(prefix)) {
+            done << analyzer->name();
+        }
+    }
+    // Throughput based on the source file size, which is what matters for large ingests
+    double seconds = qMax(qint64(1), timer.elapsed()) / 1000.;
+    double megaBytes = QFileInfo(resource).size() / 1048576.;
+    double rate = megaBytes / seconds;
+    qCDebug(KDENLIVE_LOG) << "Ingest analysis of" << resource << ":" << done << "in" << seconds << "s," << rate << "MB/s";
+    pCore->displayMessage(i18n("Analysed %1 (%2 MB/s)", QFileInfo(resource).fileName(), QString::number(rate, 'f', 1)), InformationMessage);
+    m_progress = 100;
+    pCore->taskManager.taskDone(m_owner.second, this);
+    QMetaObject::invokeMethod(m_object, "updateJobProgress");
+    if (withAudioThumbs) {
+        // Loads the levels image we just saved and processes the additional audio streams, if any
+        AudioLevelsTask::start(m_owner, m_object, false);
+    }
+}
+
+std::unique_ptr<Mlt::Producer> IngestAnalysisTask::openProducer(const std::shared_ptr<Mlt::Producer> &source, int videoIndex, int audioIndex)
+{
+    // Decode at the thumbnail size, all analyzers work on downscaled frames
+    QString service = source->get("mlt_service");
+    if (service == QLatin1String("avformat-novalidate")) {
+        service = QStringLiteral("avformat");
+    } else if (service.startsWith(QLatin1String("xml"))) {
+        service = QStringLiteral("xml-nogl");
+    }
+    Mlt::Profile *profile = pCore->thumbProfile();
+    std::unique_ptr<Mlt::Producer> producer(new Mlt::Producer(*profile, service.toUtf8().constData(), source->get("resource")));
+    if (!producer->is_valid()) {
+        return nullptr;
+    }
+    producer->set("video_index", videoIndex);
+    producer->set("audio_index", audioIndex);
+    if (audioIndex > -1) {
+        // The producer keeps a reference to the attached filters
+        Mlt::Filter chans(*profile, "audiochannels");
+        Mlt::Filter converter(*profile, "audioconvert");
+        Mlt::Filter levels(*profile, "audiolevel");
+        producer->attach(chans);
+        producer->attach(converter);
+        producer->attach(levels);
+    }
+    return producer;
+}
+
+IngestMediaInfo IngestAnalysisTask::mediaInfo(Mlt::Producer &producer, int length, bool video, int channels, int frequency)
+{
+    Mlt::Profile *profile = pCore->thumbProfile();
+    IngestMediaInfo info;
+    info.length = length;
+    info.fps = producer.get_fps();
+    info.width = video ? profile->width() : 0;
+    info.height = video ? profile->height() : 0;
+    info.fullWidth = qFuzzyCompare(pCore->getCurrentSar(), 1.0) ? 0 : qRound(profile->height() * pCore->getCurrentDar());
+    if (info.fullWidth % 2 > 0) {
+        info.fullWidth++;
+    }
+    info.frequency = frequency;
+    info.channels = channels;
+    return info;
+}
+
+bool IngestAnalysisTask::decode(Mlt::Producer &producer, const IngestMediaInfo &info, const std::vector<IngestAnalyzer *> &analyzers,
+                                const std::function<bool(int)> &progress)
+{
+    bool decodeVideo = false;
+    bool decodeAudio = false;
+    for (auto *analyzer : analyzers) {
+        decodeVideo |= analyzer->wantsVideo();
+        decodeAudio |= analyzer->wantsAudio();
+        analyzer->begin(info);
+    }
+    decodeVideo = decodeVideo && info.width > 0;
+    decodeAudio = decodeAudio && info.channels > 0;
+    QStringList keys;
+    for (int i = 0; i < info.channels; i++) {
+        keys << "meta.media.audio_level." + QString::number(i);
+    }
+    for (int z = 0; z < info.length; ++z) {
+        if (!progress(int(100.0 * z / info.length))) {
+            return false;
+        }
+        QScopedPointer<Mlt::Frame> frame(producer.get_frame());
+        bool valid = frame != nullptr && frame->is_valid();
+        bool frameNeeded = false;
+        if (decodeVideo && valid) {
+            for (auto *analyzer : analyzers) {
+                if (analyzer->wantsVideoFrame(z)) {
+                    frameNeeded = true;
+                    break;
+                }
+            }
+        }
+        if (frameNeeded) {
+#if LIBMLT_VERSION_INT < QT_VERSION_CHECK(7, 5, 0)
+            frame->set("deinterlace_method", "onefield");
+            frame->set("top_field_first", -1);
+            frame->set("rescale.interp", "nearest");
+#else
+            frame->set("consumer.deinterlacer", "onefield");
+            frame->set("consumer.top_field_first", -1);
+            frame->set("consumer.rescale", "nearest");
+#endif
+            mlt_image_format format = mlt_image_rgba;
+            int width = info.width;
+            int height = info.height;
+            const uchar *image = frame->get_image(format, width, height);
+            if (image) {
+                for (auto *analyzer : analyzers) {
+                    if (analyzer->wantsVideoFrame(z)) {
+                        analyzer->processVideo(z, image, width, height);
+                    }
+                }
+            }
+        }
+        if (decodeAudio) {
+            IngestAudioFrame audio;
+            audio.position = z;
+            audio.samples = nullptr;
+            audio.channels = info.channels;
+            audio.frequency = info.frequency;
+            audio.sampleCount = mlt_audio_calculate_frame_samples(float(info.fps), info.frequency, z);
+            // Audio analyzers still get invalid frames, so that their data stays aligned with the frame positions
+            if (valid && frame->get_int("test_audio") == 0) {
+                mlt_audio_format audioFormat = mlt_audio_s16;
+                audio.samples = static_cast<const int16_t *>(frame->get_audio(audioFormat, audio.frequency, audio.channels, audio.sampleCount));
+                audio.levels.reserve(info.channels);
+                for (const QString &key : qAsConst(keys)) {
+                    audio.levels << frame->get_double(key.toUtf8().constData());
+                }
+            }
+            for (auto *analyzer : analyzers) {
+                if (analyzer->wantsAudio()) {
+                    analyzer->processAudio(audio);
+                }
+            }
+        }
+    }
+    return true;
+}
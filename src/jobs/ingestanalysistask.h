@@ -0,0 +1,49 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include "abstracttask.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+class IngestAnalyzer;
+struct IngestMediaInfo;
+class ProjectClip;
+namespace Mlt {
+class Producer;
+}
+
+/** @class IngestAnalysisTask
+    @brief Decodes a newly imported clip once and feeds the frames to several analyzers (hover thumbnails, audio peaks,
+    scene change score, loudness), instead of running one job with its own decoding pass for each of them.
+    Results are stored in the clip's analysis cache, see cachePrefix().
+ */
+class IngestAnalysisTask : public AbstractTask
+{
+public:
+    IngestAnalysisTask(const ObjectId &owner, QObject* object);
+    static void start(const ObjectId &owner, QObject* object, bool force = false);
+    /** @brief The prefix of the analysis cache files of a clip, empty if the cache folder is not available */
+    static QString cachePrefix(const std::shared_ptr<ProjectClip> &binClip);
+    /** @brief Open a copy of @param source at the thumbnail profile size for analysis, with the given streams (-1 to disable)
+        @returns nullptr if the file cannot be opened
+     */
+    static std::unique_ptr<Mlt::Producer> openProducer(const std::shared_ptr<Mlt::Producer> &source, int videoIndex, int audioIndex);
+    /** @brief The information passed to the analyzers for a producer created by openProducer() */
+    static IngestMediaInfo mediaInfo(Mlt::Producer &producer, int length, bool video, int channels, int frequency);
+    /** @brief Decode @param info.length frames of @param producer and pass them to the analyzers
+        @param progress receives the progress percentage, and returns false to abort
+        @returns false if the decoding was aborted
+     */
+    static bool decode(Mlt::Producer &producer, const IngestMediaInfo &info, const std::vector<IngestAnalyzer *> &analyzers,
+                       const std::function<bool(int)> &progress);
+
+protected:
+    void run() override;
+};
@@ -0,0 +1,367 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "ingestanalyzers.h"
+#include "audiolevelstask.h"
+#include "kdenlive_debug.h"
+#include "utils/colorconversion.h"
+#include "utils/thumbnailcache.hpp"
+
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <QtMath>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+
+// Cache files start with a magic number and a version so that a format change simply invalidates old files
+static const quint32 analysisMagic = 0x4b444941; // KDIA
+static const quint32 analysisVersion = 1;
+
+static bool writeAnalysis(const QString &path, const std::function<void(QDataStream &)> &writer)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(KDENLIVE_LOG) << "Cannot write analysis data" << path;
+        return false;
+    }
+    QDataStream stream(&file);
+    stream << analysisMagic << analysisVersion;
+    writer(stream);
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+QString IngestAnalyzer::cacheFile(const QString &cachePrefix, const QString &name)
+{
+    return cachePrefix + name + QStringLiteral(".dat");
+}
+
+ThumbnailSampler::ThumbnailSampler(const QString &binId, std::set<int> positions)
+    : m_binId(binId)
+    , m_positions(std::move(positions))
+    , m_fullWidth(0)
+    , m_stored(0)
+{
+}
+
+std::set<int> ThumbnailSampler::cachePositions(int duration, int thumbsCount, double fps)
+{
+    // Same distribution as CacheTask, so that hover previews find their thumbnails
+    std::set<int> frames;
+    int steps = qCeil(qMax(fps, double(duration) / thumbsCount));
+    int pos = 0;
+    for (int i = 1; i <= thumbsCount && pos <= duration; ++i) {
+        frames.insert(pos);
+        pos = steps * i;
+    }
+    return frames;
+}
+
+void ThumbnailSampler::begin(const IngestMediaInfo &info)
+{
+    m_fullWidth = info.fullWidth;
+    // Skip the thumbnails that are already cached
+    for (auto it = m_positions.begin(); it != m_positions.end();) {
+        if (ThumbnailCache::get()->hasThumbnail(m_binId, *it)) {
+            it = m_positions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ThumbnailSampler::processVideo(int position, const uchar *rgba, int width, int height)
+{
+    if (m_positions.count(position) == 0) {
+        return;
+    }
+    QImage image = ColorConversion::fromRgba(rgba, width, height);
+    if (m_fullWidth > 0 && m_fullWidth != width) {
+        image = image.scaled(m_fullWidth, height);
+    }
+    ThumbnailCache::get()->storeThumbnail(m_binId, position, image, true);
+    m_stored++;
+}
+
+bool ThumbnailSampler::finish(const QString &cachePrefix)
+{
+    // Thumbnails go to the ThumbnailCache, which handles its own persistence
+    Q_UNUSED(cachePrefix)
+    return m_stored > 0;
+}
+
+AudioPeakPyramid::AudioPeakPyramid(QString thumbPath)
+    : m_thumbPath(std::move(thumbPath))
+    , m_channels(0)
+{
+}
+
+void AudioPeakPyramid::begin(const IngestMediaInfo &info)
+{
+    m_channels = info.channels;
+    m_levels.clear();
+    m_levels.reserve(info.length * m_channels);
+}
+
+void AudioPeakPyramid::processAudio(const IngestAudioFrame &frame)
+{
+    if (frame.levels.size() < m_channels) {
+        // Invalid frame, repeat the previous values like AudioLevelsTask
+        if (!m_levels.isEmpty()) {
+            for (int channel = 0; channel < m_channels; channel++) {
+                m_levels << m_levels.last();
+            }
+        }
+        return;
+    }
+    for (int channel = 0; channel < m_channels; ++channel) {
+        m_levels << uint8_t(256 * qMin(frame.levels.at(channel) * 0.9, 1.0));
+    }
+}
+
+bool AudioPeakPyramid::finish(const QString &cachePrefix)
+{
+    if (m_levels.isEmpty() || m_channels == 0) {
+        return false;
+    }
+    bool saved = m_thumbPath.isEmpty() || AudioLevelsTask::saveLevels(m_levels, m_channels, m_thumbPath);
+    // Each level halves the resolution of the previous one, keeping the highest peak
+    QVector<QVector<uint8_t>> pyramid;
+    QVector<uint8_t> current = m_levels;
+    while (current.size() > 2 * m_channels) {
+        int frames = current.size() / m_channels;
+        QVector<uint8_t> next;
+        next.reserve(((frames + 1) / 2) * m_channels);
+        for (int i = 0; i < frames; i += 2) {
+            for (int channel = 0; channel < m_channels; ++channel) {
+                uint8_t value = current.at(i * m_channels + channel);
+                if (i + 1 < frames) {
+                    value = qMax(value, current.at((i + 1) * m_channels + channel));
+                }
+                next << value;
+            }
+        }
+        pyramid << next;
+        current = next;
+    }
+    return writeAnalysis(cacheFile(cachePrefix, name()),
+                         [this, &pyramid](QDataStream &stream) {
+                             stream << qint32(m_channels) << m_levels << pyramid;
+                         }) &&
+           saved;
+}
+
+SceneChangeMetric::SceneChangeMetric()
+    : m_previousMafd(0.)
+    , m_fps(25.)
+{
+}
+
+void SceneChangeMetric::begin(const IngestMediaInfo &info)
+{
+    m_fps = info.fps;
+    m_scores.clear();
+    m_scores.reserve(info.length);
+    m_previous.clear();
+    m_current.resize(GridWidth * GridHeight);
+    m_previousMafd = 0.;
+}
+
+void SceneChangeMetric::processVideo(int position, const uchar *rgba, int width, int height)
+{
+    // Average luma of each grid cell, integer BT.601 weights
+    const int cellWidth = qMax(1, width / GridWidth);
+    const int cellHeight = qMax(1, height / GridHeight);
+    for (int gy = 0; gy < GridHeight; ++gy) {
+        const int y0 = qMin(height - 1, gy * height / GridHeight);
+        for (int gx = 0; gx < GridWidth; ++gx) {
+            const int x0 = qMin(width - 1, gx * width / GridWidth);
+            int sum = 0;
+            int count = 0;
+            for (int y = y0; y < qMin(height, y0 + cellHeight); ++y) {
+                const uchar *line = rgba + (y * width + x0) * 4;
+                for (int x = 0; x < qMin(width - x0, cellWidth); ++x) {
+                    const uchar *p = line + x * 4;
+                    sum += (77 * p[0] + 150 * p[1] + 29 * p[2]) >> 8;
+                    count++;
+                }
+            }
+            m_current[gy * GridWidth + gx] = uchar(count > 0 ? sum / count : 0);
+        }
+    }
+    // Positions are decoded in order, fill possible gaps caused by invalid frames
+    while (m_scores.size() < position) {
+        m_scores << 0.f;
+    }
+    float score = 0.f;
+    if (!m_previous.isEmpty()) {
+        // Mean absolute frame difference, and its variation compared to the previous frame pair, like FFmpeg's scene score
+        qint64 sad = 0;
+        for (int i = 0; i < m_current.size(); ++i) {
+            sad += qAbs(int(m_current.at(i)) - int(m_previous.at(i)));
+        }
+        double mafd = double(sad) / m_current.size();
+        double diff = qAbs(mafd - m_previousMafd);
+        score = float(qBound(0., qMin(mafd, diff) / 100., 1.));
+        m_previousMafd = mafd;
+    }
+    m_scores << score;
+    std::swap(m_previous, m_current);
+    if (m_current.isEmpty()) {
+        m_current.resize(GridWidth * GridHeight);
+    }
+}
+
+bool SceneChangeMetric::finish(const QString &cachePrefix)
+{
+    if (m_scores.isEmpty()) {
+        return false;
+    }
+    return writeAnalysis(cacheFile(cachePrefix, name()), [this](QDataStream &stream) { stream << m_fps << m_scores; });
+}
+
+QVector<float> SceneChangeMetric::loadScores(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    QDataStream stream(&file);
+    quint32 magic;
+    quint32 version;
+    double fps;
+    QVector<float> scores;
+    stream >> magic >> version;
+    if (magic != analysisMagic || version != analysisVersion) {
+        return {};
+    }
+    stream >> fps >> scores;
+    if (stream.status() != QDataStream::Ok) {
+        return {};
+    }
+    return scores;
+}
+
+LoudnessMeter::LoudnessMeter()
+    : m_shelf({1., 0., 0., 0., 0.})
+    , m_highPass({1., 0., 0., 0., 0.})
+    , m_channels(0)
+    , m_blockSize(4800)
+    , m_blockFill(0)
+    , m_peak(0.)
+{
+}
+
+void LoudnessMeter::begin(const IngestMediaInfo &info)
+{
+    // K-weighting filter coefficients for the sample rate, as in ITU-R BS.1770 / libebur128
+    const double rate = info.frequency > 0 ? info.frequency : 48000;
+    double f0 = 1681.974450955533;
+    double gain = 3.999843853973347;
+    double q = 0.7071752369554196;
+    double k = std::tan(M_PI * f0 / rate);
+    double vh = std::pow(10.0, gain / 20.0);
+    double vb = std::pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    m_shelf = {(vh + vb * k / q + k * k) / a0, 2.0 * (k * k - vh) / a0, (vh - vb * k / q + k * k) / a0, 2.0 * (k * k - 1.0) / a0,
+               (1.0 - k / q + k * k) / a0};
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = std::tan(M_PI * f0 / rate);
+    a0 = 1.0 + k / q + k * k;
+    m_highPass = {1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0};
+    m_channels = info.channels;
+    m_state.fill(0., m_channels * 8);
+    m_subBlock.fill(0., m_channels);
+    m_subBlocks.clear();
+    m_blockSize = qMax(1, int(rate / 10));
+    m_blockFill = 0;
+    m_peak = 0.;
+}
+
+double LoudnessMeter::filter(const Biquad &bq, double *state, double x) const
+{
+    const double y = bq.b0 * x + bq.b1 * state[0] + bq.b2 * state[1] - bq.a1 * state[2] - bq.a2 * state[3];
+    state[1] = state[0];
+    state[0] = x;
+    state[3] = state[2];
+    state[2] = y;
+    return y;
+}
+
+void LoudnessMeter::processAudio(const IngestAudioFrame &frame)
+{
+    if (frame.samples == nullptr || frame.channels != m_channels) {
+        return;
+    }
+    for (int i = 0; i < frame.sampleCount; ++i) {
+        for (int channel = 0; channel < m_channels; ++channel) {
+            const double x = frame.samples[i * m_channels + channel] / 32768.0;
+            m_peak = qMax(m_peak, qAbs(x));
+            double *state = m_state.data() + channel * 8;
+            const double y = filter(m_highPass, state + 4, filter(m_shelf, state, x));
+            m_subBlock[channel] += y * y;
+        }
+        if (++m_blockFill == m_blockSize) {
+            // Surround channels are weighted by 1.41 and the LFE is ignored for 5.1 layouts
+            double sum = 0.;
+            for (int channel = 0; channel < m_channels; ++channel) {
+                double weight = 1.0;
+                if (m_channels == 6) {
+                    weight = channel == 3 ? 0. : (channel > 3 ? 1.41 : 1.0);
+                }
+                sum += weight * m_subBlock.at(channel) / m_blockSize;
+                m_subBlock[channel] = 0.;
+            }
+            m_subBlocks << sum;
+            m_blockFill = 0;
+        }
+    }
+}
+
+double LoudnessMeter::integratedLoudness() const
+{
+    auto loudness = [](double power) { return power > 0. ? -0.691 + 10. * std::log10(power) : -70.; };
+    // Gating blocks of 400ms overlapping by 75%
+    QVector<double> blocks;
+    for (int i = 0; i + 4 <= m_subBlocks.size(); ++i) {
+        double power = (m_subBlocks.at(i) + m_subBlocks.at(i + 1) + m_subBlocks.at(i + 2) + m_subBlocks.at(i + 3)) / 4.;
+        if (loudness(power) > -70.) {
+            blocks << power;
+        }
+    }
+    if (blocks.isEmpty()) {
+        return -70.;
+    }
+    double total = std::accumulate(blocks.cbegin(), blocks.cend(), 0.);
+    const double relativeGate = loudness(total / blocks.size()) - 10.;
+    total = 0.;
+    int count = 0;
+    for (double power : qAsConst(blocks)) {
+        if (loudness(power) > relativeGate) {
+            total += power;
+            count++;
+        }
+    }
+    return count > 0 ? loudness(total / count) : -70.;
+}
+
+double LoudnessMeter::samplePeak() const
+{
+    return m_peak > 0. ? 20. * std::log10(m_peak) : -std::numeric_limits<double>::infinity();
+}
+
+bool LoudnessMeter::finish(const QString &cachePrefix)
+{
+    if (m_subBlocks.isEmpty()) {
+        return false;
+    }
+    return writeAnalysis(cacheFile(cachePrefix, name()), [this](QDataStream &stream) { stream << integratedLoudness() << samplePeak() << m_subBlocks; });
+}
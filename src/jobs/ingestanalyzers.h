@@ -0,0 +1,188 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QImage>
+#include <QString>
+#include <QVector>
+
+#include <cstdint>
+#include <set>
+
+/** @brief Description of the media passed to the analyzers before decoding starts */
+struct IngestMediaInfo
+{
+    int length = 0;
+    double fps = 25.;
+    /** @brief Size of the decoded (downscaled) video frames, 0 if there is no video */
+    int width = 0;
+    int height = 0;
+    /** @brief Width to which thumbnails are scaled to respect the display aspect ratio, 0 for no scaling */
+    int fullWidth = 0;
+    int frequency = 48000;
+    /** @brief Number of audio channels, 0 if there is no audio */
+    int channels = 0;
+};
+
+/** @brief One decoded audio frame */
+struct IngestAudioFrame
+{
+    int position;
+    /** @brief Interleaved 16 bit samples */
+    const int16_t *samples;
+    int sampleCount;
+    int channels;
+    int frequency;
+    /** @brief Per channel level computed by MLT's audiolevel filter (0-1, IEC scale) */
+    QVector<double> levels;
+};
+
+/** @class IngestAnalyzer
+    @brief Interface of the analyzers fed by IngestAnalysisTask.
+    The task decodes the clip once, in order, and passes each frame to all analyzers. Analyzers are called from the
+    task's thread only. Video frames are RGBA buffers owned by the task, an analyzer must copy what it wants to keep.
+ */
+class IngestAnalyzer
+{
+public:
+    virtual ~IngestAnalyzer() = default;
+    /** @brief Short identifier, also used as the suffix of the cache file */
+    virtual QString name() const = 0;
+    virtual bool wantsVideo() const { return false; }
+    virtual bool wantsAudio() const { return false; }
+    /** @brief Whether the image of the frame at @param position is needed, frames that no analyzer needs are not converted */
+    virtual bool wantsVideoFrame(int position) const
+    {
+        Q_UNUSED(position)
+        return wantsVideo();
+    }
+    /** @brief Called once before the first frame */
+    virtual void begin(const IngestMediaInfo &info) { Q_UNUSED(info) }
+    virtual void processVideo(int position, const uchar *rgba, int width, int height)
+    {
+        Q_UNUSED(position)
+        Q_UNUSED(rgba)
+        Q_UNUSED(width)
+        Q_UNUSED(height)
+    }
+    virtual void processAudio(const IngestAudioFrame &frame) { Q_UNUSED(frame) }
+    /** @brief Called once the whole clip was decoded, store the results in cacheFile(cachePrefix, name())
+        @returns false if nothing could be saved
+     */
+    virtual bool finish(const QString &cachePrefix) = 0;
+
+    /** @brief The cache file of analyzer @param name for a clip */
+    static QString cacheFile(const QString &cachePrefix, const QString &name);
+};
+
+/** @class ThumbnailSampler
+    @brief Extracts thumbnails at fixed positions and stores them in the ThumbnailCache, like CacheTask does.
+ */
+class ThumbnailSampler : public IngestAnalyzer
+{
+public:
+    ThumbnailSampler(const QString &binId, std::set<int> positions);
+    QString name() const override { return QStringLiteral("thumbs"); }
+    bool wantsVideo() const override { return true; }
+    bool wantsVideoFrame(int position) const override { return m_positions.count(position) > 0; }
+    void begin(const IngestMediaInfo &info) override;
+    void processVideo(int position, const uchar *rgba, int width, int height) override;
+    bool finish(const QString &cachePrefix) override;
+    /** @brief The CacheTask positions for a clip of @param duration frames */
+    static std::set<int> cachePositions(int duration, int thumbsCount, double fps);
+
+private:
+    QString m_binId;
+    std::set<int> m_positions;
+    int m_fullWidth;
+    int m_stored;
+};
+
+/** @class AudioPeakPyramid
+    @brief Collects the per frame audio levels and a pyramid of peaks (each level is the max of 2 samples of the previous one).
+    The first level is also saved as the audio thumbnail image of the clip, so that AudioLevelsTask does not decode the stream again.
+ */
+class AudioPeakPyramid : public IngestAnalyzer
+{
+public:
+    explicit AudioPeakPyramid(QString thumbPath);
+    QString name() const override { return QStringLiteral("peaks"); }
+    bool wantsAudio() const override { return true; }
+    void begin(const IngestMediaInfo &info) override;
+    void processAudio(const IngestAudioFrame &frame) override;
+    bool finish(const QString &cachePrefix) override;
+    const QVector<uint8_t> &levels() const { return m_levels; }
+
+private:
+    QString m_thumbPath;
+    int m_channels;
+    QVector<uint8_t> m_levels;
+};
+
+/** @class SceneChangeMetric
+    @brief Computes a per frame scene change score (0-1), similar to FFmpeg's scene detection, on a downscaled luma grid.
+ */
+class SceneChangeMetric : public IngestAnalyzer
+{
+public:
+    SceneChangeMetric();
+    QString name() const override { return QStringLiteral("scenes"); }
+    bool wantsVideo() const override { return true; }
+    void begin(const IngestMediaInfo &info) override;
+    void processVideo(int position, const uchar *rgba, int width, int height) override;
+    bool finish(const QString &cachePrefix) override;
+    const QVector<float> &scores() const { return m_scores; }
+    /** @brief Read a score signal stored by finish(), returns an empty vector on failure */
+    static QVector<float> loadScores(const QString &path);
+    /** @brief Width and height of the luma grid used for comparison */
+    static constexpr int GridWidth = 64;
+    static constexpr int GridHeight = 36;
+
+private:
+    QVector<float> m_scores;
+    QVector<uchar> m_previous;
+    QVector<uchar> m_current;
+    double m_previousMafd;
+    double m_fps;
+};
+
+/** @class LoudnessMeter
+    @brief Measures the integrated loudness (EBU R128, K-weighted and gated) and the sample peak of the audio.
+ */
+class LoudnessMeter : public IngestAnalyzer
+{
+public:
+    LoudnessMeter();
+    QString name() const override { return QStringLiteral("loudness"); }
+    bool wantsAudio() const override { return true; }
+    void begin(const IngestMediaInfo &info) override;
+    void processAudio(const IngestAudioFrame &frame) override;
+    bool finish(const QString &cachePrefix) override;
+    /** @brief Integrated loudness in LUFS, -70 for silence */
+    double integratedLoudness() const;
+    /** @brief Sample peak in dBFS */
+    double samplePeak() const;
+
+private:
+    struct Biquad
+    {
+        double b0, b1, b2, a1, a2;
+    };
+    Biquad m_shelf;
+    Biquad m_highPass;
+    /** @brief Filter state per channel: x1, x2, y1, y2 for both stages */
+    QVector<double> m_state;
+    int m_channels;
+    int m_blockSize;
+    int m_blockFill;
+    /** @brief Sum of squares per channel of the current 100ms sub block */
+    QVector<double> m_subBlock;
+    /** @brief Mean square (summed over channels) of each 100ms sub block */
+    QVector<double> m_subBlocks;
+    double m_peak;
+    double filter(const Biquad &bq, double *state, double x) const;
+};
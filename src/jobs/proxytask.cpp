@@ -15,8 +15,14 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "macros.hpp"
 
 #include <QProcess>
+#include <QTemporaryDir>
 #include <QTemporaryFile>
 #include <QThread>
+#include <QtMath>
+
+#include <memory>
+#include <numeric>
+#include <vector>
 
 #include <klocalizedstring.h>
 
@@ -37,6 +43,12 @@ void ProxyTask::start(const ObjectId &owner, QObject* object, bool force)
         task = nullptr;
     }
     if (task) {
+        auto binClip = pCore->projectItemModel()->getClipByBinID(QString::number(owner.second));
+        int segmentLength = KdenliveSettings::proxysegmentlength();
+        if (binClip && segmentLength > 0 && binClip->duration().seconds() > 2 * segmentLength) {
+            // Long inputs are split in segments using the idle encoders, let the short clips start first
+            task->m_priority--;
+        }
         // Otherwise, start a new proxy generation thread.
         task->m_isForce = force;
         pCore->taskManager.startTask(owner.second, task);
@@ -45,6 +57,7 @@ void ProxyTask::start(const ObjectId &owner, QObject* object, bool force)
 
 void ProxyTask::run()
 {
+    beginRun();
     if (m_isCanceled) {
         pCore->taskManager.taskDone(m_owner.second, this);
         return;
@@ -181,9 +194,12 @@ void ProxyTask::run()
         qDebug()<<" :: STARTING PLAYLIST PROXY: "<<mltParameters;
         QObject::connect(this, &ProxyTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
         QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &ProxyTask::processLogInfo);
-        m_jobProcess->start(KdenliveSettings::rendererpath(), mltParameters);
-        m_jobProcess->waitForFinished(-1);
-        result = m_jobProcess->exitStatus() == QProcess::NormalExit;
+        if (pCore->taskManager.acquireEncoderSlot(m_isCanceled)) {
+            m_jobProcess->start(KdenliveSettings::rendererpath(), mltParameters);
+            m_jobProcess->waitForFinished(-1);
+            pCore->taskManager.releaseEncoderSlot();
+            result = m_jobProcess->exitStatus() == QProcess::NormalExit;
+        }
         delete playlist;
     } else if (type == ClipType::Image) {
         m_isFfmpegJob = false;
@@ -337,15 +353,27 @@ void ProxyTask::run()
 
         // Make sure we keep the stream order
         parameters << QStringLiteral("-sn") << QStringLiteral("-dn") << QStringLiteral("-map") << QStringLiteral("0");
-        parameters << dest;
-        qDebug()<<"/// FULL PROXY PARAMS:\n"<<parameters<<"\n------";
-        m_jobProcess.reset(new QProcess);
-        // m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
-        QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &ProxyTask::processLogInfo);
-        QObject::connect(this, &ProxyTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
-        m_jobProcess->start(KdenliveSettings::ffmpegpath(), parameters, QIODevice::ReadOnly);
-        m_jobProcess->waitForFinished(-1);
-        result = m_jobProcess->exitStatus() == QProcess::NormalExit;
+        int segmentLength = KdenliveSettings::proxysegmentlength();
+        if (segmentLength > 0 && m_jobDuration > 2 * segmentLength && parameters.count(QStringLiteral("-i")) == 1) {
+            bool withAudio = binClip->hasAudio() && !parameters.contains(QStringLiteral("-an"));
+            result = encodeSegments(parameters, dest, segmentLength, withAudio);
+        } else {
+            parameters << dest;
+            qDebug()<<"/// FULL PROXY PARAMS:\n"<<parameters<<"\n------";
+            m_jobProcess.reset(new QProcess);
+            // m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
+            QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &ProxyTask::processLogInfo);
+            QObject::connect(this, &ProxyTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
+            if (pCore->taskManager.acquireEncoderSlot(m_isCanceled)) {
+                m_jobProcess->start(KdenliveSettings::ffmpegpath(), parameters, QIODevice::ReadOnly);
+                m_jobProcess->waitForFinished(-1);
+                pCore->taskManager.releaseEncoderSlot();
+                result = m_jobProcess->exitStatus() == QProcess::NormalExit;
+            }
+        }
+    }
+    if (result && !m_isCanceled) {
+        addSourceBytes(QFileInfo(source).size());
     }
     // remove temporary playlist if it exists
     m_progress = 100;
@@ -376,6 +404,36 @@ void ProxyTask::run()
     return;
 }
 
+int ProxyTask::parseFfmpegTime(const QString &buffer)
+{
+    if (!buffer.contains(QLatin1String("time="))) {
+        return -1;
+    }
+    QString time = buffer.section(QStringLiteral("time="), 1, 1).simplified().section(QLatin1Char(' '), 0, 0);
+    if (time.isEmpty()) {
+        return -1;
+    }
+    QStringList numbers = time.split(QLatin1Char(':'));
+    if (numbers.size() < 3) {
+        return time.toInt();
+    }
+    return numbers.at(0).toInt() * 3600 + numbers.at(1).toInt() * 60 + qRound(numbers.at(2).toDouble());
+}
+
+QVector<QPair<int, int>> ProxyTask::planSegments(int duration, int segmentLength)
+{
+    QVector<QPair<int, int>> segments;
+    if (segmentLength <= 0) {
+        return segments;
+    }
+    const int count = qMax(1, qCeil(double(duration) / segmentLength));
+    for (int i = 0; i < count; ++i) {
+        // The duration is rounded, the last segment goes to the end of the input
+        segments.append({i * segmentLength, i < count - 1 ? segmentLength : -1});
+    }
+    return segments;
+}
+
 void ProxyTask::processLogInfo()
 {
     const QString buffer = QString::fromUtf8(m_jobProcess->readAllStandardError());
@@ -394,18 +452,9 @@ void ProxyTask::processLogInfo()
                 }
             }
         } else if (buffer.contains(QLatin1String("time="))) {
-            int progress = 0;
-            QString time = buffer.section(QStringLiteral("time="), 1, 1).simplified().section(QLatin1Char(' '), 0, 0);
-            if (!time.isEmpty()) {
-                QStringList numbers = time.split(QLatin1Char(':'));
-                if (numbers.size() < 3) {
-                    progress = time.toInt();
-                    if (progress == 0) {
-                        return;
-                    }
-                } else {
-                    progress = numbers.at(0).toInt() * 3600 + numbers.at(1).toInt() * 60 + qRound(numbers.at(2).toDouble());
-                }
+            int progress = qMax(0, parseFfmpegTime(buffer));
+            if (progress == 0) {
+                return;
             }
             m_progress = 100 * progress / m_jobDuration;
             QMetaObject::invokeMethod(m_object, "updateJobProgress");
@@ -420,3 +469,145 @@ void ProxyTask::processLogInfo()
         }
     }
 }
+
+bool ProxyTask::encodeSegments(const QStringList &parameters, const QString &dest, int segmentLength, bool withAudio)
+{
+    QFileInfo destInfo(dest);
+    QTemporaryDir segmentDir(destInfo.absoluteDir().absoluteFilePath(QStringLiteral("segments-XXXXXX")));
+    if (!segmentDir.isValid()) {
+        m_logDetails.append(i18n("Cannot create folder %1", segmentDir.path()));
+        return false;
+    }
+    // Video segments start with a keyframe once encoded, so they can be joined without re-encoding.
+    // Seeking before the input is frame accurate for FFmpeg, it only decodes from the previous source keyframe.
+    // Audio is encoded in a single pass: joined audio segments would each add their encoder priming and drift from the video.
+    const QVector<QPair<int, int>> segments = planSegments(m_jobDuration, segmentLength);
+    const int count = segments.size();
+    const int inputIndex = parameters.indexOf(QStringLiteral("-i"));
+    QStringList segmentFiles;
+    for (int i = 0; i < count; ++i) {
+        segmentFiles << segmentDir.filePath(QStringLiteral("%1.%2").arg(i, 4, 10, QLatin1Char('0')).arg(destInfo.suffix()));
+    }
+    const QString audioFile = segmentDir.filePath(QStringLiteral("audio.%1").arg(destInfo.suffix()));
+    // The audio pass is the last job
+    const int jobs = withAudio ? count + 1 : count;
+    QVector<int> encoded(count, 0);
+    std::vector<std::pair<int, std::unique_ptr<QProcess>>> running;
+    auto startJob = [&](int ix) {
+        QStringList args = parameters;
+        if (ix < count) {
+            QStringList range = {QStringLiteral("-ss"), QString::number(segments.at(ix).first)};
+            if (segments.at(ix).second > 0) {
+                range << QStringLiteral("-t") << QString::number(segments.at(ix).second);
+            }
+            for (int i = range.size() - 1; i >= 0; --i) {
+                args.insert(inputIndex, range.at(i));
+            }
+            args << QStringLiteral("-an") << segmentFiles.at(ix);
+        } else {
+            args << QStringLiteral("-vn") << audioFile;
+        }
+        std::unique_ptr<QProcess> process(new QProcess);
+        QProcess *p = process.get();
+        QObject::connect(p, &QProcess::readyReadStandardError, p, [this, p, ix, count, &encoded]() {
+            const QString buffer = QString::fromUtf8(p->readAllStandardError());
+            int time = parseFfmpegTime(buffer);
+            if (time < 0) {
+                m_logDetails.append(buffer);
+            } else if (ix < count) {
+                encoded[ix] = time;
+            }
+        });
+        QObject::connect(this, &ProxyTask::jobCanceled, p, &QProcess::kill, Qt::DirectConnection);
+        p->start(KdenliveSettings::ffmpegpath(), args, QIODevice::ReadOnly);
+        running.emplace_back(ix, std::move(process));
+    };
+    // One encoder is always ours, the other jobs run when encoders are idle, leaving them to waiting jobs first
+    if (!pCore->taskManager.acquireEncoderSlot(m_isCanceled)) {
+        return false;
+    }
+    int held = 1;
+    int next = 0;
+    bool failed = false;
+    while ((next < jobs || !running.empty()) && !failed && !m_isCanceled) {
+        while (next < jobs) {
+            if (int(running.size()) >= held) {
+                if (!pCore->taskManager.acquireEncoderSlot(m_isCanceled, false)) {
+                    break;
+                }
+                held++;
+            }
+            startJob(next++);
+        }
+        for (auto it = running.begin(); it != running.end();) {
+            QProcess *p = it->second.get();
+            if (!p->waitForFinished(100) && p->state() != QProcess::NotRunning) {
+                ++it;
+                continue;
+            }
+            if (p->exitStatus() != QProcess::NormalExit || p->exitCode() != 0) {
+                failed = true;
+            } else if (it->first < count) {
+                const QPair<int, int> &segment = segments.at(it->first);
+                encoded[it->first] = segment.second > 0 ? segment.second : m_jobDuration - segment.first;
+            }
+            it = running.erase(it);
+            if (held > 1) {
+                pCore->taskManager.releaseEncoderSlot();
+                held--;
+            }
+        }
+        int progress = 95 * std::accumulate(encoded.cbegin(), encoded.cend(), 0) / qMax(1, m_jobDuration);
+        if (progress != m_progress) {
+            m_progress = qMin(progress, 95);
+            QMetaObject::invokeMethod(m_object, "updateJobProgress");
+        }
+    }
+    for (auto &job : running) {
+        job.second->kill();
+        job.second->waitForFinished(-1);
+    }
+    running.clear();
+    if (failed || m_isCanceled) {
+        for (int i = 0; i < held; ++i) {
+            pCore->taskManager.releaseEncoderSlot();
+        }
+        return false;
+    }
+    // Join the video segments and mux the audio, keeping one encoder slot for the disk intensive copy
+    QFile list(segmentDir.filePath(QStringLiteral("segments.txt")));
+    if (!list.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        for (int i = 0; i < held; ++i) {
+            pCore->taskManager.releaseEncoderSlot();
+        }
+        return false;
+    }
+    QTextStream out(&list);
+    for (const QString &file : qAsConst(segmentFiles)) {
+        QString escaped = file;
+        escaped.replace(QLatin1Char('\''), QLatin1String("'\\''"));
+        out << QStringLiteral("file '%1'\n").arg(escaped);
+    }
+    list.close();
+    QStringList concatParams = {QStringLiteral("-hide_banner"), QStringLiteral("-y"),     QStringLiteral("-v"),    QStringLiteral("error"),
+                                QStringLiteral("-f"),           QStringLiteral("concat"), QStringLiteral("-safe"), QStringLiteral("0"),
+                                QStringLiteral("-i"),           list.fileName()};
+    if (withAudio) {
+        concatParams << QStringLiteral("-i") << audioFile;
+    }
+    concatParams << QStringLiteral("-map") << QStringLiteral("0");
+    if (withAudio) {
+        concatParams << QStringLiteral("-map") << QStringLiteral("1");
+    }
+    concatParams << QStringLiteral("-c") << QStringLiteral("copy") << dest;
+    QProcess concat;
+    QObject::connect(this, &ProxyTask::jobCanceled, &concat, &QProcess::kill, Qt::DirectConnection);
+    concat.start(KdenliveSettings::ffmpegpath(), concatParams, QIODevice::ReadOnly);
+    concat.waitForFinished(-1);
+    m_logDetails.append(QString::fromUtf8(concat.readAllStandardError()));
+    for (int i = 0; i < held; ++i) {
+        pCore->taskManager.releaseEncoderSlot();
+    }
+    qCDebug(KDENLIVE_LOG) << "Proxy for" << dest << "encoded in" << count << "segments";
+    return concat.exitStatus() == QProcess::NormalExit && concat.exitCode() == 0;
+}
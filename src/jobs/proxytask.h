@@ -8,6 +8,9 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "abstracttask.h"
 
+#include <QPair>
+#include <QVector>
+
 class QProcess;
 
 class ProxyTask : public AbstractTask
@@ -15,6 +18,12 @@ class ProxyTask : public AbstractTask
 public:
     ProxyTask(const ObjectId &owner, QObject* object);
     static void start(const ObjectId &owner, QObject* object, bool force = false);
+    /** @brief Returns the encoding position in seconds from FFmpeg's -stats output, or -1 */
+    static int parseFfmpegTime(const QString &buffer);
+    /** @brief The start and length in seconds of the segments of a @param duration seconds input encoded by encodeSegments().
+     *  The length of the last segment is -1, it goes to the end of the input.
+     */
+    static QVector<QPair<int, int>> planSegments(int duration, int segmentLength);
 
 protected:
     void run() override;
@@ -22,6 +31,13 @@ protected:
 private slots:
     void processLogInfo();
 
+private:
+    /** @brief Encode the video of a long input as several time ranges in parallel (using the free encoders) and join them without re-encoding.
+     *  The audio is encoded in one pass alongside the segments and muxed with the joined video.
+     *  @param parameters the FFmpeg arguments, without the output file
+     */
+    bool encodeSegments(const QStringList &parameters, const QString &dest, int segmentLength, bool withAudio);
+
 private:
     int m_jobDuration;
     bool m_isFfmpegJob;
@@ -14,26 +14,28 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "bin/projectitemmodel.h"
 #include "core.h"
 #include "doc/kdenlivedoc.h"
+#include "ingestanalysistask.h"
+#include "ingestanalyzers.h"
 #include "kdenlive_debug.h"
 #include "kdenlivesettings.h"
 #include "macros.hpp"
 #include "mainwindow.h"
 #include "ui_scenecutdialog_ui.h"
 
-#include <QProcess>
-#include <QTemporaryFile>
-#include <QThread>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 
 #include <klocalizedstring.h>
+#include <mlt++/MltProducer.h>
 #include <project/projectmanager.h>
 
 SceneSplitTask::SceneSplitTask(const ObjectId &owner, double threshold, int markersCategory, bool addSubclips, int minDuration, QObject* object)
     : AbstractTask(owner, AbstractTask::ANALYSECLIPJOB, object)
-    , m_jobDuration(0)
     , m_markersType(markersCategory)
     , m_subClips(addSubclips)
     , m_minInterval(minDuration)
-    , m_jobProcess(nullptr)
+    , m_threshold(threshold)
 {
 }
 
@@ -71,6 +73,7 @@ void SceneSplitTask::start(QObject* object, bool force)
     for (auto & id : binIds) {
         SceneSplitTask* task = nullptr;
         ObjectId owner;
+        QString clipId = id;
         if (id.contains(QLatin1Char('/'))) {
             QStringList binData = id.split(QLatin1Char('/'));
             if (binData.size() < 3) {
@@ -78,201 +81,171 @@ void SceneSplitTask::start(QObject* object, bool force)
                 qDebug()<<"=== INVALID SUBCLIP DATA: "<<id;
                 continue;
             }
-            owner = ObjectId(ObjectType::BinClip, binData.first().toInt());
-            auto binClip = pCore->projectItemModel()->getClipByBinID(binData.first());
-            task = new SceneSplitTask(owner, threshold / 100., markersCategory, addSubclips, minDuration, binClip.get());
-
-        } else {
-            owner = ObjectId(ObjectType::BinClip, id.toInt());
-            auto binClip = pCore->projectItemModel()->getClipByBinID(id);
-            task = new SceneSplitTask(owner, threshold / 100., markersCategory, addSubclips, minDuration, binClip.get());
+            clipId = binData.first();
+        }
+        owner = ObjectId(ObjectType::BinClip, clipId.toInt());
+        auto binClip = pCore->projectItemModel()->getClipByBinID(clipId);
+        if (!binClip) {
+            continue;
         }
+        if (!force) {
+            // If the scene score of this clip was already computed, applying other settings is instant
+            const QString prefix = IngestAnalysisTask::cachePrefix(binClip);
+            QVector<float> scores = prefix.isEmpty() ? QVector<float>() : SceneChangeMetric::loadScores(IngestAnalyzer::cacheFile(prefix, QStringLiteral("scenes")));
+            if (!scores.isEmpty()) {
+                applyCuts(binClip, sceneCuts(scores, threshold / 100., minDuration), markersCategory, addSubclips);
+                continue;
+            }
+        }
+        task = new SceneSplitTask(owner, threshold / 100., markersCategory, addSubclips, minDuration, binClip.get());
         // See if there is already a task for this MLT service and resource.
         if (task && pCore->taskManager.hasPendingJob(owner, AbstractTask::ANALYSECLIPJOB)) {
             delete task;
             task = nullptr;
         }
         if (task) {
-            // Otherwise, start a new audio levels generation thread.
+            // Otherwise, start a new scene detection thread.
             task->m_isForce = force;
             pCore->taskManager.startTask(owner.second, task);
         }
     }
 }
 
+QVector<int> SceneSplitTask::sceneCuts(const QVector<float> &scores, double threshold, int minDuration)
+{
+    QVector<int> cuts;
+    int lastCut = 0;
+    for (int pos = 1; pos < scores.size(); ++pos) {
+        // Like the markers of the former detection, the first cut is kept whatever its distance to the clip start
+        if (scores.at(pos) <= threshold || (!cuts.isEmpty() && pos - lastCut < minDuration)) {
+            continue;
+        }
+        cuts << pos;
+        lastCut = pos;
+    }
+    return cuts;
+}
+
+void SceneSplitTask::applyCuts(const std::shared_ptr<ProjectClip> &binClip, const QVector<int> &cuts, int markersType, bool subClips)
+{
+    if (cuts.isEmpty() || (markersType < 0 && !subClips)) {
+        return;
+    }
+    Fun undo = []() { return true; };
+    Fun redo = []() { return true; };
+    if (markersType >= 0) {
+        // Build json data for markers
+        QJsonArray list;
+        int ix = 1;
+        for (int pos : cuts) {
+            QJsonObject currentMarker;
+            currentMarker.insert(QLatin1String("pos"), QJsonValue(pos));
+            currentMarker.insert(QLatin1String("comment"), QJsonValue(i18n("Scene %1", ix)));
+            currentMarker.insert(QLatin1String("type"), QJsonValue(markersType));
+            list.push_back(currentMarker);
+            ix++;
+        }
+        QJsonDocument json(list);
+        binClip->getMarkerModel()->importFromJson(QString(json.toJson()), true, undo, redo);
+    }
+    if (subClips) {
+        // Create zones
+        int producerDuration = int(binClip->frameDuration());
+        int ix = 1;
+        int lastCut = 0;
+        QJsonArray list;
+        for (int pos : cuts) {
+            if (pos <= lastCut + 1) {
+                continue;
+            }
+            QJsonObject currentZone;
+            currentZone.insert(QLatin1String("name"), QJsonValue(i18n("Scene %1", ix)));
+            currentZone.insert(QLatin1String("in"), QJsonValue(lastCut));
+            currentZone.insert(QLatin1String("out"), QJsonValue(pos - 1));
+            list.push_back(currentZone);
+            lastCut = pos;
+            ix++;
+        }
+        if (lastCut < producerDuration) {
+            QJsonObject currentZone;
+            currentZone.insert(QLatin1String("name"), QJsonValue(i18n("Scene %1", ix)));
+            currentZone.insert(QLatin1String("in"), QJsonValue(lastCut));
+            currentZone.insert(QLatin1String("out"), QJsonValue(producerDuration));
+            list.push_back(currentZone);
+        }
+        QJsonDocument json(list);
+        pCore->projectItemModel()->loadSubClips(binClip->clipId(), QString(json.toJson()), undo, redo);
+    }
+    pCore->pushUndo(undo, redo, i18n("Scene detection"));
+}
+
 void SceneSplitTask::run()
 {
+    beginRun();
     if (m_isCanceled) {
         pCore->taskManager.taskDone(m_owner.second, this);
         return;
     }
     m_running = true;
     auto binClip = pCore->projectItemModel()->getClipByBinID(QString::number(m_owner.second));
-    const QString source = binClip->url();
+    if (binClip == nullptr) {
+        pCore->taskManager.taskDone(m_owner.second, this);
+        return;
+    }
     ClipType::ProducerType type = binClip->clipType();
-    bool result;
     if (type != ClipType::AV && type != ClipType::Video) {
         // This job can only process video files
         QMetaObject::invokeMethod(pCore.get(), "displayBinMessage", Qt::QueuedConnection, Q_ARG(QString, i18n("Cannot analyse this clip type.")),
                                   Q_ARG(int, int(KMessageWidget::Warning)));
         pCore->taskManager.taskDone(m_owner.second, this);
-        qDebug()<<"=== ABORT 1";
         return;
     }
-    if (KdenliveSettings::ffmpegpath().isEmpty()) {
-        // FFmpeg not detected, cannot process the Job
-        QMetaObject::invokeMethod(pCore.get(), "displayBinMessage", Qt::QueuedConnection, Q_ARG(QString, i18n("FFmpeg not found, please set path in Kdenlive's settings Environment.")),
-                                  Q_ARG(int, int(KMessageWidget::Warning)));
-        pCore->taskManager.taskDone(m_owner.second, this);
-        qDebug()<<"=== ABORT 2";
-        return;
+    const QString prefix = IngestAnalysisTask::cachePrefix(binClip);
+    QVector<float> scores;
+    if (!m_isForce && !prefix.isEmpty()) {
+        scores = SceneChangeMetric::loadScores(IngestAnalyzer::cacheFile(prefix, QStringLiteral("scenes")));
     }
-    m_jobDuration = int(binClip->duration().seconds());
-    int producerDuration = binClip->frameDuration();
-    //QStringList parameters = {QStringLiteral("-loglevel"),QStringLiteral("info"),QStringLiteral("-i"),source,QStringLiteral("-filter:v"),QString("scdet"),QStringLiteral("-f"),QStringLiteral("null"),QStringLiteral("-")};
-    QStringList parameters = {QStringLiteral("-y"),QStringLiteral("-loglevel"),QStringLiteral("info"),QStringLiteral("-i"),source,QStringLiteral("-filter:v"),QString("select='gt(scene,0.1)',showinfo"),QStringLiteral("-vsync"),QStringLiteral("vfr"),QStringLiteral("-f"),QStringLiteral("null"),QStringLiteral("-")};
-
-    m_jobProcess.reset(new QProcess);
-    //m_jobProcess->setStandardErrorFile("/tmp/test_settings.txt");
-    m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
-    qDebug()<<"=== READY TO START JOB:"<<parameters;
-    QObject::connect(this, &SceneSplitTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
-    QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardOutput, this, &SceneSplitTask::processLogInfo);
-    QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &SceneSplitTask::processLogErr);
-    m_jobProcess->start(KdenliveSettings::ffmpegpath(), parameters);
-    //m_jobProcess->closeReadChannel(QProcess::StandardError);
-    m_jobProcess->waitForStarted();
-    //QString data;
-    /*while(m_jobProcess->waitForReadyRead()) {
-        //data.append(m_jobProcess->readAll());
-        qDebug()<<"???? READ: \n"<<m_jobProcess->readAll();
-    }*/
-    m_jobProcess->waitForFinished(-1);
-    result = m_jobProcess->exitStatus() == QProcess::NormalExit;
-
-    // remove temporary playlist if it exists
-    m_progress = 100;
-    pCore->taskManager.taskDone(m_owner.second, this);
-    QMetaObject::invokeMethod(m_object, "updateJobProgress");
-    if (result && !m_isCanceled) {
-        qDebug()<<"========================\n\nGOR RESULTS: "<<m_results<<"\n\n=========";
-        auto binClip = pCore->projectItemModel()->getClipByBinID(QString::number(m_owner.second));
-        if (m_markersType >= 0) {
-            // Build json data for markers
-            QJsonArray list;
-            int ix = 1;
-            int lastCut = 0;
-            for (auto &marker : m_results) {
-                int pos = GenTime(marker).frames(pCore->getCurrentFps());
-                if (m_minInterval > 0 && ix > 1 && pos - lastCut < m_minInterval) {
-                    continue;
-                }
-                lastCut = pos;
-                QJsonObject currentMarker;
-                currentMarker.insert(QLatin1String("pos"), QJsonValue(pos));
-                currentMarker.insert(QLatin1String("comment"), QJsonValue(i18n("Scene %1", ix)));
-                currentMarker.insert(QLatin1String("type"), QJsonValue(m_markersType));
-                list.push_back(currentMarker);
-                ix++;
-            }
-            QJsonDocument json(list);
-            QMetaObject::invokeMethod(m_object, "importJsonMarkers", Q_ARG(QString,QString(json.toJson())));
+    if (scores.isEmpty()) {
+        std::shared_ptr<Mlt::Producer> producer = binClip->originalProducer();
+        int length = producer ? producer->get_length() : 0;
+        std::unique_ptr<Mlt::Producer> analysisProducer;
+        if (producer && producer->is_valid() && length > 0 && length < INT_MAX) {
+            analysisProducer = IngestAnalysisTask::openProducer(producer, producer->get_int("video_index"), -1);
         }
-        if (m_subClips) {
-            // Create zones
-            int ix = 1;
-            int lastCut = 0;
-            QJsonArray list;
-            QJsonDocument json;
-            for (double &marker : m_results) {
-                int pos = GenTime(marker).frames(pCore->getCurrentFps());
-                if (pos <= lastCut + 1 || pos - lastCut < m_minInterval) {
-                    continue;
-                }
-                QJsonObject currentZone;
-                currentZone.insert(QLatin1String("name"), QJsonValue(i18n("Scene %1", ix)));
-                currentZone.insert(QLatin1String("in"), QJsonValue(lastCut));
-                currentZone.insert(QLatin1String("out"), QJsonValue(pos - 1));
-                list.push_back(currentZone);
-                lastCut = pos;
-                ix++;
-            }
-            if (lastCut < producerDuration) {
-                QJsonObject currentZone;
-                currentZone.insert(QLatin1String("name"), QJsonValue(i18n("Scene %1", ix)));
-                currentZone.insert(QLatin1String("in"), QJsonValue(lastCut));
-                currentZone.insert(QLatin1String("out"), QJsonValue(producerDuration));
-                list.push_back(currentZone);
-            }
-            json.setArray(list);
-            if (!json.isEmpty()) {
-                QString dataMap(json.toJson());
-                QMetaObject::invokeMethod(pCore->projectItemModel().get(), "loadSubClips", Q_ARG(QString,QString::number(m_owner.second)), Q_ARG(QString,dataMap));
-            }
+        if (analysisProducer == nullptr) {
+            QMetaObject::invokeMethod(pCore.get(), "displayBinMessage", Qt::QueuedConnection, Q_ARG(QString, i18n("Failed to analyse clip.")),
+                                      Q_ARG(int, int(KMessageWidget::Warning)));
+            pCore->taskManager.taskDone(m_owner.second, this);
+            return;
         }
-    } else {
-        // Proxy process crashed
-        QMetaObject::invokeMethod(pCore.get(), "displayBinLogMessage", Qt::QueuedConnection, Q_ARG(QString, i18n("Failed to analyse clip.")),
-                                  Q_ARG(int, int(KMessageWidget::Warning)), Q_ARG(QString, m_logDetails));
-    }
-}
-
-void SceneSplitTask::processLogErr()
-{
-    const QString buffer = QString::fromUtf8(m_jobProcess->readAllStandardError());
-    qDebug()<<"ERROR: ----\n"<<buffer;
-}
-
-void SceneSplitTask::processLogInfo()
-{
-    const QString buffer = QString::fromUtf8(m_jobProcess->readAllStandardOutput());
-    m_logDetails.append(buffer);
-    int progress = 0;
-    // Parse FFmpeg output
-    qDebug()<<"-------------\n"<<buffer;
-    if (buffer.contains(QLatin1String("[Parsed_showinfo"))) {
-        QString timeMarker("pts_time:");
-        bool ok;
-        QStringList output = buffer.split("[Parsed_showinfo");
-        output.removeFirst();
-        for (const QString &o : qAsConst(output)) {
-            if (o.contains(timeMarker)) {
-                double res = o.section(timeMarker, 1).section(QLatin1Char(' '), 0, 0).toDouble(&ok);
-                if (ok) {
-                    m_results << res;
-                }
-            }
-        }
-    }
-    if (m_jobDuration == 0) {
-        qDebug()<<"=== NO DURATION!!!";
-        if (buffer.contains(QLatin1String("Duration:"))) {
-            QString data = buffer.section(QStringLiteral("Duration:"), 1, 1).section(QLatin1Char(','), 0, 0).simplified();
-            if (!data.isEmpty()) {
-                qDebug()<<"==== GOT DURATION:"<<data;
-                QStringList numbers = data.split(QLatin1Char(':'));
-                if (numbers.size() < 3) {
-                    return;
-                }
-                m_jobDuration = numbers.at(0).toInt() * 3600 + numbers.at(1).toInt() * 60 + numbers.at(2).toInt();
+        SceneChangeMetric metric;
+        IngestMediaInfo info = IngestAnalysisTask::mediaInfo(*analysisProducer.get(), length, true, 0, 48000);
+        bool completed = IngestAnalysisTask::decode(*analysisProducer.get(), info, {&metric}, [this](int progress) {
+            if (m_progress != progress) {
+                m_progress = progress;
+                QMetaObject::invokeMethod(m_object, "updateJobProgress");
             }
+            return !m_isCanceled;
+        });
+        if (!completed) {
+            m_progress = 100;
+            pCore->taskManager.taskDone(m_owner.second, this);
+            QMetaObject::invokeMethod(m_object, "updateJobProgress");
+            return;
         }
-    } else if (buffer.contains(QLatin1String("time="))) {
-        QString time = buffer.section(QStringLiteral("time="), 1, 1).simplified().section(QLatin1Char(' '), 0, 0);
-        qDebug()<<"=== GOT PROGRESS TIME: "<<time;
-        if (!time.isEmpty()) {
-            QStringList numbers = time.split(QLatin1Char(':'));
-            if (numbers.size() < 3) {
-                progress = time.toInt();
-                if (progress == 0) {
-                    return;
-                }
-            } else {
-                progress = numbers.at(0).toInt() * 3600 + numbers.at(1).toInt() * 60 + qRound(numbers.at(2).toDouble());
-            }
+        if (!prefix.isEmpty()) {
+            // Store the signal, so that the detection can be run again with other settings without decoding
+            metric.finish(prefix);
         }
-        m_progress = 100 * progress / m_jobDuration;
-        QMetaObject::invokeMethod(m_object, "updateJobProgress");
-        //emit jobProgress(int(100.0 * progress / m_jobDuration));
+        scores = metric.scores();
     }
+    QVector<int> cuts = sceneCuts(scores, m_threshold, m_minInterval);
+    m_progress = 100;
+    pCore->taskManager.taskDone(m_owner.second, this);
+    QMetaObject::invokeMethod(m_object, "updateJobProgress");
+    // Model changes have to happen in the main thread
+    int markersType = m_markersType;
+    bool subClips = m_subClips;
+    QMetaObject::invokeMethod(
+        pCore.get(), [binClip, cuts, markersType, subClips]() { applyCuts(binClip, cuts, markersType, subClips); }, Qt::QueuedConnection);
 }
@@ -8,28 +8,35 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "abstracttask.h"
 
-class QProcess;
+#include <QVector>
 
+#include <memory>
+
+class ProjectClip;
+
+/** @class SceneSplitTask
+    @brief Detects scene changes in a clip and adds markers and/or subclips at the cuts.
+    The per frame scene score is computed in process on downscaled frames and stored in the clip's analysis cache
+    (it is also produced by IngestAnalysisTask on import), so running the detection again with other settings
+    only queries the stored signal.
+ */
 class SceneSplitTask : public AbstractTask
 {
 public:
     SceneSplitTask(const ObjectId &owner, double threshold, int markersCategory, bool addSubclips, int minDuration, QObject* object);
     static void start(QObject* object, bool force = false);
+    /** @brief Returns the frames where the score is above @param threshold, ignoring cuts closer than @param minDuration frames to the previous one.
+        The first cut is always kept */
+    static QVector<int> sceneCuts(const QVector<float> &scores, double threshold, int minDuration);
 
 protected:
     void run() override;
 
-private slots:
-    void processLogInfo();
-    void processLogErr();
-
 private:
-    int m_jobDuration;
     int m_markersType;
     bool m_subClips;
     int m_minInterval;
-    std::unique_ptr<QProcess> m_jobProcess;
-    QString m_errorMessage;
-    QString m_logDetails;
-    QList<double> m_results;
+    double m_threshold;
+    /** @brief Create the markers and subclips for the detected cuts, in a single undo entry, nothing is done if there are no cuts. Must be called from the main thread */
+    static void applyCuts(const std::shared_ptr<ProjectClip> &binClip, const QVector<int> &cuts, int markersType, bool subClips);
 };
@@ -158,6 +158,7 @@ void SpeedTask::start(QObject* object, bool force)
 
 void SpeedTask::run()
 {
+    beginRun();
     if (m_isCanceled) {
         pCore->taskManager.taskDone(m_owner.second, this);
         return;
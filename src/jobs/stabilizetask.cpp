@@ -93,6 +93,7 @@ void StabilizeTask::start(QObject* object, bool force)
 
 void StabilizeTask::run()
 {
+    beginRun();
     if (m_isCanceled) {
         pCore->taskManager.taskDone(m_owner.second, this);
         return;
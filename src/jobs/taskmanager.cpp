@@ -15,17 +15,22 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "undohelper.hpp"
 
 #include <KMessageWidget>
+#include <QFileInfo>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QStorageInfo>
 #include <QThread>
 
 TaskManager::TaskManager(QObject *parent)
     : QObject(parent)
     , m_tasksListLock(QReadWriteLock::Recursive)
+    , m_usedEncoders(0)
+    , m_encoderWaiters(0)
 {
     int maxThreads = qMin(4, QThread::idealThreadCount() - 1);
     m_taskPool.setMaxThreadCount(qMax(maxThreads, 1));
     m_transcodePool.setMaxThreadCount(KdenliveSettings::proxythreads());
+    m_audioPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
 }
 
 TaskManager::~TaskManager()
@@ -36,6 +41,67 @@ TaskManager::~TaskManager()
 void TaskManager::updateConcurrency()
 {
     m_transcodePool.setMaxThreadCount(KdenliveSettings::proxythreads());
+    QMutexLocker lk(&m_encoderMutex);
+    m_encoderCondition.wakeAll();
+}
+
+bool TaskManager::acquireEncoderSlot(const QAtomicInt &canceled, bool wait)
+{
+    QMutexLocker lk(&m_encoderMutex);
+    if (!wait) {
+        // Jobs waiting for their first encoder have precedence over additional segments
+        if (m_encoderWaiters > 0 || m_usedEncoders >= qMax(1, KdenliveSettings::proxythreads())) {
+            return false;
+        }
+        m_usedEncoders++;
+        return true;
+    }
+    m_encoderWaiters++;
+    while (m_usedEncoders >= qMax(1, KdenliveSettings::proxythreads())) {
+        // Wake up regularly to check if the job was canceled
+        m_encoderCondition.wait(&m_encoderMutex, 200);
+        if (canceled) {
+            m_encoderWaiters--;
+            return false;
+        }
+    }
+    m_encoderWaiters--;
+    m_usedEncoders++;
+    return true;
+}
+
+void TaskManager::releaseEncoderSlot()
+{
+    QMutexLocker lk(&m_encoderMutex);
+    m_usedEncoders = qMax(0, m_usedEncoders - 1);
+    m_encoderCondition.wakeAll();
+}
+
+QByteArray TaskManager::acquireReadSlot(const QString &path, const QAtomicInt &canceled)
+{
+    QByteArray device = QStorageInfo(QFileInfo(path).absolutePath()).device();
+    if (device.isEmpty()) {
+        device = QByteArrayLiteral("unknown");
+    }
+    QMutexLocker lk(&m_readMutex);
+    while (m_usedReaders.value(device) >= qMax(1, KdenliveSettings::audiothumbreaders())) {
+        // Wake up regularly to check if the job was canceled
+        m_readCondition.wait(&m_readMutex, 200);
+        if (canceled) {
+            return QByteArray();
+        }
+    }
+    m_usedReaders[device]++;
+    return device;
+}
+
+void TaskManager::releaseReadSlot(const QByteArray &device)
+{
+    QMutexLocker lk(&m_readMutex);
+    if (--m_usedReaders[device] <= 0) {
+        m_usedReaders.remove(device);
+    }
+    m_readCondition.wakeAll();
 }
 
 void TaskManager::discardJobs(const ObjectId &owner, AbstractTask::JOBTYPE type, bool softDelete)
@@ -109,6 +175,7 @@ void TaskManager::updateJobCount()
 void TaskManager::taskDone(int cid, AbstractTask *task)
 {
     // This will be executed in the QRunnable job thread
+    recordMetrics(task);
     m_tasksListLock.lockForWrite();
     Q_ASSERT(m_taskList.find(cid) != m_taskList.end());
     m_taskList[cid].erase(std::remove(m_taskList[cid].begin(), m_taskList[cid].end(), task), m_taskList[cid].end());
@@ -133,11 +200,14 @@ void TaskManager::slotCancelJobs()
     m_tasksListLock.unlock();
     m_taskPool.waitForDone();
     m_transcodePool.waitForDone();
+    m_audioPool.waitForDone();
     updateJobCount();
 }
 
 void TaskManager::startTask(int ownerId, AbstractTask *task)
 {
+    // Queue time starts now
+    task->m_lifeTimer.start();
     m_tasksListLock.lockForWrite();
     if (m_taskList.find(ownerId) == m_taskList.end()) {
         // First task for this clip
@@ -148,6 +218,9 @@ void TaskManager::startTask(int ownerId, AbstractTask *task)
     if (task->m_type == AbstractTask::TRANSCODEJOB || task->m_type == AbstractTask::PROXYJOB) {
         // We only want a limited concurrent jobs for those as for example GPU usually only accept 2 concurrent encoding jobs
         m_transcodePool.start(task, task->m_priority);
+    } else if (task->m_type == AbstractTask::AUDIOTHUMBJOB) {
+        // Audio thumbnails are limited by the disk budget, see acquireReadSlot, and must not delay other jobs on large imports
+        m_audioPool.start(task, task->m_priority);
     } else {
         m_taskPool.start(task, task->m_priority);
     }
@@ -174,6 +247,124 @@ int TaskManager::getJobProgressForClip(const ObjectId &owner) const
     return total;
 }
 
+void TaskManager::taskStarted(AbstractTask *task)
+{
+    QMutexLocker lk(&m_metricsMutex);
+    JobMetrics &metrics = m_metrics[task->m_type];
+    metrics.running++;
+    metrics.maxRunning = qMax(metrics.maxRunning, metrics.running);
+}
+
+void TaskManager::recordMetrics(AbstractTask *task)
+{
+    const qint64 now = task->m_lifeTimer.elapsed();
+    const bool started = task->m_runStart > -1;
+    const qint64 queueTime = started ? task->m_runStart : now;
+    const qint64 runTime = started ? now - task->m_runStart : 0;
+    const qint64 canceledAt = task->m_canceledAt;
+    QMutexLocker lk(&m_metricsMutex);
+    JobMetrics &metrics = m_metrics[task->m_type];
+    if (started) {
+        metrics.running = qMax(0, metrics.running - 1);
+    }
+    metrics.queueTime += queueTime;
+    metrics.maxQueueTime = qMax(metrics.maxQueueTime, queueTime);
+    metrics.runTime += runTime;
+    metrics.maxRunTime = qMax(metrics.maxRunTime, runTime);
+    metrics.sourceBytes += task->m_sourceBytes;
+    metrics.framesDecoded += task->m_framesDecoded;
+    if (canceledAt > -1) {
+        const qint64 latency = qMax(qint64(0), now - canceledAt);
+        metrics.canceled++;
+        metrics.cancelLatency += latency;
+        metrics.maxCancelLatency = qMax(metrics.maxCancelLatency, latency);
+    } else {
+        metrics.finished++;
+    }
+}
+
+std::map<AbstractTask::JOBTYPE, JobMetrics> TaskManager::jobMetrics() const
+{
+    QMutexLocker lk(&m_metricsMutex);
+    return m_metrics;
+}
+
+void TaskManager::resetMetrics()
+{
+    QMutexLocker lk(&m_metricsMutex);
+    // Keep the running counters, those tasks will still report when they are done
+    for (auto &metrics : m_metrics) {
+        JobMetrics reset;
+        reset.running = metrics.second.running;
+        reset.maxRunning = metrics.second.running;
+        metrics.second = reset;
+    }
+}
+
+QString TaskManager::jobTypeName(AbstractTask::JOBTYPE type)
+{
+    switch (type) {
+    case AbstractTask::PROXYJOB:
+        return QStringLiteral("proxy");
+    case AbstractTask::CUTJOB:
+        return QStringLiteral("cut");
+    case AbstractTask::STABILIZEJOB:
+        return QStringLiteral("stabilize");
+    case AbstractTask::TRANSCODEJOB:
+        return QStringLiteral("transcode");
+    case AbstractTask::FILTERCLIPJOB:
+        return QStringLiteral("filter");
+    case AbstractTask::THUMBJOB:
+        return QStringLiteral("thumbnail");
+    case AbstractTask::ANALYSECLIPJOB:
+        return QStringLiteral("analyse");
+    case AbstractTask::LOADJOB:
+        return QStringLiteral("load");
+    case AbstractTask::AUDIOTHUMBJOB:
+        return QStringLiteral("audiothumb");
+    case AbstractTask::SPEEDJOB:
+        return QStringLiteral("speed");
+    case AbstractTask::CACHEJOB:
+        return QStringLiteral("cache");
+    case AbstractTask::INGESTJOB:
+        return QStringLiteral("ingest");
+    default:
+        return QStringLiteral("other");
+    }
+}
+
+QJsonObject TaskManager::metricsJson() const
+{
+    QJsonObject settings;
+    settings.insert(QStringLiteral("taskthreads"), m_taskPool.maxThreadCount());
+    settings.insert(QStringLiteral("proxythreads"), KdenliveSettings::proxythreads());
+    settings.insert(QStringLiteral("proxysegmentlength"), KdenliveSettings::proxysegmentlength());
+    settings.insert(QStringLiteral("audiothreads"), m_audioPool.maxThreadCount());
+    settings.insert(QStringLiteral("audiothumbreaders"), KdenliveSettings::audiothumbreaders());
+    QJsonObject jobs;
+    for (const auto &metrics : jobMetrics()) {
+        const JobMetrics &m = metrics.second;
+        QJsonObject job;
+        job.insert(QStringLiteral("finished"), m.finished);
+        job.insert(QStringLiteral("canceled"), m.canceled);
+        job.insert(QStringLiteral("queueTimeMs"), double(m.queueTime));
+        job.insert(QStringLiteral("maxQueueTimeMs"), double(m.maxQueueTime));
+        job.insert(QStringLiteral("runTimeMs"), double(m.runTime));
+        job.insert(QStringLiteral("maxRunTimeMs"), double(m.maxRunTime));
+        job.insert(QStringLiteral("sourceBytes"), double(m.sourceBytes));
+        job.insert(QStringLiteral("framesDecoded"), double(m.framesDecoded));
+        job.insert(QStringLiteral("cancelLatencyMs"), double(m.cancelLatency));
+        job.insert(QStringLiteral("maxCancelLatencyMs"), double(m.maxCancelLatency));
+        job.insert(QStringLiteral("running"), m.running);
+        job.insert(QStringLiteral("maxRunning"), m.maxRunning);
+        jobs.insert(jobTypeName(metrics.first), job);
+    }
+    QJsonObject result;
+    result.insert(QStringLiteral("settings"), settings);
+    result.insert(QStringLiteral("jobs"), jobs);
+    return result;
+}
+
 /*QPair<QString, QString> TaskManager::getJobMessageForClip(int jobId, const QString &binId) const
 {
     READ_LOCK();
@@ -13,9 +13,13 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include <QAbstractListModel>
 #include <QFutureWatcher>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
 #include <QObject>
 #include <QReadWriteLock>
 #include <QThreadPool>
+#include <QWaitCondition>
 #include <map>
 #include <memory>
 #include <unordered_map>
@@ -26,6 +30,27 @@ class AbstractTask;
 enum class TaskManagerStatus { NoJob, Pending, Running, Finished, Canceled };
 Q_DECLARE_METATYPE(TaskManagerStatus)
 
+/** @brief Metrics of the finished tasks of one job type, times are in milliseconds */
+struct JobMetrics
+{
+    int finished = 0;
+    int canceled = 0;
+    qint64 queueTime = 0;
+    qint64 maxQueueTime = 0;
+    qint64 runTime = 0;
+    qint64 maxRunTime = 0;
+    /** @brief Total size of the source files of the tasks that completed, not the data actually read */
+    qint64 sourceBytes = 0;
+    /** @brief Frames decoded by the tasks, including the frames decoded to reach a position */
+    qint64 framesDecoded = 0;
+    /** @brief Time between the cancel request and the end of canceled tasks */
+    qint64 cancelLatency = 0;
+    qint64 maxCancelLatency = 0;
+    /** @brief Tasks currently running, and the highest number of tasks that ran at the same time */
+    int running = 0;
+    int maxRunning = 0;
+};
+
 /** @class TaskManager
     @brief This class is responsible for clip jobs management.
  */
@@ -63,6 +88,31 @@ public:
     /** @brief Update the number of concurrent jobs allowed */
     void updateConcurrency();
 
+    /** @brief Reserve one of the encoder processes allowed by the proxythreads setting.
+     *  Transcode and proxy jobs hold one while their encoder runs, segmented proxy jobs try to get more to encode several segments at once.
+     *  @param wait if false, return false immediately when no encoder is free or when another job is waiting for one
+     *  @returns false if no encoder was reserved, including when @param canceled was set while waiting
+     */
+    bool acquireEncoderSlot(const QAtomicInt &canceled, bool wait = true);
+    void releaseEncoderSlot();
+
+    /** @brief Reserve one of the audio decoders allowed on the disk holding @param path by the audiothumbreaders setting.
+     *  Audio thumbnail jobs run on all cores, this keeps them from competing for the same disk.
+     *  @returns the disk identifier to pass to releaseReadSlot, or an empty value if @param canceled was set while waiting
+     */
+    QByteArray acquireReadSlot(const QString &path, const QAtomicInt &canceled);
+    void releaseReadSlot(const QByteArray &device);
+
+    /** @brief Called by a task when its run() starts, see AbstractTask::beginRun */
+    void taskStarted(AbstractTask *task);
+    /** @brief The metrics of the tasks finished since startup or the last resetMetrics(), by job type */
+    std::map<AbstractTask::JOBTYPE, JobMetrics> jobMetrics() const;
+    /** @brief The job metrics and the current concurrency settings as JSON, for diagnostics */
+    QJsonObject metricsJson() const;
+    void resetMetrics();
+    /** @brief A non translated identifier of the job type, used in the metrics dump */
+    static QString jobTypeName(AbstractTask::JOBTYPE type);
+
     /** @brief return the message of a given job on a given clip (message, detailed log)*/
     //QPair<QString, QString> getJobMessageForClip(int jobId, const QString &binId) const;
 
@@ -77,8 +127,22 @@ private slots:
 private:
     QThreadPool m_taskPool;
     QThreadPool m_transcodePool;
+    /** @brief Audio thumbnail jobs, they are cheap on CPU so they get their own pool using all cores */
+    QThreadPool m_audioPool;
     std::unordered_map<int, std::vector<AbstractTask*> > m_taskList;
     mutable QReadWriteLock m_tasksListLock;
+    QMutex m_encoderMutex;
+    QWaitCondition m_encoderCondition;
+    int m_usedEncoders;
+    int m_encoderWaiters;
+    QMutex m_readMutex;
+    QWaitCondition m_readCondition;
+    /** @brief Number of audio decoders running per disk */
+    QHash<QByteArray, int> m_usedReaders;
+    mutable QMutex m_metricsMutex;
+    std::map<AbstractTask::JOBTYPE, JobMetrics> m_metrics;
+    /** @brief Add a finished task to the job metrics */
+    void recordMetrics(AbstractTask *task);
 
 signals:
     void jobCount(int);
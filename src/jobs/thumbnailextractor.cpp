@@ -0,0 +1,100 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "thumbnailextractor.h"
+#include "doc/kthumb.h"
+#include "kdenlive_debug.h"
+
+#include <mlt++/MltFrame.h>
+#include <mlt++/MltProducer.h>
+
+#include <QScopedPointer>
+#include <QtGlobal>
+
+ThumbnailExtractor::Plan ThumbnailExtractor::plan(const std::set<int> &positions, int sequentialGap)
+{
+    Plan result;
+    int current = -1;
+    for (int position : positions) {
+        // Decoding forward is cheaper than seeking, which decodes from the previous keyframe
+        bool seek = current < 0 || position - current > sequentialGap;
+        if (seek) {
+            result.seeks++;
+        }
+        result.steps.append({position, seek});
+        current = position;
+    }
+    return result;
+}
+
+QImage ThumbnailExtractor::grabFrame(Mlt::Producer &producer, int width, int height, int fullWidth)
+{
+    QScopedPointer<Mlt::Frame> frame(producer.get_frame());
+    if (frame == nullptr || !frame->is_valid()) {
+        return QImage();
+    }
+#if LIBMLT_VERSION_INT < QT_VERSION_CHECK(7, 5, 0)
+    frame->set("deinterlace_method", "onefield");
+    frame->set("top_field_first", -1);
+    frame->set("rescale.interp", "nearest");
+#else
+    frame->set("consumer.deinterlacer", "onefield");
+    frame->set("consumer.top_field_first", -1);
+    frame->set("consumer.rescale", "nearest");
+#endif
+    return KThumb::getFrame(frame.data(), width, height, fullWidth);
+}
+
+ThumbnailExtractor::Stats ThumbnailExtractor::extract(Mlt::Producer &producer, const Plan &plan, int fullWidth,
+                                                      const std::function<bool(int, const QImage &)> &callback, const QAtomicInt *canceled)
+{
+    Stats stats;
+    stats.requested = plan.steps.size();
+    stats.seeks = plan.seeks;
+    QImage last;
+    int lastPosition = -1;
+    for (const Step &step : plan.steps) {
+        if (canceled && canceled->loadAcquire()) {
+            break;
+        }
+        if (step.seek || lastPosition < 0 || step.position <= lastPosition) {
+            producer.seek(step.position);
+        } else {
+            // Decode forward from the previous step without seeking, the producer is already after the previous thumbnail.
+            // Frames are decoded in their native format since we don't need their image
+            while (producer.position() < step.position && !(canceled && canceled->loadAcquire())) {
+                QScopedPointer<Mlt::Frame> frame(producer.get_frame());
+                if (frame == nullptr || !frame->is_valid()) {
+                    producer.seek(step.position);
+                    break;
+                }
+                mlt_image_format format = mlt_image_none;
+                int width = 0;
+                int height = 0;
+                frame->get_image(format, width, height);
+                stats.decoded++;
+            }
+        }
+        last = grabFrame(producer, 0, 0, fullWidth);
+        lastPosition = step.position;
+        stats.fetched++;
+        stats.decoded++;
+        if (last.isNull()) {
+            continue;
+        }
+        if (!callback(step.position, last)) {
+            break;
+        }
+    }
+    qCDebug(KDENLIVE_LOG) << "Thumbnail batch: requested" << stats.requested << "fetched" << stats.fetched << "decoded" << stats.decoded << "seeks"
+                          << stats.seeks;
+    return stats;
+}
+
+int ThumbnailExtractor::sequentialGap(Mlt::Producer &producer)
+{
+    return qMax(1, qRound(producer.get_fps()));
+}
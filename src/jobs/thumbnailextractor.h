@@ -0,0 +1,69 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QAtomicInt>
+#include <QImage>
+#include <QVector>
+
+#include <functional>
+#include <set>
+
+namespace Mlt {
+class Frame;
+class Producer;
+} // namespace Mlt
+
+/** @class ThumbnailExtractor
+    @brief Extracts a batch of thumbnails from a producer while limiting the decoding work.
+    Seeking in long GOP files means decoding from the previous keyframe for each requested frame. The extractor
+    plans the requests so that close frames are decoded forward without seeking.
+    Thumbnails are passed to a callback as soon as they are ready.
+ */
+class ThumbnailExtractor
+{
+public:
+    struct Step
+    {
+        int position;
+        /** @brief True if the producer has to seek, false if we can decode forward from the previous step */
+        bool seek;
+    };
+    struct Plan
+    {
+        QVector<Step> steps;
+        int seeks = 0;
+    };
+    struct Stats
+    {
+        int requested = 0;
+        /** @brief Number of thumbnail images fetched from the producer */
+        int fetched = 0;
+        /** @brief Number of frames decoded to reach the thumbnails positions, including the fetched ones */
+        int decoded = 0;
+        int seeks = 0;
+    };
+
+    /** @brief Build an extraction plan
+       @param positions the requested frames
+       @param sequentialGap maximum distance to decode forward instead of seeking
+     */
+    static Plan plan(const std::set<int> &positions, int sequentialGap);
+
+    /** @brief Fetch the thumbnails of a plan, calling @param callback for each of them, in order.
+       The callback can return false to stop the extraction.
+       @param fullWidth if not 0, width to which the images are scaled to respect the display aspect ratio
+     */
+    static Stats extract(Mlt::Producer &producer, const Plan &plan, int fullWidth, const std::function<bool(int position, const QImage &)> &callback,
+                         const QAtomicInt *canceled = nullptr);
+
+    /** @brief Fetch a single thumbnail at the producer's current position with fast scaling options */
+    static QImage grabFrame(Mlt::Producer &producer, int width = 0, int height = 0, int fullWidth = 0);
+
+    /** @brief Maximum distance for which decoding forward is used instead of seeking, one second */
+    static int sequentialGap(Mlt::Producer &producer);
+};
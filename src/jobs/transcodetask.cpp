@@ -55,6 +55,7 @@ void TranscodeTask::start(const ObjectId &owner, const QString &suffix, const QS
 
 void TranscodeTask::run()
 {
+    beginRun();
     if (m_isCanceled) {
         pCore->taskManager.taskDone(m_owner.second, this);
         return;
@@ -169,9 +170,14 @@ void TranscodeTask::run()
         // m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
         QObject::connect(this, &TranscodeTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
         QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &TranscodeTask::processLogInfo);
-        m_jobProcess->start(KdenliveSettings::rendererpath(), mltParameters);
-        m_jobProcess->waitForFinished(-1);
-        result = m_jobProcess->exitStatus() == QProcess::NormalExit;
+        if (pCore->taskManager.acquireEncoderSlot(m_isCanceled)) {
+            m_jobProcess->start(KdenliveSettings::rendererpath(), mltParameters);
+            m_jobProcess->waitForFinished(-1);
+            pCore->taskManager.releaseEncoderSlot();
+            result = m_jobProcess->exitStatus() == QProcess::NormalExit;
+        } else {
+            result = false;
+        }
     } else {
         m_isFfmpegJob = true;
         QStringList parameters;
@@ -213,11 +219,19 @@ void TranscodeTask::run()
         // m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
         QObject::connect(this, &TranscodeTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
         QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &TranscodeTask::processLogInfo);
-        m_jobProcess->start(KdenliveSettings::ffmpegpath(), parameters, QIODevice::ReadOnly);
-        m_jobProcess->waitForFinished(-1);
-        result = m_jobProcess->exitStatus() == QProcess::NormalExit;
+        if (pCore->taskManager.acquireEncoderSlot(m_isCanceled)) {
+            m_jobProcess->start(KdenliveSettings::ffmpegpath(), parameters, QIODevice::ReadOnly);
+            m_jobProcess->waitForFinished(-1);
+            pCore->taskManager.releaseEncoderSlot();
+            result = m_jobProcess->exitStatus() == QProcess::NormalExit;
+        } else {
+            result = false;
+        }
     }
     destUrl.append(transcoderExt);
+    if (result && !m_isCanceled) {
+        addSourceBytes(finfo.size());
+    }
     // remove temporary playlist if it exists
     m_progress = 100;
     pCore->taskManager.taskDone(m_owner.second, this);
@@ -55,6 +55,20 @@ reading a Read-protected property. In that case, we try to write lock it first (
         Q_ASSERT(false);                                                                                                                                       \
     }
 
+/** @brief Same as PUSH_UNDO, but the command is merged with the previous one if it has the same merge key and was pushed shortly before.
+ * This is used for repetitive small edits (like dragging a keyframe) so that they end up as a single undo entry.
+ * The key can be followed by the key that the next command must have, see FunctionalUndoCommand::setMergeKey
+*/
+#define PUSH_UNDO_MERGE(undo, redo, text, ...)                                                                                                                 \
+    if (auto ptr = m_undoStack.lock()) {                                                                                                                       \
+        auto *command = new FunctionalUndoCommand(undo, redo, text);                                                                                           \
+        command->setMergeKey(__VA_ARGS__);                                                                                                                     \
+        ptr->push(command);                                                                                                                                    \
+    } else {                                                                                                                                                   \
+        qDebug() << "ERROR : unable to access undo stack";                                                                                                     \
+        Q_ASSERT(false);                                                                                                                                       \
+    }
+
 /** @brief This macro takes as parameter one atomic operation and its reverse, and update
  * the undo and redo functional stacks/queue accordingly
  * This should be used in the rare case where we don't need a lock mutex. In general, prefer the other version
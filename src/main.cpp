@@ -17,6 +17,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kcoreaddons_version.h"
 #include "kxmlgui_version.h"
 #include "mainwindow.h"
+#include "utils/startuptimeline.hpp"
 
 #include <KAboutData>
 #include <KConfigGroup>
@@ -60,6 +61,7 @@ extern "C"
 
 int main(int argc, char *argv[])
 {
+    StartupTimeline::start();
 #ifdef USE_DRMINGW
     ExcHndlInit();
 #endif
@@ -93,6 +95,7 @@ int main(int argc, char *argv[])
     app.setOrganizationDomain(QStringLiteral("kde.org"));
     app.setWindowIcon(QIcon(QStringLiteral(":/pics/kdenlive.png")));
     KLocalizedString::setApplicationDomain("kdenlive");
+    StartupTimeline::mark(QStringLiteral("Application created"));
 
     qApp->processEvents(QEventLoop::AllEvents);
     Splash splash;
@@ -302,6 +305,7 @@ int main(int argc, char *argv[])
         // App is crashing, delete config files and restart
         result = EXIT_CLEAN_RESTART;
     } else {
+        StartupTimeline::mark(QStringLiteral("Core built"));
         QObject::connect(pCore.get(), &Core::loadingMessageUpdated, &splash, &Splash::showProgressMessage, Qt::DirectConnection);
         QObject::connect(pCore.get(), &Core::closeSplash, &splash, [&] () {
             splash.finish(pCore->window());
@@ -15,6 +15,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "bin/projectitemmodel.h"
 #include "core.h"
 #include "dialogs/clipcreationdialog.h"
+#include "dialogs/jobmetricsdialog.h"
 #include "dialogs/kdenlivesettingsdialog.h"
 #include "dialogs/renderwidget.h"
 #include "dialogs/subtitleedit.h"
@@ -80,6 +81,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <KCoreAddons>
 #include <KDualAction>
 #include <KEditToolBar>
+#include <KIO/Global>
 #include <KIconTheme>
 #include <KMessageBox>
 #include <KNotifyConfigWidget>
@@ -104,7 +106,9 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <KConfigGroup>
 #include <QAction>
 #include <QDialogButtonBox>
+#include <QElapsedTimer>
 #include <QFileDialog>
+#include <QLabel>
 #include <QMenu>
 #include <QMenuBar>
 #include <QPushButton>
@@ -355,10 +359,13 @@ void MainWindow::init(const QString &mltPath)
     QDockWidget *screenGrabDock = addDock(i18n("Screen Grab"), QStringLiteral("screengrab"), grabWidget);
 
     // Audio spectrum scope
-    m_audioSpectrum = new AudioGraphSpectrum(pCore->monitorManager());
-    QDockWidget *spectrumDock = addDock(i18n("Audio Spectrum"), QStringLiteral("audiospectrum"), m_audioSpectrum);
-    connect(spectrumDock, &QDockWidget::visibilityChanged, this, [&](bool visible) {
-        m_audioSpectrum->dockVisible(visible);
+    QDockWidget *spectrumDock = addLazyDock(i18n("Audio Spectrum"), QStringLiteral("audiospectrum"), [this](QDockWidget *dock) {
+        m_audioSpectrum = new AudioGraphSpectrum(pCore->monitorManager());
+        connect(dock, &QDockWidget::visibilityChanged, m_audioSpectrum, [this](bool visible) {
+            m_audioSpectrum->dockVisible(visible);
+        });
+        m_audioSpectrum->dockVisible(true);
+        return m_audioSpectrum;
     });
     
     // Project bin
@@ -369,17 +376,18 @@ void MainWindow::init(const QString &mltPath)
     pCore->bin()->dockWidgetInit(clipDockWidget);
 
     // Online resources widget
-    auto *onlineResources = new ResourceWidget(this);
-    m_onlineResourcesDock = addDock(i18n("Online Resources"), QStringLiteral("onlineresources"), onlineResources);
-    connect(onlineResources, &ResourceWidget::previewClip, this, [&](const QString &path, const QString &title) {
-        m_clipMonitor->slotPreviewResource(path, title);
-        m_clipMonitorDock->show();
-        m_clipMonitorDock->raise();
+    m_onlineResourcesDock = addLazyDock(i18n("Online Resources"), QStringLiteral("onlineresources"), [this](QDockWidget *) {
+        auto *onlineResources = new ResourceWidget(this);
+        connect(onlineResources, &ResourceWidget::previewClip, this, [this](const QString &path, const QString &title) {
+            m_clipMonitor->slotPreviewResource(path, title);
+            m_clipMonitorDock->show();
+            m_clipMonitorDock->raise();
+        });
+        connect(onlineResources, &ResourceWidget::addClip, this, &MainWindow::slotAddProjectClip);
+        connect(onlineResources, &ResourceWidget::addLicenseInfo, this, &MainWindow::slotAddTextNote);
+        return onlineResources;
     });
 
-    connect(onlineResources, &ResourceWidget::addClip, this, &MainWindow::slotAddProjectClip);
-    connect(onlineResources, &ResourceWidget::addLicenseInfo, this, &MainWindow::slotAddTextNote);
-
     // Close library and audiospectrum and others on first run
     screenGrabDock->close();
     libraryDock->close();
@@ -460,7 +468,26 @@ void MainWindow::init(const QString &mltPath)
     m_undoView->setCleanIcon(QIcon::fromTheme(QStringLiteral("edit-clear")));
     m_undoView->setEmptyLabel(i18n("Clean"));
     m_undoView->setGroup(m_commandStack);
-    m_undoViewDock = addDock(i18n("Undo History"), QStringLiteral("undo_history"), m_undoView);
+    auto *undoContainer = new QWidget(this);
+    auto *undoLayout = new QVBoxLayout(undoContainer);
+    undoLayout->setContentsMargins(0, 0, 0, 0);
+    undoLayout->addWidget(m_undoView);
+    auto *undoMemoryLabel = new QLabel(undoContainer);
+    undoMemoryLabel->setToolTip(i18n("Estimated memory used by the undo history"));
+    undoLayout->addWidget(undoMemoryLabel);
+    auto updateUndoMemory = [undoMemoryLabel](qint64 bytes) { undoMemoryLabel->setText(i18n("Memory: %1", KIO::convertSize(KIO::filesize_t(bytes)))); };
+    updateUndoMemory(0);
+    auto undoMemoryConnection = std::make_shared<QMetaObject::Connection>();
+    connect(m_commandStack, &QUndoGroup::activeStackChanged, undoMemoryLabel, [undoMemoryLabel, undoMemoryConnection, updateUndoMemory](QUndoStack *stack) {
+        // Only follow the active document's stack
+        QObject::disconnect(*undoMemoryConnection);
+        auto *docStack = qobject_cast<DocUndoStack *>(stack);
+        updateUndoMemory(docStack ? docStack->memoryUsage() : 0);
+        if (docStack) {
+            *undoMemoryConnection = connect(docStack, &DocUndoStack::memoryUsageChanged, undoMemoryLabel, updateUndoMemory);
+        }
+    });
+    m_undoViewDock = addDock(i18n("Undo History"), QStringLiteral("undo_history"), undoContainer);
 
     // Color and icon theme stuff
     connect(m_commandStack, &QUndoGroup::cleanChanged, m_saveAction, &QAction::setDisabled);
@@ -1870,6 +1897,8 @@ void MainWindow::setupActions()
 
     addAction(QStringLiteral("copy_debuginfo"), i18n("Copy Debug Information"), this, SLOT(slotCopyDebugInfo()),
               QIcon::fromTheme(QStringLiteral("edit-copy")));
+    addAction(QStringLiteral("job_statistics"), i18n("Job Statistics…"), this, SLOT(slotShowJobMetrics()),
+              QIcon::fromTheme(QStringLiteral("view-statistics")));
 
     QAction *disableEffects = addAction(QStringLiteral("disable_timeline_effects"), i18n("Disable Timeline Effects"), pCore->projectManager(),
                                         SLOT(slotDisableTimelineEffects(bool)), QIcon::fromTheme(QStringLiteral("favorite")));
@@ -3910,6 +3939,30 @@ QDockWidget *MainWindow::addDock(const QString &title, const QString &objectName
     return dockWidget;
 }
 
+QDockWidget *MainWindow::addLazyDock(const QString &title, const QString &objectName, const std::function<QWidget *(QDockWidget *)> &factory,
+                                     Qt::DockWidgetArea area)
+{
+    QDockWidget *dockWidget = addDock(title, objectName, new QWidget(this), area);
+    auto connection = std::make_shared<QMetaObject::Connection>();
+    *connection = connect(dockWidget, &QDockWidget::visibilityChanged, this, [dockWidget, factory, connection](bool visible) {
+        if (!visible) {
+            return;
+        }
+        QObject::disconnect(*connection);
+        QElapsedTimer timer;
+        timer.start();
+        QWidget *placeholder = dockWidget->widget();
+        QWidget *widget = factory(dockWidget);
+        dockWidget->setWidget(widget);
+        widget->show();
+        if (placeholder) {
+            placeholder->deleteLater();
+        }
+        qCDebug(KDENLIVE_LOG) << "Dock" << dockWidget->objectName() << "created in" << timer.elapsed() << "ms";
+    });
+    return dockWidget;
+}
+
 bool MainWindow::isMixedTabbed() const
 {
     return !tabifiedDockWidgets(m_mixerDock).isEmpty();
@@ -4110,6 +4163,13 @@ void MainWindow::setTimelineToolbarIconSize(QAction *a)
     m_timelineToolBar->saveSettings(tbGroup);
 }
 
+void MainWindow::slotShowJobMetrics()
+{
+    auto *d = new JobMetricsDialog(this);
+    d->setAttribute(Qt::WA_DeleteOnClose);
+    d->show();
+}
+
 void MainWindow::slotManageCache()
 {
     QPointer<TemporaryData> d(new TemporaryData(pCore->currentDoc(), false, this));
@@ -24,6 +24,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <KSelectAction>
 #include <KXmlGuiWindow>
 #include <kautosavefile.h>
+#include <functional>
 #include <utility>
 #include <mlt++/Mlt.h>
 
@@ -110,6 +111,14 @@ public:
      * @returns the created dock widget
      */
     QDockWidget *addDock(const QString &title, const QString &objectName, QWidget *widget, Qt::DockWidgetArea area = Qt::TopDockWidgetArea);
+    /**
+     * @brief Adds a new dock widget whose content is only built the first time the dock is shown.
+     * Until then the dock contains an empty placeholder, so that layouts can still be restored.
+     * @param factory builds the content of the dock, it receives the dock widget
+     * @returns the created dock widget
+     */
+    QDockWidget *addLazyDock(const QString &title, const QString &objectName, const std::function<QWidget *(QDockWidget *)> &factory,
+                             Qt::DockWidgetArea area = Qt::TopDockWidgetArea);
 
     QUndoGroup *m_commandStack;
     QUndoView *m_undoView;
@@ -213,7 +222,7 @@ private:
     QDockWidget *m_projectMonitorDock;
     Monitor *m_projectMonitor{nullptr};
 
-    AudioGraphSpectrum *m_audioSpectrum;
+    AudioGraphSpectrum *m_audioSpectrum{nullptr};
 
     QDockWidget *m_undoViewDock;
     QDockWidget *m_mixerDock;
@@ -530,6 +539,8 @@ private slots:
     void showTimelineToolbarMenu(const QPoint &pos);
     /** @brief Open Cached Data management dialog. */
     void slotManageCache();
+    /** @brief Display the metrics of the background jobs. */
+    void slotShowJobMetrics();
     void showMenuBar(bool show);
     /** @brief Change forced icon theme setting (asks for app restart). */
     void forceIconSet(bool force);
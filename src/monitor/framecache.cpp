@@ -0,0 +1,142 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "framecache.h"
+
+#include <QMutexLocker>
+
+#include <iterator>
+
+FrameCache::FrameCache(qint64 budget)
+    : m_budget(budget)
+    , m_usage(0)
+    , m_version(0)
+    , m_lastPosition(0)
+{
+}
+
+void FrameCache::setBudget(qint64 bytes)
+{
+    QMutexLocker lk(&m_mutex);
+    if (m_budget == bytes) {
+        return;
+    }
+    m_budget = bytes;
+    evict();
+}
+
+qint64 FrameCache::budget() const
+{
+    QMutexLocker lk(&m_mutex);
+    return m_budget;
+}
+
+qint64 FrameCache::usage() const
+{
+    QMutexLocker lk(&m_mutex);
+    return m_usage;
+}
+
+int FrameCache::count() const
+{
+    QMutexLocker lk(&m_mutex);
+    return int(m_frames.size());
+}
+
+quint64 FrameCache::version() const
+{
+    QMutexLocker lk(&m_mutex);
+    return m_version;
+}
+
+SharedFrame FrameCache::frame(int position)
+{
+    QMutexLocker lk(&m_mutex);
+    m_lastPosition = position;
+    auto it = m_frames.find(position);
+    if (it == m_frames.end()) {
+        return SharedFrame();
+    }
+    return it->second.first;
+}
+
+bool FrameCache::contains(int position) const
+{
+    QMutexLocker lk(&m_mutex);
+    return m_frames.count(position) > 0;
+}
+
+bool FrameCache::insert(int position, const SharedFrame &frame, quint64 version)
+{
+    if (!frame.is_valid()) {
+        return false;
+    }
+    qint64 cost = frameCost(frame);
+    QMutexLocker lk(&m_mutex);
+    if (version != m_version || cost > m_budget) {
+        return false;
+    }
+    auto it = m_frames.find(position);
+    if (it != m_frames.end()) {
+        m_usage -= it->second.second;
+        m_frames.erase(it);
+    }
+    m_frames.emplace(position, std::make_pair(frame, cost));
+    m_usage += cost;
+    evict();
+    return true;
+}
+
+void FrameCache::invalidate(int in, int out)
+{
+    QMutexLocker lk(&m_mutex);
+    m_version++;
+    auto it = m_frames.lower_bound(in);
+    while (it != m_frames.end() && it->first <= out) {
+        m_usage -= it->second.second;
+        it = m_frames.erase(it);
+    }
+}
+
+void FrameCache::clear()
+{
+    QMutexLocker lk(&m_mutex);
+    m_version++;
+    m_frames.clear();
+    m_usage = 0;
+}
+
+int FrameCache::nextMissing(int position, int direction, int range, int maxPosition) const
+{
+    QMutexLocker lk(&m_mutex);
+    for (int i = 1; i <= range; ++i) {
+        int pos = position + direction * i;
+        if (pos < 0 || pos > maxPosition) {
+            break;
+        }
+        if (m_frames.count(pos) == 0) {
+            return pos;
+        }
+    }
+    return -1;
+}
+
+qint64 FrameCache::frameCost(const SharedFrame &frame)
+{
+    return qint64(mlt_image_format_size(frame.get_image_format(), frame.get_image_width(), frame.get_image_height(), nullptr));
+}
+
+void FrameCache::evict()
+{
+    // The frames furthest from the last requested position are at one of the ends of the map
+    while (m_usage > m_budget && !m_frames.empty()) {
+        auto first = m_frames.begin();
+        auto last = std::prev(m_frames.end());
+        auto victim = (m_lastPosition - first->first) >= (last->first - m_lastPosition) ? first : last;
+        m_usage -= victim->second.second;
+        m_frames.erase(victim);
+    }
+}
@@ -0,0 +1,63 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include "scopes/sharedframe.h"
+
+#include <QMutex>
+#include <QtGlobal>
+
+#include <map>
+
+/** @class FrameCache
+    @brief A byte budgeted cache of the frames rendered by the project monitor, keyed by timeline position.
+    Scrubbing back and forth over the same region then displays the cached frames instead of rendering them again.
+    Each invalidation increments the cache version: a frame is inserted with the version that was current when it was
+    requested, so that a frame rendered before a timeline change cannot enter the cache after it.
+    When the budget is exceeded, the frames furthest away from the last requested position are dropped first.
+    This class is thread safe.
+ */
+class FrameCache
+{
+public:
+    explicit FrameCache(qint64 budget = 0);
+
+    /** @brief Set the maximum memory used by the cached frames in bytes, 0 disables the cache */
+    void setBudget(qint64 bytes);
+    qint64 budget() const;
+    /** @brief Memory used by the cached frames in bytes */
+    qint64 usage() const;
+    int count() const;
+    /** @brief The current version, to pass to insert() for frames requested now */
+    quint64 version() const;
+
+    /** @brief Returns the cached frame at @param position, or an invalid frame. The position is used as reference for eviction */
+    SharedFrame frame(int position);
+    bool contains(int position) const;
+    /** @brief Store a rendered frame. Returns false if the cache was invalidated since @param version was read or the frame is too large */
+    bool insert(int position, const SharedFrame &frame, quint64 version);
+    /** @brief Drop the frames in the range [in, out] */
+    void invalidate(int in, int out);
+    /** @brief Drop all frames */
+    void clear();
+    /** @brief Returns the first position that is not cached when moving from @param position in @param direction (1 or -1),
+       at most @param range frames away and inside [0, maxPosition], or -1 if all these frames are cached */
+    int nextMissing(int position, int direction, int range, int maxPosition) const;
+
+    /** @brief Memory used by the image of a frame */
+    static qint64 frameCost(const SharedFrame &frame);
+
+private:
+    mutable QMutex m_mutex;
+    std::map<int, std::pair<SharedFrame, qint64>> m_frames;
+    qint64 m_budget;
+    qint64 m_usage;
+    quint64 m_version;
+    int m_lastPosition;
+
+    void evict();
+};
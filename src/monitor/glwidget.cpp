@@ -90,6 +90,17 @@ GLWidget::GLWidget(int id, QWidget *parent)
     , m_isLoopMode(false)
     , m_loopIn(0)
     , m_offset(QPoint(0, 0))
+    , m_prefetchPosition(-1)
+    , m_prefetchVersion(0)
+    , m_requestVersion(0)
+    , m_prefetchActive(false)
+    , m_prefetchMoved(false)
+    , m_lastSeekPosition(0)
+    , m_scrubDirection(1)
+    , m_scrubScaled(false)
+    , m_seekInFlight(false)
+    , m_pendingSeek(-1)
+    , m_pendingNoAudioScrub(false)
     , m_fbo(nullptr)
     , m_shareContext(nullptr)
     , m_openGLSync(false)
@@ -124,6 +135,9 @@ GLWidget::GLWidget(int id, QWidget *parent)
 
     m_refreshTimer.setSingleShot(true);
     m_refreshTimer.setInterval(10);
+    m_settleTimer.setSingleShot(true);
+    m_settleTimer.setInterval(200);
+    connect(&m_settleTimer, &QTimer::timeout, this, &GLWidget::refineScrub);
     m_blackClip.reset(new Mlt::Producer(pCore->getCurrentProfile()->profile(), "color:0"));
     m_blackClip->set("kdenlive:id", "black");
     m_blackClip->set("out", 3);
@@ -133,6 +147,14 @@ GLWidget::GLWidget(int id, QWidget *parent)
     if (!initGPUAccel()) {
         disableGPUAccel();
     }
+    if (m_id == Kdenlive::ProjectMonitor && m_glslManager == nullptr) {
+        // GPU frames only live in textures, so they cannot be cached
+        m_frameCache.reset(new FrameCache(qint64(KdenliveSettings::monitorcachesize()) * 1024 * 1024));
+        // Wait until the user stops requesting frames before prefetching
+        m_prefetchTimer.setSingleShot(true);
+        m_prefetchTimer.setInterval(100);
+        connect(&m_prefetchTimer, &QTimer::timeout, this, &GLWidget::prefetchNext);
+    }
 
     connect(quickWindow(), &QQuickWindow::sceneGraphInitialized, this, &GLWidget::initializeGL, Qt::DirectConnection);
     connect(quickWindow(), &QQuickWindow::beforeRendering, this, &GLWidget::paintGL, Qt::DirectConnection);
@@ -645,6 +667,44 @@ bool GLWidget::isReady() const
 
 void GLWidget::requestSeek(int position, bool noAudioScrub)
 {
+    if (m_producer && qFuzzyIsNull(m_producer->get_speed())) {
+        if (KdenliveSettings::adaptivescrubbing() && m_seekInFlight && m_seekTimer.elapsed() < 1000) {
+            // Seeks arrive faster than frames are rendered: only keep the last position and render at a lower resolution
+            m_pendingSeek = position;
+            m_pendingNoAudioScrub = noAudioScrub;
+            setScrubScaling(true);
+            m_settleTimer.start();
+            return;
+        }
+        m_seekInFlight = true;
+        m_seekTimer.start();
+        if (m_scrubScaled) {
+            m_settleTimer.start();
+        }
+    }
+    if (m_frameCache) {
+        stopPrefetch();
+        // A pending prefetch of the requested frame has to be displayed
+        m_prefetchPosition.testAndSetOrdered(position, -1);
+        if (position != m_lastSeekPosition) {
+            m_scrubDirection = position > m_lastSeekPosition ? 1 : -1;
+        }
+        m_lastSeekPosition = position;
+        m_frameCache->setBudget(qint64(KdenliveSettings::monitorcachesize()) * 1024 * 1024);
+        if (qFuzzyIsNull(m_producer->get_speed())) {
+            SharedFrame frame = m_frameCache->frame(position);
+            if (frame.is_valid() && m_frameRenderer != nullptr && m_frameRenderer->semaphore()->tryAcquire()) {
+                // The frame was already rendered, display it without waiting for the consumer
+                QMetaObject::invokeMethod(m_frameRenderer, "showCachedFrame", Qt::QueuedConnection, Q_ARG(SharedFrame, frame));
+                if (!KdenliveSettings::audio_scrub() || noAudioScrub) {
+                    m_producer->seek(position);
+                    return;
+                }
+                // The consumer still has to play the scrub audio
+            }
+        }
+        m_requestVersion = m_frameCache->version();
+    }
     if(KdenliveSettings::audio_scrub() && !noAudioScrub){
         m_consumer->set("scrub_audio", 1);
     } else {
@@ -675,6 +735,12 @@ void GLWidget::refresh()
 {
     m_refreshTimer.stop();
     QMutexLocker locker(&m_mltMutex);
+    if (m_frameCache) {
+        stopPrefetch();
+        // Something changed in the current frame
+        m_frameCache->invalidate(m_proxy->getPosition(), m_proxy->getPosition());
+        m_requestVersion = m_frameCache->version();
+    }
     if (m_consumer) {
         restartConsumer();
         m_consumer->set("refresh", 1);
@@ -923,6 +989,16 @@ int GLWidget::setProducer(const std::shared_ptr<Mlt::Producer> &producer, bool i
     if (m_consumer) {
         consumerPosition = m_consumer->position();
     }
+    if (m_frameCache) {
+        stopPrefetch();
+        m_prefetchPosition = -1;
+        m_frameCache->clear();
+    }
+    m_settleTimer.stop();
+    m_pendingSeek = -1;
+    m_seekInFlight = false;
+    m_scrubScaled = false;
+    m_proxy->setScrubScaled(false);
     stop();
     if (producer) {
         m_producer = producer;
@@ -1304,6 +1380,115 @@ void GLWidget::onFrameDisplayed(const SharedFrame &frame)
     m_sendFrame = sendFrameForAnalysis;
     m_contextSharedAccess.unlock();
     quickWindow()->update();
+    if (m_seekInFlight) {
+        m_seekInFlight = false;
+        m_proxy->setFrameLatency(int(m_seekTimer.elapsed()));
+        if (m_pendingSeek > -1) {
+            int position = m_pendingSeek;
+            m_pendingSeek = -1;
+            requestSeek(position, m_pendingNoAudioScrub);
+            return;
+        }
+    }
+    if (m_frameCache && qFuzzyIsNull(m_producer->get_speed())) {
+        m_lastSeekPosition = frame.get_position();
+        // Don't cache the reduced frames of adaptive scrubbing
+        if (frame.get_image_width() == m_profileSize.width()) {
+            m_frameCache->insert(frame.get_position(), frame, quint64(frame.get_int64("kdenlive:cacheversion")));
+        }
+        if (!m_scrubScaled) {
+            m_prefetchTimer.start();
+        }
+    }
+}
+
+void GLWidget::setScrubScaling(bool scaled)
+{
+    if (scaled == m_scrubScaled || !m_consumer) {
+        return;
+    }
+    m_scrubScaled = scaled;
+    int width = m_profileSize.width();
+    int height = m_profileSize.height();
+    if (scaled) {
+        // Keep even dimensions for yuv formats
+        width = qMax(16, width / 8 * 2);
+        height = qMax(16, height / 8 * 2);
+    }
+    m_consumer->set("width", width);
+    m_consumer->set("height", height);
+    // Make sure the consumer runs so that the next requested frame uses the new size. The frame itself is requested by the
+    // caller: the pending seek when scaling down, refineScrub when going back to full resolution
+    restartConsumer();
+    m_proxy->setScrubScaled(scaled);
+}
+
+void GLWidget::refineScrub()
+{
+    if (!m_scrubScaled) {
+        return;
+    }
+    if (m_pendingSeek > -1 || (m_seekInFlight && m_seekTimer.elapsed() < 1000)) {
+        // Still scrubbing
+        m_settleTimer.start();
+        return;
+    }
+    setScrubScaling(false);
+    if (m_consumer && qFuzzyIsNull(m_producer->get_speed())) {
+        if (m_frameCache) {
+            m_requestVersion = m_frameCache->version();
+        }
+        m_consumer->set("refresh", 1);
+    }
+}
+
+void GLWidget::invalidateFrameCache(int in, int out)
+{
+    if (!m_frameCache) {
+        return;
+    }
+    if (in < 0) {
+        m_frameCache->clear();
+    } else {
+        m_frameCache->invalidate(in, out < 0 ? m_maxProducerPosition : out);
+    }
+}
+
+void GLWidget::stopPrefetch()
+{
+    m_prefetchTimer.stop();
+    m_prefetchActive = false;
+    if (m_prefetchMoved) {
+        m_prefetchMoved = false;
+        m_producer->seek(m_lastSeekPosition);
+    }
+}
+
+void GLWidget::prefetchNext()
+{
+    if (!m_frameCache || !m_consumer || !qFuzzyIsNull(m_producer->get_speed()) || m_frameCache->budget() == 0) {
+        return;
+    }
+    // Don't prefetch more frames than half of the budget can hold, or prefetching would evict its own frames
+    int range = 25;
+    int count = m_frameCache->count();
+    if (count > 0) {
+        qint64 averageCost = qMax(qint64(1), m_frameCache->usage() / count);
+        range = int(qMin(qint64(range), m_frameCache->budget() / averageCost / 2));
+    }
+    int position = m_frameCache->nextMissing(m_lastSeekPosition, m_scrubDirection, range, m_maxProducerPosition);
+    if (position < 0) {
+        stopPrefetch();
+        return;
+    }
+    m_prefetchActive = true;
+    m_prefetchMoved = true;
+    m_prefetchVersion = m_frameCache->version();
+    m_prefetchPosition = position;
+    m_consumer->set("scrub_audio", 0);
+    m_producer->seek(position);
+    restartConsumer();
+    m_consumer->set("refresh", 1);
 }
 
 void GLWidget::mouseReleaseEvent(QMouseEvent *event)
@@ -1397,6 +1582,18 @@ void GLWidget::on_frame_show(mlt_consumer, GLWidget* widget, mlt_event_data data
 {
     auto frame = Mlt::EventData(data).to_frame();
     if (frame.is_valid() && frame.get_int("rendered")) {
+        if (widget->m_frameCache) {
+            if (widget->m_prefetchPosition.testAndSetOrdered(frame.get_position(), -1)) {
+                // Prefetched frame, store it without displaying it
+                widget->m_frameCache->insert(frame.get_position(), SharedFrame(frame), widget->m_prefetchVersion);
+                if (widget->m_prefetchActive) {
+                    QMetaObject::invokeMethod(widget, "prefetchNext", Qt::QueuedConnection);
+                }
+                return;
+            }
+            // Use the version of the request, the cache may have been invalidated while the frame was rendered
+            frame.set("kdenlive:cacheversion", int64_t(widget->m_requestVersion.load()));
+        }
         int timeout = (widget->consumer()->get_int("real_time") > 0) ? 0 : 1000;
         if ((widget->m_frameRenderer != nullptr) && widget->m_frameRenderer->semaphore()->tryAcquire(1, timeout)) {
             QMetaObject::invokeMethod(widget->m_frameRenderer, "showFrame", Qt::QueuedConnection, Q_ARG(Mlt::Frame, frame));
@@ -1497,8 +1694,12 @@ FrameRenderer::~FrameRenderer()
 void FrameRenderer::showFrame(Mlt::Frame frame)
 {
     // Save this frame for future use and to keep a reference to the GL Texture.
-    m_displayFrame = SharedFrame(frame);
+    showCachedFrame(SharedFrame(frame));
+}
 
+void FrameRenderer::showCachedFrame(const SharedFrame &frame)
+{
+    m_displayFrame = frame;
     if ((m_context != nullptr) && m_context->isValid()) {
         m_context->makeCurrent(m_surface);
         // Upload each plane of YUV to a texture.
@@ -1614,6 +1815,14 @@ void GLWidget::switchPlay(bool play, int offset, double speed)
     if (!m_producer || !m_consumer) {
         return;
     }
+    if (m_frameCache) {
+        stopPrefetch();
+        m_prefetchPosition = -1;
+    }
+    m_settleTimer.stop();
+    m_pendingSeek = -1;
+    m_seekInFlight = false;
+    setScrubScaling(false);
     if (m_isZoneMode || m_isLoopMode) {
         resetZoneMode();
     }
@@ -1865,6 +2074,10 @@ bool GLWidget::updateScaling()
         return false;
     }
     m_profileSize = profileSize;
+    m_scrubScaled = false;
+    m_proxy->setScrubScaled(false);
+    // Cached frames have the previous size
+    invalidateFrameCache();
     pCore->getMonitorProfile().set_width(m_profileSize.width());
     pCore->getMonitorProfile().set_height(m_profileSize.height());
     if (m_consumer) {
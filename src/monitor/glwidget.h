@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <QElapsedTimer>
 #include <QFont>
 #include <QMutex>
 #include <QOffscreenSurface>
@@ -22,11 +23,15 @@
 
 #include "bin/model/markerlistmodel.hpp"
 #include "definitions.h"
+#include "framecache.h"
 #include "kdenlivesettings.h"
 #include "scopes/sharedframe.h"
 
 #include <mlt++/MltProfile.h>
 
+#include <atomic>
+#include <memory>
+
 class QOpenGLFunctions_3_2_Core;
 
 namespace Mlt {
@@ -127,6 +132,8 @@ public:
     void switchRuler(bool show);
     /** @brief Returns true if consumer is initialized */
     bool isReady() const;
+    /** @brief Drop the cached frames in the range [in, out], or all cached frames if @param in is -1 */
+    void invalidateFrameCache(int in = -1, int out = -1);
 
 protected:
     void mouseReleaseEvent(QMouseEvent *event) override;
@@ -233,6 +240,37 @@ private:
     static void on_frame_render(mlt_consumer, GLWidget *widget, mlt_frame frame);
     static void on_gl_frame_show(mlt_consumer, GLWidget *widget, mlt_event_data data);
     static void on_gl_nosync_frame_show(mlt_consumer, GLWidget *widget, mlt_event_data data);
+    /** @brief Cache of the rendered frames, only used by the project monitor without GPU processing */
+    std::unique_ptr<FrameCache> m_frameCache;
+    /** @brief The position of the frame currently rendered for the cache without being displayed, -1 if none */
+    QAtomicInt m_prefetchPosition;
+    /** @brief The cache version when the prefetched frame was requested */
+    std::atomic<quint64> m_prefetchVersion;
+    /** @brief The cache version when the displayed frame was requested */
+    std::atomic<quint64> m_requestVersion;
+    /** @brief True while frames are prefetched, that is until the next seek or play request */
+    std::atomic<bool> m_prefetchActive;
+    /** @brief True if the producer was seeked away from the displayed frame to prefetch */
+    bool m_prefetchMoved;
+    /** @brief The last displayed position when paused, prefetching starts from there */
+    int m_lastSeekPosition;
+    /** @brief 1 when scrubbing forwards, -1 backwards */
+    int m_scrubDirection;
+    QTimer m_prefetchTimer;
+    /** @brief Stop prefetching and seek the producer back to the displayed frame if needed */
+    void stopPrefetch();
+    /** @brief True while the consumer renders at a reduced resolution because seeks arrive faster than frames are rendered */
+    bool m_scrubScaled;
+    /** @brief True between a seek request and the display of its frame */
+    bool m_seekInFlight;
+    /** @brief The last seek requested while a frame was being rendered, -1 if none */
+    int m_pendingSeek;
+    bool m_pendingNoAudioScrub;
+    QElapsedTimer m_seekTimer;
+    /** @brief Restores the full resolution once the seeks stop */
+    QTimer m_settleTimer;
+    /** @brief Switch the consumer between the preview resolution and a quarter of it */
+    void setScrubScaling(bool scaled);
     QOpenGLFramebufferObject *m_fbo;
     void refreshSceneLayout();
     void resetZoneMode();
@@ -248,6 +286,10 @@ private slots:
     void onFrameDisplayed(const SharedFrame &frame);
     int reconfigure();
     void refresh();
+    /** @brief Render the next frame that is not cached in the scrub direction */
+    void prefetchNext();
+    /** @brief Render the current frame at full resolution after adaptive scrubbing */
+    void refineScrub();
 
 protected:
     QMutex m_contextSharedAccess;
@@ -315,6 +357,8 @@ public:
     Q_INVOKABLE void showFrame(Mlt::Frame frame);
     Q_INVOKABLE void showGLFrame(Mlt::Frame frame);
     Q_INVOKABLE void showGLNoSyncFrame(Mlt::Frame frame);
+    /** @brief Display a frame from the monitor's frame cache */
+    Q_INVOKABLE void showCachedFrame(const SharedFrame &frame);
 
 public slots:
     void cleanup();
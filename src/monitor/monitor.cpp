@@ -2572,6 +2572,11 @@ void Monitor::purgeCache()
     m_glMonitor->purgeCache();
 }
 
+void Monitor::invalidateFrameCache(int in, int out)
+{
+    m_glMonitor->invalidateFrameCache(in, out);
+}
+
 void Monitor::updateBgColor()
 {
     m_glMonitor->m_bgColor = KdenliveSettings::window_background();
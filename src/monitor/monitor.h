@@ -336,6 +336,8 @@ public slots:
     void forceMonitorRefresh();
     /** @brief Clear read ahead cache, to ensure up to date audio */
     void purgeCache();
+    /** @brief Drop the rendered frames cached for the range [in, out], or all of them if @param in is -1 */
+    void invalidateFrameCache(int in = -1, int out = -1);
     void seekTimeline(const QString &frameAndTrack);
 
 signals:
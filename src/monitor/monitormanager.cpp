@@ -110,6 +110,7 @@ void MonitorManager::focusProjectMonitor()
 
 void MonitorManager::refreshProjectRange(QPair<int, int> range)
 {
+    m_projectMonitor->invalidateFrameCache(range.first, range.second);
     if (m_projectMonitor->position() >= range.first && m_projectMonitor->position() <= range.second) {
         m_projectMonitor->refreshMonitorIfActive();
     }
@@ -29,6 +29,8 @@ MonitorProxy::MonitorProxy(GLWidget *parent)
     , m_zoneOut(-1)
     , m_hasAV(false)
     , m_speed(0)
+    , m_frameLatency(0)
+    , m_scrubScaled(false)
     , m_clipType(0)
     , m_clipId(-1)
     , m_seekFinished(true)
@@ -444,6 +446,27 @@ void MonitorProxy::setSpeed(double speed)
     }
 }
 
+void MonitorProxy::setFrameLatency(int ms)
+{
+    if (m_frameLatency != ms) {
+        m_frameLatency = ms;
+        emit frameLatencyChanged();
+    }
+}
+
+int MonitorProxy::frameLatency() const
+{
+    return m_frameLatency;
+}
+
+void MonitorProxy::setScrubScaled(bool scaled)
+{
+    if (m_scrubScaled != scaled) {
+        m_scrubScaled = scaled;
+        emit scrubScaledChanged();
+    }
+}
+
 QByteArray MonitorProxy::getUuid() const
 {
     return QUuid::createUuid().toByteArray();
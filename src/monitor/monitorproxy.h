@@ -39,6 +39,12 @@ class MonitorProxy : public QObject
     Q_PROPERTY(int clipBounds MEMBER m_boundsCount NOTIFY clipBoundsChanged)
     Q_PROPERTY(int overlayType READ overlayType WRITE setOverlayType NOTIFY overlayTypeChanged)
     Q_PROPERTY(double speed MEMBER m_speed NOTIFY speedChanged)
+    /** @brief Time in milliseconds between the last seek request and the display of its first frame
+     * */
+    Q_PROPERTY(int frameLatency MEMBER m_frameLatency NOTIFY frameLatencyChanged)
+    /** @brief True while frames are rendered at a reduced resolution because of fast scrubbing
+     * */
+    Q_PROPERTY(bool scrubScaled MEMBER m_scrubScaled NOTIFY scrubScaledChanged)
     Q_PROPERTY(QColor thumbColor1 READ thumbColor1 NOTIFY colorsChanged)
     Q_PROPERTY(QColor thumbColor2 READ thumbColor2 NOTIFY colorsChanged)
     Q_PROPERTY(QColor overlayColor READ overlayColor NOTIFY colorsChanged)
@@ -124,6 +130,10 @@ public:
     void resetPosition();
     /** @brief Used to display qml info about speed*/
     void setSpeed(double speed);
+    /** @brief Store the time to first frame of the last seek */
+    void setFrameLatency(int ms);
+    int frameLatency() const;
+    void setScrubScaled(bool scaled);
 
 signals:
     void positionChanged(int);
@@ -157,6 +167,8 @@ signals:
     void trimmingTC1Changed();
     void trimmingTC2Changed();
     void speedChanged();
+    void frameLatencyChanged();
+    void scrubScaledChanged();
     void clipBoundsChanged();
     void addTimelineEffect(const QStringList &);
 
@@ -167,6 +179,8 @@ private:
     int m_zoneOut;
     bool m_hasAV;
     double m_speed;
+    int m_frameLatency;
+    bool m_scrubScaled;
     QList <int> m_audioStreams;
     QList <int> m_audioChannels;
     QString m_markerComment;
@@ -45,6 +45,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QMimeType>
 #include <QProgressDialog>
 #include <QTimeZone>
+#include <QtConcurrent>
 #include <audiomixer/mixermanager.hpp>
 #include <lib/localeHandling.h>
 
@@ -85,6 +86,7 @@ ProjectManager::ProjectManager(QObject *parent)
 
     m_autoSaveTimer.setSingleShot(true);
     connect(&m_autoSaveTimer, &QTimer::timeout, this, &ProjectManager::slotAutoSave);
+    connect(&m_autoSaveWatcher, &QFutureWatcher<bool>::finished, this, &ProjectManager::slotAutoSaveFinished);
 
     // Ensure the default data folder exist
     QDir dir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
@@ -284,6 +286,8 @@ bool ProjectManager::closeCurrentDocument(bool saveChanges, bool quit)
 {
     // Disable autosave
     m_autoSaveTimer.stop();
+    m_autoSavePending = false;
+    m_autoSaveWatcher.waitForFinished();
     if ((m_project != nullptr) && m_project->isModified() && saveChanges) {
         QString message;
         if (m_project->url().fileName().isEmpty()) {
@@ -652,7 +656,10 @@ void ProjectManager::doOpenFile(const QUrl &url, KAutoSaveFile *stale)
         emit pCore->loadingMessageUpdated(QString(), 0, doc->clipsCount());
     }
 
+    QElapsedTimer phaseTimer;
+    phaseTimer.start();
     pCore->bin()->setDocument(doc);
+    doc->recordOpenPhase(QStringLiteral("bin"), phaseTimer.elapsed());
 
     // Set default target tracks to upper audio / lower video tracks
     m_project = doc;
@@ -666,6 +673,7 @@ void ProjectManager::doOpenFile(const QUrl &url, KAutoSaveFile *stale)
     pCore->window()->connectDocument();
     pCore->mixer()->setModel(m_mainTimelineModel);
     m_mainTimelineModel->updateFieldOrderFilter(pCore->getCurrentProfile());
+    qCDebug(KDENLIVE_LOG) << "Project opened in" << m_project->openTimings();
     emit docOpened(m_project);
     pCore->displayMessage(QString(), OperationCompletedMessage, 100);
     if (openBackup) {
@@ -749,27 +757,64 @@ void ProjectManager::slotStartAutoSave()
 
 void ProjectManager::slotAutoSave()
 {
+    if (m_project == nullptr || m_project->m_autosave == nullptr) {
+        return;
+    }
+    if (m_autoSaveWatcher.isRunning()) {
+        // Coalesce with the save in progress, we will save again once it is done
+        m_autoSavePending = true;
+        return;
+    }
     prepareSave();
     QString saveFolder = m_project->url().adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile();
-    QString scene = projectSceneList(saveFolder);
-    if (!m_replacementPattern.isEmpty()) {
-        QMapIterator<QString, QString> i(m_replacementPattern);
-        while (i.hasNext()) {
-            i.next();
-            scene.replace(i.key(), i.value());
-        }
-    }
+    // The playlist is always serialized on the GUI thread: MLT services are shared with the playback and the locale is global,
+    // there is no cheap copy of the timeline that could be serialized from another thread.
+    const QString scene = projectSceneList(saveFolder);
     if (!scene.contains(QLatin1String("<track "))) {
         // In some unexplained cases, the MLT playlist is corrupted and all tracks are deleted. Don't save in that case.
         pCore->displayMessage(i18n("Project was corrupted, cannot backup. Please close and reopen your project file to recover last backup"), ErrorMessage);
+        m_lastSave.start();
         return;
     }
-    m_project->slotAutoSave(scene);
+    const QMap<QString, QString> replacements = m_replacementPattern;
+    if (!KdenliveSettings::backgroundautosave()) {
+        if (!m_project->writeAutoSave(autoSaveData(scene, replacements))) {
+            pCore->displayMessage(i18n("Cannot create autosave file %1", m_project->m_autosave->fileName()), ErrorMessage);
+        }
+        m_lastSave.start();
+        return;
+    }
+    // The path replacements, the UTF-8 conversion and the file write only use the serialized data, run them in a background thread
+    KdenliveDoc *doc = m_project;
+    m_autoSaveWatcher.setFuture(QtConcurrent::run([doc, scene, replacements]() { return doc->writeAutoSave(autoSaveData(scene, replacements)); }));
+}
+
+void ProjectManager::slotAutoSaveFinished()
+{
+    if (!m_autoSaveWatcher.result() && m_project != nullptr && m_project->m_autosave != nullptr) {
+        pCore->displayMessage(i18n("Cannot create autosave file %1", m_project->m_autosave->fileName()), ErrorMessage);
+    }
     m_lastSave.start();
+    if (m_autoSavePending) {
+        m_autoSavePending = false;
+        slotStartAutoSave();
+    }
+}
+
+QByteArray ProjectManager::autoSaveData(QString scene, const QMap<QString, QString> &replacements)
+{
+    QMapIterator<QString, QString> i(replacements);
+    while (i.hasNext()) {
+        i.next();
+        scene.replace(i.key(), i.value());
+    }
+    return scene.toUtf8();
 }
 
 QString ProjectManager::projectSceneList(const QString &outputFolder, const QString &overlayData)
 {
+    // Let a background autosave write finish, callers may modify the autosave file afterwards
+    m_autoSaveWatcher.waitForFinished();
     // Disable multitrack view and overlay
     bool isMultiTrack = pCore->monitorManager()->isMultiTrack();
     bool hasPreview = pCore->window()->getMainTimeline()->controller()->hasPreviewTrack();
@@ -984,8 +1029,11 @@ bool ProjectManager::updateTimeline(int pos, const QString &chunks, const QStrin
     pCore->window()->getMainTimeline()->loading = true;
     pCore->window()->slotSwitchTimelineZone(m_project->getDocumentProperty(QStringLiteral("enableTimelineZone")).toInt() == 1);
 
+    QElapsedTimer phaseTimer;
+    phaseTimer.start();
     QScopedPointer<Mlt::Producer> xmlProd(new Mlt::Producer(pCore->getCurrentProfile()->profile(), "xml-string",
                                                             m_project->getAndClearProjectXml().constData()));
+    m_project->recordOpenPhase(QStringLiteral("mlt"), phaseTimer.restart());
 
     Mlt::Service s(*xmlProd);
     Mlt::Tractor tractor(s);
@@ -1014,6 +1062,7 @@ bool ProjectManager::updateTimeline(int pos, const QString &chunks, const QStrin
         //TODO: act on project load failure
         qDebug()<<"// Project failed to load!!";
     }
+    m_project->recordOpenPhase(QStringLiteral("timeline"), phaseTimer.elapsed());
     // Free memory used by original playlist
     xmlProd.reset(nullptr);
     const QString groupsData = m_project->getDocumentProperty(QStringLiteral("groups"));
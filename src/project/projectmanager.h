@@ -8,6 +8,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kdenlivecore_export.h"
 #include <KRecentFilesAction>
 #include <QDir>
+#include <QFutureWatcher>
 #include <QObject>
 #include <QTime>
 #include <QTimer>
@@ -183,6 +184,8 @@ private slots:
     bool slotOpenBackup(const QUrl &url = QUrl());
     /** @brief Start autosaving the document. */
     void slotAutoSave();
+    /** @brief A background autosave write finished, report errors and start the next one if changes happened meanwhile. */
+    void slotAutoSaveFinished();
     /** @brief Report progress of folder move operation. */
     void slotMoveProgress(KJob *, unsigned long progress);
     void slotMoveFinished(KJob *job);
@@ -197,11 +200,18 @@ protected:
 private:
     /** @brief checks if autoback files exists, recovers from it if user says yes, returns true if files were recovered. */
     bool checkForBackupFile(const QUrl &url, bool newFile = false);
+    /** @brief Apply the @param replacements patterns to @param scene and return the data to write in the autosave file.
+     *  Can be called from a background thread */
+    static QByteArray autoSaveData(QString scene, const QMap<QString, QString> &replacements);
 
     KdenliveDoc *m_project{nullptr};
     std::shared_ptr<TimelineItemModel> m_mainTimelineModel;
     QElapsedTimer m_lastSave;
     QTimer m_autoSaveTimer;
+    /** @brief Watches the autosave file write running in a background thread */
+    QFutureWatcher<bool> m_autoSaveWatcher;
+    /** @brief True if an autosave was requested while the previous one was still running */
+    bool m_autoSavePending{false};
     QUrl m_startUrl;
     QString m_loadClipsOnOpen;
     QMap<QString, QString> m_replacementPattern;
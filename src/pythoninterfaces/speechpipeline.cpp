@@ -0,0 +1,329 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "speechpipeline.h"
+#include "kdenlive_debug.h"
+#include "kdenlivesettings.h"
+#include "speechtotext.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+
+namespace {
+/// Distance in seconds around a chunk's theoretical end in which we look for a silence
+const double silenceSearchWindow = 10.;
+/// Number of frames averaged to find a silence
+const int silenceFrames = 5;
+const int speechCacheVersion = 1;
+} // namespace
+
+SpeechPipeline::SpeechPipeline(SpeechToText *stt, QObject *parent)
+    : QObject(parent)
+    , m_stt(stt)
+{
+}
+
+SpeechPipeline::~SpeechPipeline()
+{
+    m_aborted = true;
+    for (auto &chunk : m_chunks) {
+        if (chunk->process && chunk->process->state() != QProcess::NotRunning) {
+            chunk->process->disconnect(this);
+            chunk->process->kill();
+            chunk->process->waitForFinished();
+        }
+    }
+}
+
+QList<QJsonObject> SpeechPipeline::takeJsonObjects(QByteArray &buffer)
+{
+    QList<QJsonObject> objects;
+    int depth = 0;
+    int objectStart = -1;
+    int consumed = 0;
+    bool inString = false;
+    bool escaped = false;
+    for (int i = 0; i < buffer.size(); ++i) {
+        char c = buffer.at(i);
+        if (inString) {
+            if (escaped) {
+                escaped = false;
+            } else if (c == '\\') {
+                escaped = true;
+            } else if (c == '"') {
+                inString = false;
+            }
+            continue;
+        }
+        if (c == '"') {
+            inString = true;
+        } else if (c == '{') {
+            if (depth == 0) {
+                objectStart = i;
+            }
+            depth++;
+        } else if (c == '}' && depth > 0) {
+            depth--;
+            if (depth == 0) {
+                QJsonParseError error;
+                auto doc = QJsonDocument::fromJson(buffer.mid(objectStart, i - objectStart + 1), &error);
+                if (doc.isObject()) {
+                    objects << doc.object();
+                } else {
+                    qCWarning(KDENLIVE_LOG) << "Invalid speech recognition output:" << error.errorString();
+                }
+                consumed = i + 1;
+            }
+        } else if (depth == 0) {
+            // Data outside of objects, like progress info
+            consumed = i + 1;
+        }
+    }
+    buffer.remove(0, consumed);
+    return objects;
+}
+
+QVector<QPair<double, double>> SpeechPipeline::splitAtSilences(const QVector<uint8_t> &levels, int channels, double fps, double start, double duration,
+                                                               double chunkLength)
+{
+    QVector<QPair<double, double>> chunks;
+    channels = qMax(1, channels);
+    const int frameCount = levels.size() / channels;
+    const double end = start + duration;
+    double pos = start;
+    // Don't create a last chunk shorter than half a chunk
+    while (end - pos > chunkLength * 1.5) {
+        double cut = pos + chunkLength;
+        if (frameCount > silenceFrames && fps > 0.) {
+            int first = qMax(0, int((cut - silenceSearchWindow) * fps));
+            int last = qMin(frameCount - silenceFrames, int((cut + silenceSearchWindow) * fps));
+            int target = int(cut * fps);
+            int bestFrame = -1;
+            int bestLevel = 0;
+            for (int frame = first; frame <= last; ++frame) {
+                int level = 0;
+                for (int i = frame * channels; i < (frame + silenceFrames) * channels; ++i) {
+                    level += levels.at(i);
+                }
+                if (bestFrame == -1 || level < bestLevel || (level == bestLevel && qAbs(frame - target) < qAbs(bestFrame - target))) {
+                    bestFrame = frame;
+                    bestLevel = level;
+                }
+            }
+            if (bestFrame > -1) {
+                // Cut in the middle of the quiet frames
+                cut = qBound(pos + 1., (bestFrame + silenceFrames / 2.) / fps, end - 1.);
+            }
+        }
+        chunks << QPair<double, double>(pos, cut - pos);
+        pos = cut;
+    }
+    chunks << QPair<double, double>(pos, end - pos);
+    return chunks;
+}
+
+int SpeechPipeline::workerCount()
+{
+    if (KdenliveSettings::speech_workers() > 0) {
+        return KdenliveSettings::speech_workers();
+    }
+    // Each recognizer loads its own copy of the model, so don't use all cores by default
+    return qBound(1, QThread::idealThreadCount() / 2, 4);
+}
+
+void SpeechPipeline::start(const QString &source, const QString &modelDirectory, const QString &language, const QVector<QPair<double, double>> &chunks)
+{
+    abort();
+    for (auto &chunk : m_chunks) {
+        if (chunk->process && chunk->process->state() != QProcess::NotRunning) {
+            chunk->process->disconnect(this);
+            chunk->process->waitForFinished();
+        }
+    }
+    m_source = source;
+    m_modelDirectory = modelDirectory;
+    m_language = language;
+    m_chunks.clear();
+    m_results = QJsonArray();
+    m_nextStart = 0;
+    m_nextEmit = 0;
+    m_running = 0;
+    m_aborted = false;
+    m_workers = workerCount();
+    for (const auto &zone : chunks) {
+        auto chunk = std::make_unique<Chunk>();
+        chunk->start = zone.first;
+        chunk->duration = zone.second;
+        m_chunks.push_back(std::move(chunk));
+    }
+    qCDebug(KDENLIVE_LOG) << "Starting speech recognition on" << m_chunks.size() << "chunks with" << m_workers << "workers";
+    emit progress(0);
+    startChunks();
+}
+
+void SpeechPipeline::startChunks()
+{
+    while (!m_aborted && m_running < m_workers && m_nextStart < m_chunks.size()) {
+        Chunk *chunk = m_chunks.at(m_nextStart).get();
+        m_nextStart++;
+        chunk->process = std::make_unique<QProcess>();
+        connect(chunk->process.get(), &QProcess::readyReadStandardOutput, this, [this, chunk]() { readOutput(chunk); });
+        connect(chunk->process.get(), &QProcess::readyReadStandardError, this,
+                [this, chunk]() { emit errorOutput(QString::fromUtf8(chunk->process->readAllStandardError())); });
+        connect(chunk->process.get(), static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this,
+                [this, chunk](int exitCode, QProcess::ExitStatus status) { chunkFinished(chunk, exitCode, status); });
+        m_running++;
+        chunk->process->start(m_stt->pythonExec(), {m_stt->speechScript(), m_modelDirectory, m_language, m_source, QString::number(chunk->start),
+                                                     QString::number(chunk->duration)});
+    }
+}
+
+void SpeechPipeline::readOutput(Chunk *chunk)
+{
+    chunk->buffer.append(chunk->process->readAllStandardOutput());
+    const QList<QJsonObject> objects = takeJsonObjects(chunk->buffer);
+    if (objects.isEmpty()) {
+        return;
+    }
+    for (const auto &obj : objects) {
+        chunk->results << obj;
+        QJsonArray words = obj.value(QLatin1String("result")).toArray();
+        if (!words.isEmpty()) {
+            chunk->processed = qMin(chunk->duration, words.last().toObject().value(QLatin1String("end")).toDouble());
+        }
+    }
+    flushResults();
+    updateProgress();
+}
+
+void SpeechPipeline::chunkFinished(Chunk *chunk, int exitCode, QProcess::ExitStatus status)
+{
+    m_running--;
+    if (m_aborted) {
+        return;
+    }
+    chunk->buffer.append(chunk->process->readAllStandardOutput());
+    chunk->results << takeJsonObjects(chunk->buffer);
+    if (status == QProcess::CrashExit || exitCode != 0) {
+        abort();
+        return;
+    }
+    chunk->done = true;
+    chunk->processed = chunk->duration;
+    flushResults();
+    updateProgress();
+    if (m_nextEmit == m_chunks.size()) {
+        emit finished(true);
+        return;
+    }
+    startChunks();
+}
+
+void SpeechPipeline::flushResults()
+{
+    while (m_nextEmit < m_chunks.size()) {
+        Chunk *chunk = m_chunks.at(m_nextEmit).get();
+        while (chunk->emitted < chunk->results.size()) {
+            const QJsonObject &obj = chunk->results.at(chunk->emitted);
+            chunk->emitted++;
+            QJsonObject entry;
+            entry.insert(QLatin1String("offset"), chunk->start);
+            entry.insert(QLatin1String("result"), obj);
+            m_results.append(entry);
+            emit result(obj, chunk->start);
+        }
+        if (!chunk->done) {
+            break;
+        }
+        m_nextEmit++;
+    }
+}
+
+void SpeechPipeline::updateProgress()
+{
+    double total = 0.;
+    double processed = 0.;
+    for (const auto &chunk : m_chunks) {
+        total += chunk->duration;
+        processed += chunk->processed;
+    }
+    if (total > 0.) {
+        emit progress(int(100 * processed / total));
+    }
+}
+
+void SpeechPipeline::abort()
+{
+    if (!isRunning()) {
+        return;
+    }
+    m_aborted = true;
+    for (auto &chunk : m_chunks) {
+        if (chunk->process && chunk->process->state() != QProcess::NotRunning) {
+            chunk->process->kill();
+        }
+    }
+    emit finished(false);
+}
+
+bool SpeechPipeline::isRunning() const
+{
+    return !m_aborted && m_nextEmit < m_chunks.size();
+}
+
+const QJsonArray &SpeechPipeline::results() const
+{
+    return m_results;
+}
+
+QString SpeechPipeline::cachePath(const QString &clipHash, const QString &language, double start, double duration)
+{
+    if (clipHash.isEmpty()) {
+        return QString();
+    }
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    if (!dir.mkpath(QStringLiteral("speech")) || !dir.cd(QStringLiteral("speech"))) {
+        return QString();
+    }
+    const QString key = QStringLiteral("%1:%2:%3:%4").arg(clipHash, language).arg(start, 0, 'f', 3).arg(duration, 0, 'f', 3);
+    return dir.absoluteFilePath(QString::fromLatin1(QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Md5).toHex()) + QStringLiteral(".json"));
+}
+
+bool SpeechPipeline::loadCache(const QString &path, QJsonArray &results)
+{
+    QFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    auto doc = QJsonDocument::fromJson(file.readAll());
+    if (!doc.isObject() || doc.object().value(QLatin1String("version")).toInt() != speechCacheVersion) {
+        return false;
+    }
+    results = doc.object().value(QLatin1String("results")).toArray();
+    return true;
+}
+
+void SpeechPipeline::storeCache(const QString &path, const QJsonArray &results)
+{
+    if (path.isEmpty()) {
+        return;
+    }
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(KDENLIVE_LOG) << "Cannot write speech cache" << path;
+        return;
+    }
+    QJsonObject obj;
+    obj.insert(QLatin1String("version"), speechCacheVersion);
+    obj.insert(QLatin1String("results"), results);
+    file.write(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+    file.commit();
+}
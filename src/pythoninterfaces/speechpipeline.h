@@ -0,0 +1,104 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QPair>
+#include <QProcess>
+#include <QVector>
+
+#include <memory>
+#include <vector>
+
+class SpeechToText;
+
+/** @class SpeechPipeline
+    @brief Runs the speech recognition script on several chunks of a media file in parallel.
+    The analysed zone is split at silences, each chunk is processed by its own recognizer process (up to a number of workers)
+    and the results are emitted in the order of the media, as soon as all previous chunks are done.
+    The results of a successful run can be cached, so that recognition on the same media and zone doesn't need to run again.
+ */
+class SpeechPipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SpeechPipeline(SpeechToText *stt, QObject *parent = nullptr);
+    ~SpeechPipeline() override;
+
+    /** @brief Split a zone in chunks of about @param chunkLength seconds, cutting in the quietest part around each chunk end
+       @param levels are the audio levels of the media, one value per frame and channel, as stored by the audio thumbnail job. If empty, the zone is split at fixed intervals
+       @param start and @param duration define the zone to split, in seconds
+       @returns a list of (start, duration) pairs in seconds
+     */
+    static QVector<QPair<double, double>> splitAtSilences(const QVector<uint8_t> &levels, int channels, double fps, double start, double duration,
+                                                          double chunkLength = 60.);
+    /** @brief Extract the complete top level json objects from @param buffer, the incomplete remaining data stays in the buffer */
+    static QList<QJsonObject> takeJsonObjects(QByteArray &buffer);
+
+    /** @brief The number of recognizer processes to run in parallel, from the speech_workers setting */
+    static int workerCount();
+
+    /** @brief Start the recognition of @param chunks of the @param source file */
+    void start(const QString &source, const QString &modelDirectory, const QString &language, const QVector<QPair<double, double>> &chunks);
+    /** @brief Kill all recognizer processes, finished(false) is emitted */
+    void abort();
+    bool isRunning() const;
+
+    /** @brief The results emitted during the last run, as a list of {"offset", "result"} objects */
+    const QJsonArray &results() const;
+
+    /** @brief The transcript cache file for a media (identified by its hash), language model and zone */
+    static QString cachePath(const QString &clipHash, const QString &language, double start, double duration);
+    /** @brief Load cached results as stored by storeCache(), @returns false if there is no valid cache */
+    static bool loadCache(const QString &path, QJsonArray &results);
+    static void storeCache(const QString &path, const QJsonArray &results);
+
+signals:
+    /** @brief A recognition result, @param offset is the position of the chunk it belongs to in the source, in seconds */
+    void result(const QJsonObject &obj, double offset);
+    void progress(int percent);
+    /** @brief Error output of the recognizer processes */
+    void errorOutput(const QString &text);
+    void finished(bool success);
+
+private:
+    struct Chunk
+    {
+        double start{0.};
+        double duration{0.};
+        /** @brief Duration processed so far, in seconds */
+        double processed{0.};
+        std::unique_ptr<QProcess> process;
+        QByteArray buffer;
+        QList<QJsonObject> results;
+        int emitted{0};
+        bool done{false};
+    };
+    SpeechToText *m_stt;
+    QString m_source;
+    QString m_modelDirectory;
+    QString m_language;
+    std::vector<std::unique_ptr<Chunk>> m_chunks;
+    /** @brief The first chunk that was not started yet */
+    size_t m_nextStart{0};
+    /** @brief The first chunk whose results were not all emitted yet */
+    size_t m_nextEmit{0};
+    int m_running{0};
+    int m_workers{1};
+    bool m_aborted{false};
+    QJsonArray m_results;
+
+    void startChunks();
+    void readOutput(Chunk *chunk);
+    void chunkFinished(Chunk *chunk, int exitCode, QProcess::ExitStatus status);
+    /** @brief Emit the available results in order */
+    void flushResults();
+    void updateProgress();
+};
@@ -291,20 +291,33 @@ void ScopeManager::checkActiveColourScopes()
 
 void ScopeManager::createScopes()
 {
-    createScopeDock(new Vectorscope(pCore->window()), i18n("Vectorscope"), QStringLiteral("vectorscope"));
-    createScopeDock(new Waveform(pCore->window()), i18n("Waveform"), QStringLiteral("waveform"));
-    createScopeDock(new RGBParade(pCore->window()), i18n("RGB Parade"), QStringLiteral("rgb_parade"));
-    createScopeDock(new Histogram(pCore->window()), i18n("Histogram"), QStringLiteral("histogram"));
+    createScopeDock<Vectorscope>(i18n("Vectorscope"), QStringLiteral("vectorscope"));
+    createScopeDock<Waveform>(i18n("Waveform"), QStringLiteral("waveform"));
+    createScopeDock<RGBParade>(i18n("RGB Parade"), QStringLiteral("rgb_parade"));
+    createScopeDock<Histogram>(i18n("Histogram"), QStringLiteral("histogram"));
     // Deprecated scopes
-    // createScopeDock(new Spectrogram(pCore->window()),   i18n("Spectrogram"));
-    // createScopeDock(new AudioSignal(pCore->window()),   i18n("Audio Signal"));
-    // createScopeDock(new AudioSpectrum(pCore->window()), i18n("AudioSpectrum"));
+    // createScopeDock<Spectrogram>(i18n("Spectrogram"));
+    // createScopeDock<AudioSignal>(i18n("Audio Signal"));
+    // createScopeDock<AudioSpectrum>(i18n("AudioSpectrum"));
 }
 
-template <class T> void ScopeManager::createScopeDock(T *scopeWidget, const QString &title, const QString &name)
+template <class T> void ScopeManager::createScopeDock(const QString &title, const QString &name)
 {
-    QDockWidget *dock = pCore->window()->addDock(title, name, scopeWidget);
-    addScope(scopeWidget, dock);
+    // The scope is only built when its dock is shown for the first time
+    QDockWidget *dock = pCore->window()->addLazyDock(title, name, [this](QDockWidget *scopeDock) {
+        auto *scopeWidget = new T(pCore->window());
+        addScope(scopeWidget, scopeDock);
+        // The dock is already visible, so the visibility connections of addScope missed this change
+        const QString scopeName = scopeWidget->widgetName();
+        QMetaObject::invokeMethod(
+            this,
+            [this, scopeName]() {
+                slotCheckActiveScopes();
+                slotRequestFrame(scopeName);
+            },
+            Qt::QueuedConnection);
+        return scopeWidget;
+    });
 
     // close for initial layout
     // actual state will be restored by session management
@@ -68,6 +68,7 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
 
     QList <int> videoTracksIndexes;
     QList <int> lockedTracksIndexes;
+    QList <int> loadedTracks;
     // Black track index
     videoTracksIndexes << 0;
     for (int i = 0; i < tractor.count() && ok; i++) {
@@ -92,6 +93,7 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
                 videoTracksIndexes << i;
             }
             ok = timeline->requestTrackInsertion(-1, tid, QString(), audioTrack, undo, redo, false);
+            loadedTracks << tid;
             if (track->get_int("kdenlive:locked_track") > 0) {
                 lockedTracksIndexes << tid;
             }
@@ -112,6 +114,7 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
                 videoTracksIndexes << i;
             }
             ok = timeline->requestTrackInsertion(-1, tid, trackName, audioTrack, undo, redo, false);
+            loadedTracks << tid;
             int muteState = track->get_int("hide");
             if (muteState > 0 && (!audioTrack || (audioTrack && muteState != 1))) {
                 timeline->setTrackProperty(tid, QStringLiteral("hide"), QString::number(muteState));
@@ -130,6 +133,14 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
             qWarning() << "Unexpected track type" << track->type();
         }
     }
+    // Clips were adopted without checks, verify the resulting tracks once
+    for (int tid : qAsConst(loadedTracks)) {
+        if (ok && timeline->isTrack(tid) && !timeline->finishTrackAdoption(tid)) {
+            qWarning() << "Inconsistent track after loading" << tid;
+            m_errorMessage << i18n("Track %1 could not be loaded correctly.", timeline->getTrackTagById(tid));
+            ok = false;
+        }
+    }
     timeline->_resetView();
 
     // Loading compositions
@@ -471,7 +482,11 @@ bool constructTrackFromMelt(const std::shared_ptr<TimelineItemModel> &timeline,
                     }
                 }
                 cid = ClipModel::construct(timeline, binId, clip, st, tid, originalDecimalPoint, enforceTopPlaylist ? 0 : playlist);
-                ok = timeline->requestClipMove(cid, tid, position, true, true, false, true, undo, redo);
+                // Playlist entries come in position order so the clip can usually be appended directly, without the checks and undo of a move
+                ok = timeline->adoptClip(cid, tid, position);
+                if (!ok) {
+                    ok = timeline->requestClipMove(cid, tid, position, true, true, false, true, undo, redo);
+                }
             } else {
                 qWarning() << "can't find bin clip" << binId << clip->get("id");
             }
@@ -604,6 +604,7 @@ void ClipModel::requestRemapResize(int inPoint, int outPoint, int oldIn, int old
                     return true;
                 };
                 operation();
+                reverse = UndoPayload::attach(reverse, UndoPayload::stringSize(oldKfrData));
                 PUSH_LAMBDA(operation, redo);
                 PUSH_FRONT_LAMBDA(reverse, undo);
             }
@@ -1893,6 +1893,9 @@ bool TimelineFunctions::pasteTimelineClips(const std::shared_ptr<TimelineItemMod
     int offset = copiedItems.documentElement().attribute(QStringLiteral("offset")).toInt();
     bool res = true;
     std::unordered_map<int, int> correspondingIds;
+    // Pasted clips are inserted together once they are all created
+    std::map<int, std::pair<int, int>> insertions;
+    std::vector<std::pair<int, QDomElement>> pastedClips;
     QDomElement documentMixes = copiedItems.createElement(QStringLiteral("mixes"));
     for (int i = 0; i < clips.count(); i++) {
         QDomElement prod = clips.at(i).toElement();
@@ -1961,15 +1964,8 @@ bool TimelineFunctions::pasteTimelineClips(const std::shared_ptr<TimelineItemMod
             timeline->m_allClips[newId]->setSubPlaylistIndex(targetPlaylist, curTrackId);
         }
         correspondingIds[targetId] = newId;
-        res = res && timeline->getTrackById(curTrackId)->requestClipInsertion(newId, position + pos, true, true, timeline_undo, timeline_redo);
-        // paste effects
-        if (res) {
-            std::shared_ptr<EffectStackModel> destStack = timeline->getClipEffectStackModel(newId);
-            destStack->fromXml(prod.firstChildElement(QStringLiteral("effects")), timeline_undo, timeline_redo);
-        } else {
-            qDebug()<<"=== COULD NOT PASTE CLIP: "<<newId<<" ON TRACK: "<<curTrackId<<" AT: "<<position;
-            break;
-        }
+        insertions[newId] = {curTrackId, position + pos};
+        pastedClips.emplace_back(newId, prod);
         // Mixes (same track transitions)
         if (prod.hasChildNodes()) {
             QDomNodeList mixes = prod.elementsByTagName(QLatin1String("mix"));
@@ -1982,6 +1978,21 @@ bool TimelineFunctions::pasteTimelineClips(const std::shared_ptr<TimelineItemMod
             }
         }
     }
+    // Insert all clips in one operation. Clips with a mix overlap each other, in which case they are inserted one by one
+    if (!timeline->requestClipsMove(insertions, true, timeline_undo, timeline_redo)) {
+        for (const auto &insertion : insertions) {
+            res = timeline->getTrackById(insertion.second.first)->requestClipInsertion(insertion.first, insertion.second.second, true, true, timeline_undo, timeline_redo);
+            if (!res) {
+                qDebug()<<"=== COULD NOT PASTE CLIP: "<<insertion.first<<" ON TRACK: "<<insertion.second.first<<" AT: "<<insertion.second.second;
+                break;
+            }
+        }
+    }
+    // paste effects
+    for (size_t i = 0; res && i < pastedClips.size(); i++) {
+        std::shared_ptr<EffectStackModel> destStack = timeline->getClipEffectStackModel(pastedClips[i].first);
+        destStack->fromXml(pastedClips[i].second.firstChildElement(QStringLiteral("effects")), timeline_undo, timeline_redo);
+    }
     // Process mix insertion
     QDomNodeList mixes = documentMixes.childNodes();
     for (int k = 0; k < mixes.count(); k++) {
@@ -37,6 +37,7 @@
 #include <mlt++/MltProfile.h>
 #include <mlt++/MltTractor.h>
 #include <mlt++/MltTransition.h>
+#include <algorithm>
 #include <queue>
 #include <set>
 
@@ -115,6 +116,8 @@ TimelineModel::TimelineModel(Mlt::Profile *profile, std::weak_ptr<DocUndoStack>
     , m_profile(profile)
     , m_blackClip(new Mlt::Producer(*profile, "color:black"))
     , m_lock(QReadWriteLock::Recursive)
+    , m_layoutVersion(0)
+    , m_layoutSnapshotPending(false)
     , m_timelineEffectsEnabled(true)
     , m_id(getNextId())
     , m_overlayTrackCount(-1)
@@ -131,6 +134,16 @@ TimelineModel::TimelineModel(Mlt::Profile *profile, std::weak_ptr<DocUndoStack>
     m_blackClip->set("set.test_audio", 0);
     m_blackClip->set_in_and_out(0, TimelineModel::seekDuration);
     m_tractor->insert_track(*m_blackClip, 0);
+    // Publish an empty snapshot so that readers never have to build one
+    std::atomic_store(&m_layoutSnapshot, TimelineSnapshotPtr(std::make_shared<const TimelineSnapshot>(0, 0, std::vector<TrackSnapshot>())));
+
+    // Any change of the item model means a layout change, republish the snapshot once the operation is done
+    connect(this, &QAbstractItemModel::dataChanged, this, &TimelineModel::invalidateLayoutSnapshot);
+    connect(this, &QAbstractItemModel::rowsInserted, this, &TimelineModel::invalidateLayoutSnapshot);
+    connect(this, &QAbstractItemModel::rowsRemoved, this, &TimelineModel::invalidateLayoutSnapshot);
+    connect(this, &QAbstractItemModel::rowsMoved, this, &TimelineModel::invalidateLayoutSnapshot);
+    connect(this, &QAbstractItemModel::modelReset, this, &TimelineModel::invalidateLayoutSnapshot);
+    connect(this, &TimelineModel::durationUpdated, this, &TimelineModel::invalidateLayoutSnapshot);
 
     TRACE_CONSTR(this);
 }
@@ -866,6 +879,44 @@ bool TimelineModel::requestClipMove(int clipId, int trackId, int position, bool
     return true;
 }
 
+bool TimelineModel::adoptClip(int clipId, int trackId, int position)
+{
+    QWriteLocker locker(&m_lock);
+    Q_ASSERT(isClip(clipId));
+    if (!isTrack(trackId) || position < 0 || getClipTrackId(clipId) != -1) {
+        return false;
+    }
+    std::shared_ptr<ClipModel> clip = m_allClips[clipId];
+    auto track = getTrackById(trackId);
+    if (track->isAudioTrack() ? !clip->canBeAudio() : !clip->canBeVideo()) {
+        return false;
+    }
+    if (clip->clipState() != PlaylistState::Disabled && clip->clipState() != track->trackType()) {
+        Fun undo = []() { return true; };
+        Fun redo = []() { return true; };
+        if (!clip->setClipState(track->trackType(), undo, redo)) {
+            return false;
+        }
+    }
+    return track->adoptClip(clipId, position);
+}
+
+bool TimelineModel::finishTrackAdoption(int trackId)
+{
+    QWriteLocker locker(&m_lock);
+    bool ok = getTrackById(trackId)->checkAdoptedClips();
+#ifndef QT_NO_DEBUG
+    // The full check is quadratic in the number of clips, only log its result
+    if (ok && !getTrackById(trackId)->checkConsistency()) {
+        qWarning() << "Track consistency check failed after loading" << trackId;
+    }
+#endif
+    updateDuration();
+    // Publish the loaded track once we are back in the event loop
+    invalidateLayoutSnapshot();
+    return ok;
+}
+
 bool TimelineModel::mixClip(int idToMove, const QString &mixId, int delta)
 {
     int selectedTrack = -1;
@@ -2025,6 +2076,7 @@ bool TimelineModel::requestClipDeletion(int clipId, Fun &undo, Fun &redo, bool l
         registerClip(clip, true);
         return true;
     };
+    reverse = UndoPayload::attach(reverse, qint64(sizeof(ClipModel)) + clip->m_effectStack->dataSize());
     if (operation()) {
         UPDATE_UNDO_REDO(operation, reverse, undo, redo);
         return true;
@@ -2424,6 +2476,30 @@ bool TimelineModel::requestGroupMove(int itemId, int groupId, int delta_track, i
             }
         }
     }
+    if (finalMove && !revertMove && mixDataArray.isEmpty() && sorted_compositions.empty() && allowedTracks.isEmpty()) {
+        // Group of clips without mix, try to move all clips in one operation
+        std::map<int, std::pair<int, int>> moves;
+        bool valid = true;
+        for (const std::pair<int, int> &item : sorted_clips) {
+            int current_track_id = getClipTrackId(item.first);
+            int target_track = current_track_id;
+            if (delta_track != 0 && (moveMirrorTracks || item.first == itemId)) {
+                bool isAudio = getTrackById_const(current_track_id)->isAudioTrack();
+                int d = isAudio == masterIsAudio ? delta_track : -delta_track;
+                int target_track_position = getTrackPosition(current_track_id) + d;
+                if (target_track_position < 0 || target_track_position >= getTracksCount()) {
+                    valid = false;
+                    break;
+                }
+                target_track = getTrackIndexFromPosition(target_track_position);
+            }
+            moves[item.first] = {target_track, item.second + delta_pos};
+        }
+        if (valid && requestClipsMove(moves, updateView && allowViewRefresh, local_undo, local_redo)) {
+            UPDATE_UNDO_REDO(local_redo, local_undo, undo, redo);
+            return true;
+        }
+    }
     if (delta_track == 0 && updateView) {
         updateView = false;
         allowViewRefresh = false;
@@ -2652,6 +2728,243 @@ bool TimelineModel::requestGroupMove(int itemId, int groupId, int delta_track, i
     return true;
 }
 
+bool TimelineModel::requestClipsMove(const std::map<int, std::pair<int, int>> &moves, bool updateView, Fun &undo, Fun &redo)
+{
+    QWriteLocker locker(&m_lock);
+    if (moves.empty()) {
+        return true;
+    }
+    std::map<int, std::pair<int, int>> previous;
+    // For each target track, the ranges occupied once the moves are done, and whether they belong to a moved clip
+    std::unordered_map<int, std::vector<std::pair<std::pair<int, int>, bool>>> targetRanges;
+    std::unordered_set<int> affectedTracks;
+    for (const auto &move : moves) {
+        int clipId = move.first;
+        int trackId = move.second.first;
+        int position = move.second.second;
+        if (!isClip(clipId) || !isTrack(trackId) || position < 0) {
+            return false;
+        }
+        // Clips that are not in a track yet are inserted
+        int oldTrackId = getClipTrackId(clipId);
+        if ((oldTrackId != -1 && getTrackById_const(oldTrackId)->isLocked()) || getTrackById_const(trackId)->isLocked()) {
+            return false;
+        }
+        if (oldTrackId != -1 && getTrackById_const(oldTrackId)->hasMix(clipId)) {
+            // Mixes have to be handled clip by clip
+            return false;
+        }
+        std::shared_ptr<ClipModel> clip = m_allClips[clipId];
+        auto track = getTrackById_const(trackId);
+        if (clip->clipState() == PlaylistState::Disabled) {
+            if (track->isAudioTrack() ? !clip->canBeAudio() : !clip->canBeVideo()) {
+                return false;
+            }
+        } else if (track->trackType() != clip->clipState()) {
+            return false;
+        }
+        previous[clipId] = {oldTrackId, clip->getPosition()};
+        if (oldTrackId != -1) {
+            affectedTracks.insert(oldTrackId);
+        }
+        targetRanges[trackId].push_back({{position, position + clip->getPlaytime()}, true});
+    }
+    for (auto &target : targetRanges) {
+        auto track = getTrackById_const(target.first);
+        for (const auto &clip : track->m_allClips) {
+            if (moves.count(clip.first) == 0) {
+                target.second.push_back({{clip.second->getPosition(), clip.second->getPosition() + clip.second->getPlaytime()}, false});
+            }
+        }
+        affectedTracks.insert(target.first);
+        // A moved clip cannot overlap any other clip, but clips that are not moved can overlap each other (mixes)
+        std::sort(target.second.begin(), target.second.end());
+        int maxEnd = 0;
+        int maxMovedEnd = 0;
+        for (const auto &range : target.second) {
+            if (range.first.first < (range.second ? maxEnd : maxMovedEnd)) {
+                return false;
+            }
+            maxEnd = qMax(maxEnd, range.first.second);
+            if (range.second) {
+                maxMovedEnd = qMax(maxMovedEnd, range.first.second);
+            }
+        }
+    }
+    std::unordered_map<int, int> durations;
+    for (int tid : affectedTracks) {
+        durations[tid] = getTrackById_const(tid)->trackDuration();
+    }
+    Fun operation = requestClipsMove_lambda(moves, updateView);
+    Fun reverse = requestClipsMove_lambda(previous, updateView);
+    if (!operation()) {
+        bool undone = reverse();
+        Q_ASSERT(undone);
+        return false;
+    }
+    Fun local_undo = []() { return true; };
+    Fun local_redo = []() { return true; };
+    UPDATE_UNDO_REDO(operation, reverse, local_undo, local_redo);
+    for (int tid : affectedTracks) {
+        auto track = getTrackById(tid);
+        if (durations[tid] != track->trackDuration()) {
+            // The move changed the track duration, update track effects
+            track->m_effectStack->adjustStackLength(true, 0, durations[tid], 0, track->trackDuration(), 0, local_undo, local_redo, true);
+        }
+    }
+    UPDATE_UNDO_REDO(local_redo, local_undo, undo, redo);
+    return true;
+}
+
+/** @brief Group sorted rows into ranges of consecutive rows */
+static std::vector<std::pair<int, int>> rowRanges(std::vector<int> rows)
+{
+    std::vector<std::pair<int, int>> ranges;
+    std::sort(rows.begin(), rows.end());
+    for (int row : rows) {
+        if (!ranges.empty() && ranges.back().second + 1 == row) {
+            ranges.back().second = row;
+        } else {
+            ranges.emplace_back(row, row);
+        }
+    }
+    return ranges;
+}
+
+Fun TimelineModel::requestClipsMove_lambda(const std::map<int, std::pair<int, int>> &layout, bool updateView)
+{
+    return [this, layout, updateView]() {
+        // Playlists to rebuild for each track
+        std::map<int, std::set<int>> playlists;
+        std::map<int, std::vector<int>> leaving;
+        std::map<int, std::vector<int>> entering;
+        std::map<int, std::vector<int>> moving;
+        std::unordered_map<int, std::pair<int, int>> oldRanges;
+        int start = -1;
+        int end = -1;
+        bool videoChange = false;
+        for (const auto &move : layout) {
+            std::shared_ptr<ClipModel> clip = m_allClips[move.first];
+            // A track id of -1 means that the clip is not in a track, before an insertion or after a removal
+            int oldTrackId = clip->getCurrentTrackId();
+            int trackId = move.second.first;
+            if (oldTrackId == -1 && trackId == -1) {
+                continue;
+            }
+            for (int tid : {oldTrackId, trackId}) {
+                if (tid != -1 && (!isTrack(tid) || getTrackById_const(tid)->isLocked())) {
+                    return false;
+                }
+            }
+            int playtime = clip->getPlaytime();
+            if (oldTrackId == trackId) {
+                moving[trackId].push_back(move.first);
+            } else {
+                if (oldTrackId != -1) {
+                    leaving[oldTrackId].push_back(move.first);
+                }
+                if (trackId != -1) {
+                    entering[trackId].push_back(move.first);
+                }
+            }
+            for (int tid : {oldTrackId, trackId}) {
+                if (tid == -1) {
+                    continue;
+                }
+                playlists[tid].insert(clip->getSubPlaylistIndex());
+                int in = tid == oldTrackId ? clip->getPosition() : move.second.second;
+                start = start == -1 ? in : qMin(start, in);
+                end = qMax(end, in + playtime);
+                if (!clip->isAudioOnly() && !getTrackById_const(tid)->isAudioTrack()) {
+                    videoChange = true;
+                }
+            }
+            oldRanges[move.first] = {clip->getPosition(), clip->getPosition() + playtime};
+        }
+        if (updateView) {
+            // Rows are removed while the model still reports them, starting from the last one so that indexes stay valid
+            for (const auto &tk : leaving) {
+                auto track = getTrackById_const(tk.first);
+                std::vector<int> rows;
+                for (int cid : tk.second) {
+                    rows.push_back(track->getRowfromClip(cid));
+                }
+                auto ranges = rowRanges(rows);
+                QModelIndex trackIndex = makeTrackIndexFromID(tk.first);
+                for (auto it = ranges.rbegin(); it != ranges.rend(); ++it) {
+                    _beginRemoveRows(trackIndex, it->first, it->second);
+                    _endRemoveRows();
+                }
+            }
+        }
+        for (const auto &tk : playlists) {
+            for (int index : tk.second) {
+                getTrackById(tk.first)->beginPlaylistRebuild(index);
+            }
+        }
+        for (const auto &move : layout) {
+            std::shared_ptr<ClipModel> clip = m_allClips[move.first];
+            int oldTrackId = clip->getCurrentTrackId();
+            int trackId = move.second.first;
+            if (oldTrackId != -1) {
+                m_snaps->removePoint(oldRanges[move.first].first);
+                m_snaps->removePoint(oldRanges[move.first].second);
+            }
+            if (oldTrackId != trackId) {
+                if (oldTrackId != -1) {
+                    getTrackById(oldTrackId)->m_allClips.erase(move.first);
+                    clip->setCurrentTrackId(-1);
+                }
+                if (trackId != -1) {
+                    getTrackById(trackId)->m_allClips[move.first] = clip;
+                    clip->setCurrentTrackId(trackId, true);
+                }
+            }
+            clip->setPosition(move.second.second);
+            if (trackId != -1) {
+                m_snaps->addPoint(move.second.second);
+                m_snaps->addPoint(move.second.second + clip->getPlaytime());
+            }
+        }
+        bool ok = true;
+        for (const auto &tk : playlists) {
+            for (int index : tk.second) {
+                ok = getTrackById(tk.first)->endPlaylistRebuild(index) && ok;
+            }
+        }
+        if (updateView) {
+            for (const auto &tk : entering) {
+                auto track = getTrackById_const(tk.first);
+                std::vector<int> rows;
+                for (int cid : tk.second) {
+                    rows.push_back(track->getRowfromClip(cid));
+                }
+                QModelIndex trackIndex = makeTrackIndexFromID(tk.first);
+                for (const auto &range : rowRanges(rows)) {
+                    _beginInsertRows(trackIndex, range.first, range.second);
+                    _endInsertRows();
+                }
+            }
+            for (const auto &tk : moving) {
+                auto track = getTrackById_const(tk.first);
+                std::vector<int> rows;
+                for (int cid : tk.second) {
+                    rows.push_back(track->getRowfromClip(cid));
+                }
+                auto ranges = rowRanges(rows);
+                QModelIndex trackIndex = makeTrackIndexFromID(tk.first);
+                notifyChange(index(ranges.front().first, 0, trackIndex), index(ranges.back().second, 0, trackIndex), StartRole);
+            }
+        }
+        if (videoChange) {
+            emit invalidateZone(start, end);
+            checkRefresh(start, end);
+        }
+        updateDuration();
+        return ok;
+    };
+}
+
 bool TimelineModel::requestGroupDeletion(int clipId, bool logUndo)
 {
     QWriteLocker locker(&m_lock);
@@ -4506,6 +4819,58 @@ void TimelineModel::updateDuration()
     }
 }
 
+void TimelineModel::invalidateLayoutSnapshot()
+{
+    if (m_closing || m_layoutSnapshotPending.exchange(true)) {
+        return;
+    }
+    QMetaObject::invokeMethod(this, [this]() {
+        if (m_layoutSnapshotPending) {
+            publishLayoutSnapshot();
+        }
+    }, Qt::QueuedConnection);
+}
+
+void TimelineModel::publishLayoutSnapshot()
+{
+    m_layoutSnapshotPending = false;
+    std::vector<TrackSnapshot> tracks;
+    int duration;
+    {
+        READ_LOCK();
+        duration = m_blackClip->get_playtime() - TimelineModel::seekDuration;
+        tracks.reserve(m_allTracks.size());
+        for (const auto &track : m_allTracks) {
+            TrackSnapshot trackSnap{track->getId(), track->isAudioTrack(), track->isLocked(), track->isHidden(), track->isMute(), {}, {}};
+            trackSnap.clips.reserve(track->m_allClips.size());
+            for (const auto &clip : track->m_allClips) {
+                trackSnap.clips.push_back({clip.first, clip.second->getPosition(), clip.second->getPlaytime(), clip.second->binId(), false});
+            }
+            trackSnap.compositions.reserve(track->m_allCompositions.size());
+            for (const auto &compo : track->m_allCompositions) {
+                trackSnap.compositions.push_back({compo.first, compo.second->getPosition(), compo.second->getPlaytime(), compo.second->getAssetId(), true});
+            }
+            auto byPosition = [](const TimelineItemSnapshot &a, const TimelineItemSnapshot &b) { return a.position < b.position; };
+            std::sort(trackSnap.clips.begin(), trackSnap.clips.end(), byPosition);
+            std::sort(trackSnap.compositions.begin(), trackSnap.compositions.end(), byPosition);
+            tracks.push_back(std::move(trackSnap));
+        }
+    }
+    quint64 version = ++m_layoutVersion;
+    std::atomic_store(&m_layoutSnapshot, TimelineSnapshotPtr(std::make_shared<const TimelineSnapshot>(version, duration, std::move(tracks))));
+    emit layoutSnapshotChanged(version);
+}
+
+TimelineSnapshotPtr TimelineModel::layoutSnapshot() const
+{
+    return std::atomic_load(&m_layoutSnapshot);
+}
+
+quint64 TimelineModel::layoutVersion() const
+{
+    return m_layoutVersion;
+}
+
 int TimelineModel::duration() const
 {
     return m_tractor->get_playtime() - TimelineModel::seekDuration;
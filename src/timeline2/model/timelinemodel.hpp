@@ -8,9 +8,12 @@
 #include "definitions.h"
 #include "undohelper.hpp"
 #include "trackmodel.hpp"
+#include "timelinesnapshot.hpp"
 #include <QAbstractItemModel>
 #include <QReadWriteLock>
+#include <atomic>
 #include <cassert>
+#include <map>
 #include <memory>
 #include <mlt++/MltTractor.h>
 #include <unordered_map>
@@ -430,6 +433,15 @@ public:
     bool requestClipInsertion(const QString &binClipId, int trackId, int position, int &id, bool logUndo, bool refreshView, bool useTargets, Fun &undo,
                               Fun &redo, const QVector<int> &allowedTracks = QVector<int>());
 
+    /** @brief Fast insertion of a clip created with ClipModel::construct when building the timeline from a project file.
+       The clips of a track must be adopted in position order. No undo is created and the view is not notified, call
+       finishTrackAdoption once the track is loaded.
+       Returns false if the clip cannot be adopted, in which case it is untouched and requestClipMove can be used instead.
+    */
+    bool adoptClip(int clipId, int trackId, int position);
+    /** @brief Check the clip positions in the track playlists and update the timeline duration after clips were adopted */
+    bool finishTrackAdoption(int trackId);
+
     /** @brief Switch current composition type
      *  @param cid the id of the composition we want to change
      *  @param compoId the name of the new composition we want to insert
@@ -462,6 +474,10 @@ protected:
     /** @brief Switch item selection status */
     void setSelected(int itemId, bool sel);
 
+    /** @brief Returns a lambda that puts each clip of @param layout on its track and position (validated by requestClipsMove),
+       rebuilding each affected playlist once. A track id of -1 removes the clip from its track */
+    Fun requestClipsMove_lambda(const std::map<int, std::pair<int, int>> &layout, bool updateView);
+
 public:
     /** @brief Deletes the given clip or composition from the timeline.
        This action is undoable.
@@ -489,6 +505,17 @@ public:
     bool requestGroupMove(int itemId, int groupId, int delta_track, int delta_pos, bool updateView, bool finalMove, Fun &undo, Fun &redo, bool revertMove = false, bool moveMirrorTracks = true, 
                           bool allowViewRefresh = true, const QVector<int> &allowedTracks = QVector<int>());
 
+    /** @brief Move several clips at once, each one to its own track and position.
+       Clips that are not in a track yet (created with requestClipCreation) are inserted, and removed again on undo.
+       All the moves are validated before anything is modified: the clips must be in an unlocked track or in no track and have no mix,
+       and their new positions must not overlap a clip that is not moved. Each affected playlist is then rebuilt once, the view
+       gets one notification per range of rows instead of one per clip, and a single compact undo entry is created.
+       Returns true on success. If it fails, nothing is modified.
+       @param moves maps the id of each moved clip to its target track id and position
+       @param updateView if set to false, no signal is sent to qml
+    */
+    bool requestClipsMove(const std::map<int, std::pair<int, int>> &moves, bool updateView, Fun &undo, Fun &redo);
+
     /** @brief Deletes all clips inside the group that contains the given clip.
        This action is undoable
        Note that if their is a hierarchy of groups, all of them will be deleted.
@@ -612,6 +639,18 @@ public:
     */
     QByteArray timelineHash();
 
+    /** @brief Returns the last published layout snapshot of the timeline.
+       This does not lock the model and can be called from any thread: it should be preferred to the item queries by
+       any consumer that does not run in the GUI thread (preview rendering, mixer, scopes, audio thumbnails).
+       The snapshot may be slightly behind an operation in progress, it is republished once the operation completes.
+       An empty snapshot is published on construction, so this never has side effects.
+    */
+    TimelineSnapshotPtr layoutSnapshot() const;
+    /** @brief Returns the version of the last published layout snapshot */
+    quint64 layoutVersion() const;
+    /** @brief Rebuild and publish the layout snapshot immediately. Must be called from the model's thread */
+    void publishLayoutSnapshot();
+
 protected:
     /** @brief Requests the best snapped position for a clip
        @param pos is the clip's requested position
@@ -869,6 +908,10 @@ protected:
     /** @brief Check tracks duration and update black track accordingly */
     void updateDuration();
 
+    /** @brief Mark the layout snapshot as outdated. Successive calls are coalesced into a single publication
+       once control returns to the event loop, so that a multi-step operation publishes only its final state */
+    void invalidateLayoutSnapshot();
+
     /** @brief Attempt to make a clip move without ever updating the view */
     bool requestClipMoveAttempt(int clipId, int trackId, int position);
     
@@ -902,6 +945,8 @@ signals:
     void checkTrackDeletion(int tid);
     /** @brief Emitted when a clip is deleted to check if it was not used in timeline qml */
     void checkItemDeletion(int cid);
+    /** @brief Emitted after a new layout snapshot was published */
+    void layoutSnapshotChanged(quint64 version);
 
 protected:
     std::unique_ptr<Mlt::Tractor> m_tractor;
@@ -936,6 +981,12 @@ protected:
 
     mutable QReadWriteLock m_lock; // This is a lock that ensures safety in case of concurrent access
 
+    /// Last published layout snapshot, only accessed through std::atomic_load / std::atomic_store
+    TimelineSnapshotPtr m_layoutSnapshot;
+    std::atomic<quint64> m_layoutVersion;
+    /// True when a snapshot publication is already scheduled
+    std::atomic<bool> m_layoutSnapshotPending;
+
     bool m_timelineEffectsEnabled;
 
     bool m_id; // id of the timeline itself
@@ -0,0 +1,67 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "timelinesnapshot.hpp"
+
+#include <algorithm>
+
+const TimelineItemSnapshot *TrackSnapshot::clipAt(int position) const
+{
+    // First clip starting after position, the candidate is the one before
+    auto it = std::upper_bound(clips.cbegin(), clips.cend(), position, [](int pos, const TimelineItemSnapshot &item) { return pos < item.position; });
+    if (it == clips.cbegin()) {
+        return nullptr;
+    }
+    --it;
+    return position < it->end() ? &(*it) : nullptr;
+}
+
+std::vector<TimelineItemSnapshot> TrackSnapshot::clipsInRange(int start, int end) const
+{
+    std::vector<TimelineItemSnapshot> result;
+    auto it = std::upper_bound(clips.cbegin(), clips.cend(), start, [](int pos, const TimelineItemSnapshot &item) { return pos < item.position; });
+    if (it != clips.cbegin() && std::prev(it)->end() > start) {
+        --it;
+    }
+    for (; it != clips.cend() && it->position < end; ++it) {
+        result.push_back(*it);
+    }
+    return result;
+}
+
+TimelineSnapshot::TimelineSnapshot(quint64 version, int duration, std::vector<TrackSnapshot> tracks)
+    : m_version(version)
+    , m_duration(duration)
+    , m_tracks(std::move(tracks))
+{
+}
+
+const TrackSnapshot *TimelineSnapshot::track(int trackId) const
+{
+    for (const auto &track : m_tracks) {
+        if (track.id == trackId) {
+            return &track;
+        }
+    }
+    return nullptr;
+}
+
+const TimelineItemSnapshot *TimelineSnapshot::item(int itemId, int *trackId) const
+{
+    for (const auto &track : m_tracks) {
+        for (const auto *list : {&track.clips, &track.compositions}) {
+            for (const auto &item : *list) {
+                if (item.id == itemId) {
+                    if (trackId) {
+                        *trackId = track.id;
+                    }
+                    return &item;
+                }
+            }
+        }
+    }
+    return nullptr;
+}
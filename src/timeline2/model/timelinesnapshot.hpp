@@ -0,0 +1,76 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+#include <memory>
+#include <vector>
+
+/** @brief Layout information of one clip or composition in a TimelineSnapshot */
+struct TimelineItemSnapshot
+{
+    int id;
+    int position;
+    int duration;
+    /** @brief Bin id of a clip, composition id (asset name) of a composition */
+    QString assetId;
+    bool isComposition;
+
+    int end() const { return position + duration; }
+};
+
+/** @brief Layout information of one track in a TimelineSnapshot */
+struct TrackSnapshot
+{
+    int id;
+    bool isAudio;
+    bool isLocked;
+    bool isHidden;
+    bool isMute;
+    /** @brief The clips of the track, ordered by position */
+    std::vector<TimelineItemSnapshot> clips;
+    /** @brief The compositions of the track, ordered by position */
+    std::vector<TimelineItemSnapshot> compositions;
+
+    /** @brief Returns the clip at the given frame, or nullptr if there is a blank */
+    const TimelineItemSnapshot *clipAt(int position) const;
+    /** @brief Returns the clips intersecting the range [start, end[ */
+    std::vector<TimelineItemSnapshot> clipsInRange(int start, int end) const;
+};
+
+/** @class TimelineSnapshot
+    @brief An immutable copy of the timeline layout (tracks and the items they contain with their positions and durations).
+    The TimelineModel publishes a new snapshot after each completed operation. Readers running outside of the GUI thread
+    (preview rendering, mixer, scopes, background jobs) should use it instead of querying the model, since querying the model
+    requires its lock and will contend with the GUI's edits. A snapshot never changes once published, so it can be read
+    without any locking; compare versions to detect changes.
+ */
+class TimelineSnapshot
+{
+public:
+    TimelineSnapshot(quint64 version, int duration, std::vector<TrackSnapshot> tracks);
+
+    /** @brief Monotonic version number, incremented each time a new snapshot is published */
+    quint64 version() const { return m_version; }
+    /** @brief The timeline duration in frames */
+    int duration() const { return m_duration; }
+    /** @brief The tracks, in the same order as in the timeline (bottom to top) */
+    const std::vector<TrackSnapshot> &tracks() const { return m_tracks; }
+    /** @brief Returns the track with the given id, or nullptr */
+    const TrackSnapshot *track(int trackId) const;
+    /** @brief Returns the item with the given id, and the id of the track containing it in @param trackId */
+    const TimelineItemSnapshot *item(int itemId, int *trackId = nullptr) const;
+
+private:
+    quint64 m_version;
+    int m_duration;
+    std::vector<TrackSnapshot> m_tracks;
+};
+
+using TimelineSnapshotPtr = std::shared_ptr<const TimelineSnapshot>;
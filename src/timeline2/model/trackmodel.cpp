@@ -265,6 +265,116 @@ Fun TrackModel::requestClipInsertion_lambda(int clipId, int position, bool updat
     return []() { return false; };
 }
 
+bool TrackModel::adoptClip(int clipId, int position)
+{
+    QWriteLocker locker(&m_lock);
+    auto ptr = m_parent.lock();
+    if (!ptr) {
+        qDebug() << "Error : Clip adoption failed because timeline is not available anymore";
+        return false;
+    }
+    std::shared_ptr<ClipModel> clip = ptr->getClipPtr(clipId);
+    int target_playlist = clip->getSubPlaylistIndex();
+    int playtime = m_playlists[target_playlist].get_playtime();
+    if (position < playtime) {
+        return false;
+    }
+    const int previousTrack = clip->getCurrentTrackId();
+    const int count = m_playlists[target_playlist].count();
+    m_playlists[target_playlist].lock();
+    if (position > playtime) {
+        m_playlists[target_playlist].blank(position - playtime - 1);
+    }
+    clip->setCurrentTrackId(m_id, true);
+    int result = m_playlists[target_playlist].append(*clip);
+    if (result != 0) {
+        // Undo the changes, the track is left as it was
+        while (m_playlists[target_playlist].count() > count) {
+            m_playlists[target_playlist].remove(m_playlists[target_playlist].count() - 1);
+        }
+        m_playlists[target_playlist].unlock();
+        clip->setCurrentTrackId(previousTrack, true);
+        return false;
+    }
+    m_playlists[target_playlist].unlock();
+    m_allClips[clipId] = clip;
+    clip->setPosition(position);
+    clip->setSubPlaylistIndex(target_playlist, m_id);
+    ptr->m_snaps->addPoint(position);
+    ptr->m_snaps->addPoint(position + clip->getPlaytime());
+    return true;
+}
+
+bool TrackModel::checkAdoptedClips()
+{
+    READ_LOCK();
+    for (int pl = 0; pl < 2; ++pl) {
+        std::vector<std::pair<int, int>> clips; // (position, playtime) of the clips of this playlist
+        for (const auto &clip : m_allClips) {
+            if (clip.second->getSubPlaylistIndex() == pl) {
+                clips.emplace_back(clip.second->getPosition(), clip.second->getPlaytime());
+            }
+        }
+        std::sort(clips.begin(), clips.end());
+        size_t next = 0;
+        for (int i = 0; i < m_playlists[pl].count(); ++i) {
+            if (m_playlists[pl].is_blank(i)) {
+                continue;
+            }
+            if (next >= clips.size() || m_playlists[pl].clip_start(i) != clips[next].first || m_playlists[pl].clip_length(i) != clips[next].second) {
+                qWarning() << "Unexpected clip at index" << i << "of playlist" << pl << "in track" << m_id;
+                return false;
+            }
+            next++;
+        }
+        if (next != clips.size()) {
+            qWarning() << "Missing clips in playlist" << pl << "of track" << m_id;
+            return false;
+        }
+    }
+    return true;
+}
+
+void TrackModel::beginPlaylistRebuild(int index)
+{
+    QWriteLocker locker(&m_lock);
+    // Lock MLT playlist so that we don't end up with an invalid frame being displayed
+    m_playlists[index].lock();
+    m_playlists[index].clear();
+}
+
+bool TrackModel::endPlaylistRebuild(int index)
+{
+    QWriteLocker locker(&m_lock);
+    std::vector<std::shared_ptr<ClipModel>> clips;
+    for (const auto &clip : m_allClips) {
+        if (clip.second->getSubPlaylistIndex() == index) {
+            clips.push_back(clip.second);
+        }
+    }
+    std::sort(clips.begin(), clips.end(),
+              [](const std::shared_ptr<ClipModel> &a, const std::shared_ptr<ClipModel> &b) { return a->getPosition() < b->getPosition(); });
+    bool ok = true;
+    int playtime = 0;
+    for (const auto &clip : clips) {
+        int position = clip->getPosition();
+        if (position < playtime) {
+            qWarning() << "playlist rebuild: clip" << clip->getId() << "overlaps previous clip on track" << m_id;
+            ok = false;
+            continue;
+        }
+        if (position > playtime) {
+            m_playlists[index].blank(position - playtime - 1);
+        }
+        if (m_playlists[index].append(*clip) != 0) {
+            ok = false;
+        }
+        playtime = m_playlists[index].get_playtime();
+    }
+    m_playlists[index].unlock();
+    return ok;
+}
+
 bool TrackModel::requestClipInsertion(int clipId, int position, bool updateView, bool finalMove, Fun &undo, Fun &redo, bool groupMove, const QList<int> &allowedClipMixes)
 {
     QWriteLocker locker(&m_lock);
@@ -176,6 +176,22 @@ protected:
     bool requestClipInsertion(int clipId, int position, bool updateView, bool finalMove, Fun &undo, Fun &redo, bool groupMove = false, const QList<int> &allowedClipMixes = {});
     /** @brief This function returns a lambda that performs the requested operation */
     Fun requestClipInsertion_lambda(int clipId, int position, bool updateView, bool finalMove, bool groupMove = false, const QList<int> &allowedClipMixes = {});
+    /** @brief Append a clip at the end of its sub playlist, used when building the timeline from a project file.
+       No check, view update or undo is done: the clips must be adopted in position order, and the caller is responsible for calling
+       checkAdoptedClips once the track is loaded. Returns false if the position is before the end of the sub playlist,
+       the track and the clip are then left unchanged.
+    */
+    bool adoptClip(int clipId, int position);
+    /** @brief Check in one pass over the sub playlists that every clip is at its expected position with its expected length */
+    bool checkAdoptedClips();
+    /** @brief Empty the given sub playlist so that it can be rebuilt in one pass after several clips were moved.
+       The clips stay registered in the track and the playlist stays locked until endPlaylistRebuild is called.
+    */
+    void beginPlaylistRebuild(int index);
+    /** @brief Fill the given sub playlist with the track's clips that belong to it, at their current position, and unlock it.
+       Returns false if some clips overlap, in which case they are not all inserted.
+    */
+    bool endPlaylistRebuild(int index);
 
     /** @brief Performs an deletion of the given clip.
        Returns true if the operation succeeded, and otherwise, the track is not modified.
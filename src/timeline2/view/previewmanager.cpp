@@ -107,6 +107,7 @@ bool PreviewManager::initialize()
 
     connect(this, &PreviewManager::cleanupOldPreviews, this, &PreviewManager::doCleanupOldPreviews);
     connect(doc, &KdenliveDoc::removeInvalidUndo, this, &PreviewManager::slotRemoveInvalidUndo, Qt::DirectConnection);
+    connect(doc, &KdenliveDoc::removeOldestUndo, this, &PreviewManager::slotRemoveOldestUndo, Qt::DirectConnection);
     m_previewTimer.setSingleShot(true);
     m_previewTimer.setInterval(3000);
     connect(&m_previewTimer, &QTimer::timeout, this, &PreviewManager::startPreviewRender);
@@ -666,6 +667,35 @@ void PreviewManager::slotRemoveInvalidUndo(int ix)
     }
 }
 
+void PreviewManager::slotRemoveOldestUndo(int count)
+{
+    QMutexLocker lock(&m_previewMutex);
+    if (m_undoDir.dirName() != QLatin1String("undo")) {
+        // Make sure we delete correct folder
+        return;
+    }
+    QStringList dirs = m_undoDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    // Rename in increasing order, so that a new name is never used by a folder that was not processed yet
+    QCollator collator;
+    collator.setNumericMode(true);
+    std::sort(dirs.begin(), dirs.end(), [&collator](const QString &file1, const QString &file2) { return collator.compare(file1, file2) < 0; });
+    bool ok;
+    for (const QString &dir : qAsConst(dirs)) {
+        int ix = dir.toInt(&ok);
+        if (!ok) {
+            continue;
+        }
+        if (ix < count) {
+            QDir tmp = m_undoDir;
+            if (tmp.cd(dir)) {
+                tmp.removeRecursively();
+            }
+        } else {
+            m_undoDir.rename(dir, QString::number(ix - count));
+        }
+    }
+}
+
 void PreviewManager::invalidatePreview(int startFrame, int endFrame)
 {
     if (m_previewTrack == nullptr) {
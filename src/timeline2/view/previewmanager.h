@@ -124,6 +124,8 @@ private slots:
     void doPreviewRender(const QString &scene); // std::shared_ptr<Mlt::Producer> sourceProd);
     /** @brief: If user does an undo, then makes a new timeline operation, delete undo history of more recent stack . */
     void slotRemoveInvalidUndo(int ix);
+    /** @brief: The oldest commands of the undo stack were removed, delete their history and renumber the others. */
+    void slotRemoveOldestUndo(int count);
     /** @brief: When the timer collecting invalid zones is done, process. */
     void slotProcessDirtyChunks();
     /** @brief: Process preview rendering output. */
@@ -103,6 +103,7 @@ Item {
             id: guideRoot
             property bool activated : proxy.position == model.frame
             z: activated ? 20 : 10
+            visible: model.frame >= root.loadedRangeStart && model.frame <= root.loadedRangeEnd
             Rectangle {
                 id: markerBase
                 width: 1
@@ -29,10 +29,60 @@ Item{
         return type != ProducerType.Composition && type != ProducerType.Track;
     }
 
+    // Whether the item at @row needs a delegate: it is close to the visible part of the timeline, or selected so that dragged items are kept
+    function updateLoadedItem(row) {
+        var entry = trackModel.items.get(row)
+        var data = entry.model
+        var wanted = data.selected || (data.start + data.duration >= root.loadedRangeStart && data.start <= root.loadedRangeEnd)
+        if (entry.inLoaded !== wanted) {
+            entry.inLoaded = wanted
+        }
+    }
+
+    function updateLoadedItems() {
+        for (var i = 0; i < trackModel.items.count; i++) {
+            updateLoadedItem(i)
+        }
+    }
+
     width: clipRow.width
+    Component.onCompleted: updateLoadedItems()
+
+    Connections {
+        target: root
+        onLoadedRangeStartChanged: Qt.callLater(trackRoot.updateLoadedItems)
+        onLoadedRangeEndChanged: Qt.callLater(trackRoot.updateLoadedItems)
+    }
+
+    Connections {
+        target: trackModel.model
+        onDataChanged: {
+            // Items of this track are the children of its row
+            if (!topLeft.parent.valid || topLeft.parent.row !== trackModel.rootIndex.row) {
+                return
+            }
+            for (var i = topLeft.row; i <= bottomRight.row && i < trackModel.items.count; i++) {
+                trackRoot.updateLoadedItem(i)
+            }
+        }
+    }
 
     DelegateModel {
         id: trackModel
+        // Delegates are only created for the items in the loaded group, so that long timelines don't build all their clips
+        groups: DelegateModelGroup {
+            name: "loaded"
+            includeByDefault: false
+        }
+        filterOnGroup: "loaded"
+        items.onChanged: {
+            // Removed items leave the group on their own
+            for (var i = 0; i < inserted.length; i++) {
+                for (var row = inserted[i].index; row < inserted[i].index + inserted[i].count; row++) {
+                    trackRoot.updateLoadedItem(row)
+                }
+            }
+        }
         delegate: Item {
             property var itemModel : model
             property bool clipItem: isClip(model.clipType)
@@ -58,206 +108,445 @@ Item{
                 return 0;
             }
             z: calculateZIndex()
-            Loader {
-                id: loader
-                Binding {
-                    target: loader.item
-                    property: "speed"
-                    value: model.speed
-                    when: loader.status == Loader.Ready && loader.item && clipItem
-                }
-                Binding {
-                    target: loader.item
-                    property: "timeScale"
-                    value: root.timeScale
-                    when: loader.status == Loader.Ready && loader.item
-                }
-                Binding {
-                    target: loader.item
-                    property: "fakeTid"
-                    value: model.fakeTrackId
-                    when: loader.status == Loader.Ready && loader.item && clipItem
-                }
-                Binding {
-                    target: loader.item
-                    property: "tagColor"
-                    value: model.tag
-                    when: loader.status == Loader.Ready && loader.item && clipItem
-                }
-                Binding {
-                    target: loader.item
-                    property: "fakePosition"
-                    value: model.fakePosition
-                    when: loader.status == Loader.Ready && loader.item && clipItem
-                }
-                Binding {
-                    target: loader.item
-                    property: "mixDuration"
-                    value: model.mixDuration
-                    when: loader.status == Loader.Ready && loader.item && clipItem
-                }
-                Binding {
-                    target: loader.item
-                    property: "mixCut"
-                    value: model.mixCut
-                    when: loader.status == Loader.Ready && loader.item && clipItem
-                }
-                Binding {
-                    target: loader.item
-                    property: "selected"
-                    value: model.selected
-                    when: loader.status == Loader.Ready && model.clipType != ProducerType.Track
-                }
-                Binding {
-                    target: loader.item
-                    property: "mltService"
-                    value: model.mlt_service
-                    when: loader.status == Loader.Ready && loader.item
-                }
-                Binding {
-                    target: loader.item
-                    property: "modelStart"
-                    value: model.start
-                    when: loader.status == Loader.Ready && loader.item
-                }
-                Binding {
-                    target: loader.item
-                    property: "scrollX"
-                    value: scrollView.contentX
-                    when: loader.status == Loader.Ready && loader.item
-                }
-                Binding {
-                    target: loader.item
-                    property: "fadeIn"
-                    value: model.fadeIn
-                    when: loader.status == Loader.Ready && clipItem
-                }
-                Binding {
-                    target: loader.item
-                    property: "positionOffset"
-                    value: model.positionOffset
-                    when: loader.status == Loader.Ready && clipItem
-                }
-                Binding {
-                    target: loader.item
-                    property: "effectNames"
-                    value: model.effectNames
-                    when: loader.status == Loader.Ready && clipItem
-                }
-                Binding {
-                    target: loader.item
-                    property: "clipStatus"
-                    value: model.clipStatus
-                    when: loader.status == Loader.Ready && clipItem
-                }
-                Binding {
-                    target: loader.item
-                    property: "fadeOut"
-                    value: model.fadeOut
-                    when: loader.status == Loader.Ready && clipItem
-                }
-                Binding {
-                    target: loader.item
-                    property: "showKeyframes"
-                    value: model.showKeyframes
-                    when: loader.status == Loader.Ready && loader.item
-                }
-                Binding {
-                    target: loader.item
-                    property: "isGrabbed"
-                    value: model.isGrabbed
-                    when: loader.status == Loader.Ready && loader.item
-                }
-                Binding {
-                    target: loader.item
-                    property: "keyframeModel"
-                    value: model.keyframeModel
-                    when: loader.status == Loader.Ready && loader.item
-                }
-                Binding {
-                    target: loader.item
-                    property: "aTrack"
-                    value: model.a_track
-                    when: loader.status == Loader.Ready && model.clipType == ProducerType.Composition
-                }
-                Binding {
-                    target: loader.item
-                    property: "trackHeight"
-                    value: root.trackHeight
-                    when: loader.status == Loader.Ready && model.clipType == ProducerType.Composition
-                }
-                Binding {
-                    target: loader.item
-                    property: "clipDuration"
-                    value: model.duration
-                    when: loader.status == Loader.Ready && loader.item
-                }
-                Binding {
-                    target: loader.item
-                    property: "inPoint"
-                    value: model.in
-                    when: loader.status == Loader.Ready && loader.item
-                }
-                Binding {
-                    target: loader.item
-                    property: "outPoint"
-                    value: model.out
-                    when: loader.status == Loader.Ready && loader.item
-                }
-                Binding {
-                    target: loader.item
-                    property: "grouped"
-                    value: model.grouped
-                    when: loader.status == Loader.Ready && loader.item
-                }
-                Binding {
-                    target: loader.item
-                    property: "clipName"
-                    value: model.name
-                    when: loader.status == Loader.Ready && loader.item
-                }
-                Binding {
-                    target: loader.item
-                    property: "clipResource"
-                    value: model.resource
-                    when: loader.status == Loader.Ready && clipItem
-                }
-                Binding {
-                    target: loader.item
-                    property: "clipState"
-                    value: model.clipState
-                    when: loader.status == Loader.Ready && clipItem
-                }
-                Binding {
-                    target: loader.item
-                    property: "maxDuration"
-                    value: model.maxDuration
-                    when: loader.status == Loader.Ready && clipItem
-                }
-                Binding {
-                    target: loader.item
-                    property: "clipThumbId"
-                    value: model.clipThumbId
-                    when: loader.status == Loader.Ready && clipItem
-                }
-                Binding {
-                    target: loader.item
-                    property: "forceReloadAudioThumb"
-                    value: model.reloadAudioThumb
-                    when: loader.status == Loader.Ready && clipItem
-                }
-                Binding {
-                    target: loader.item
-                    property: "binId"
-                    value: model.binId
-                    when: loader.status == Loader.Ready && clipItem
+            Component.onCompleted: root.itemDelegates++
+            Component.onDestruction: root.itemDelegates--
+            // Declared in the delegate so that the bindings of the loaded item can use its model data
+            Component {
+                id: clipDelegate
+                Clip {
+                    id: loadedClip
+                    height: trackRoot.height
+                    Binding {
+                        target: loadedClip
+                        property: "speed"
+                        value: model.speed
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "timeScale"
+                        value: root.timeScale
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "fakeTid"
+                        value: model.fakeTrackId
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "tagColor"
+                        value: model.tag
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "fakePosition"
+                        value: model.fakePosition
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "mixDuration"
+                        value: model.mixDuration
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "mixCut"
+                        value: model.mixCut
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "selected"
+                        value: model.selected
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "mltService"
+                        value: model.mlt_service
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "modelStart"
+                        value: model.start
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "scrollX"
+                        value: scrollView.contentX
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "fadeIn"
+                        value: model.fadeIn
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "positionOffset"
+                        value: model.positionOffset
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "effectNames"
+                        value: model.effectNames
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "clipStatus"
+                        value: model.clipStatus
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "fadeOut"
+                        value: model.fadeOut
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "showKeyframes"
+                        value: model.showKeyframes
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "isGrabbed"
+                        value: model.isGrabbed
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "keyframeModel"
+                        value: model.keyframeModel
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "clipDuration"
+                        value: model.duration
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "inPoint"
+                        value: model.in
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "outPoint"
+                        value: model.out
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "grouped"
+                        value: model.grouped
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "clipName"
+                        value: model.name
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "clipResource"
+                        value: model.resource
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "clipState"
+                        value: model.clipState
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "maxDuration"
+                        value: model.maxDuration
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "clipThumbId"
+                        value: model.clipThumbId
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "forceReloadAudioThumb"
+                        value: model.reloadAudioThumb
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "binId"
+                        value: model.binId
+                    }
+                    Binding {
+                        target: loadedClip
+                        property: "timeremap"
+                        value: model.timeremap
+                    }
+                    onInitGroupTrim: {
+                        // We are resizing a group, remember coordinates of all elements
+                        root.groupTrimData = controller.getGroupData(clip.clipId)
+                    }
+                    onTrimmingIn: {
+                        if (root.activeTool === ProjectTool.SelectTool && controlTrim) {
+                            newDuration = controller.requestItemSpeedChange(clip.clipId, newDuration, false, root.snapping)
+                            if (!speedController.visible) {
+                                // Store original speed
+                                speedController.originalSpeed = clip.speed
+                            }
+                            clip.x += clip.width - (newDuration * root.timeScale)
+                            clip.width = newDuration * root.timeScale
+                            speedController.x = clip.x + clip.border.width
+                            speedController.width = Math.max(0, clip.width - 2 * clip.border.width)
+                            speedController.lastValidDuration = newDuration
+                            clip.speed = clip.originalDuration * speedController.originalSpeed / newDuration
+                            speedController.visible = true
+                            var s = timeline.simplifiedTC(Math.abs(delta))
+                            s = '%1:%2, %3:%4'.arg(i18n("Speed"))
+                                .arg(clip.speed)
+                                .arg(i18n("Duration"))
+                                .arg(timeline.simplifiedTC(newDuration))
+                            timeline.showToolTip(s)
+                            return
+                        }
+                        var new_duration = 0;
+                        if (root.activeTool === ProjectTool.RippleTool) {
+                            console.log("In: Request for " + newDuration)
+                            new_duration = timeline.requestItemRippleResize(clip.clipId, newDuration, false, false, root.snapping, shiftTrim)
+                            timeline.requestStartTrimmingMode(clip.clipId, false, false);
+                            timeline.ripplePosChanged(new_duration, false);
+                        } else {
+                            new_duration = controller.requestItemResize(clip.clipId, newDuration, false, false, root.snapping, shiftTrim)
+                        }
+
+                        if (new_duration > 0) {
+                            clip.lastValidDuration = new_duration
+                            clip.originalX = clip.draggedX
+                            // Show amount trimmed as a time in a "bubble" help.
+                            var delta = new_duration - clip.originalDuration
+                            var s = timeline.simplifiedTC(Math.abs(delta))
+                            s = '%1%2, %3:%4'.arg((delta <= 0)? '+' : '-')
+                                .arg(s)
+                                .arg(i18n("In"))
+                                .arg(timeline.simplifiedTC(clip.inPoint))
+                            timeline.showToolTip(s)
+                            //bubbleHelp.show(clip.x - 20, trackRoot.y + trackRoot.height, s)
+                        }
+                    }
+                    onTrimmedIn: {
+                        //bubbleHelp.hide()
+                        timeline.showToolTip();
+                        if (shiftTrim || (root.groupTrimData == undefined/*TODO > */ || root.activeTool === ProjectTool.RippleTool /* < TODO*/) || controlTrim) {
+                            // We only resize one element
+                            if (root.activeTool === ProjectTool.RippleTool) {
+                                timeline.requestItemRippleResize(clip.clipId, clip.originalDuration, false, false, 0, shiftTrim)
+                            } else {
+                                controller.requestItemResize(clip.clipId, clip.originalDuration, false, false, 0, shiftTrim)
+                            }
+
+                            if (root.activeTool === ProjectTool.SelectTool && controlTrim) {
+                                // Update speed
+                                speedController.visible = false
+                                controller.requestClipResizeAndTimeWarp(clip.clipId, speedController.lastValidDuration, false, root.snapping, shiftTrim, clip.originalDuration * speedController.originalSpeed / speedController.lastValidDuration)
+                                speedController.originalSpeed = 1
+                            } else {
+                                if (root.activeTool === ProjectTool.RippleTool) {
+                                    timeline.requestItemRippleResize(clip.clipId, clip.lastValidDuration, false, true, 0, shiftTrim)
+                                    timeline.requestEndTrimmingMode();
+                                } else {
+                                    controller.requestItemResize(clip.clipId, clip.lastValidDuration, false, true, 0, shiftTrim)
+                                }
+                            }
+                        } else {
+                            var updatedGroupData = controller.getGroupData(clip.clipId)
+                            controller.processGroupResize(root.groupTrimData, updatedGroupData, false)
+                        }
+                        root.groupTrimData = undefined
+                    }
+                    onTrimmingOut: {
+                        if (root.activeTool === ProjectTool.SelectTool && controlTrim) {
+                            if (!speedController.visible) {
+                                // Store original speed
+                                speedController.originalSpeed = clip.speed
+                            }
+                            speedController.x = clip.x + clip.border.width
+                            newDuration = controller.requestItemSpeedChange(clip.clipId, newDuration, true, root.snapping)
+                            clip.width = newDuration * root.timeScale
+                            speedController.width = Math.max(0, clip.width - 2 * clip.border.width)
+                            speedController.lastValidDuration = newDuration
+                            clip.speed = clip.originalDuration * speedController.originalSpeed / newDuration
+                            speedController.visible = true
+                            var s = '%1:%2\%, %3:%4'.arg(i18n("Speed"))
+                                .arg(Math.round(clip.speed*100))
+                                .arg(i18n("Duration"))
+                                .arg(timeline.simplifiedTC(newDuration))
+                            timeline.showToolTip(s)
+                            return
+                        }
+                        var new_duration = 0;
+                        if (root.activeTool === ProjectTool.RippleTool) {
+                            console.log("Out: Request for " + newDuration)
+                            new_duration = timeline.requestItemRippleResize(clip.clipId, newDuration, true, false, root.snapping, shiftTrim)
+                            timeline.requestStartTrimmingMode(clip.clipId, false, true);
+                            timeline.ripplePosChanged(new_duration, true);
+                        } else {
+                            new_duration = controller.requestItemResize(clip.clipId, newDuration, true, false, root.snapping, shiftTrim)
+                        }
+                        if (new_duration > 0) {
+                            clip.lastValidDuration = new_duration
+                            // Show amount trimmed as a time in a "bubble" help.
+                            var delta = clip.originalDuration - new_duration
+                            var s = timeline.simplifiedTC(Math.abs(delta))
+                            s = '%1%2, %3:%4'.arg((delta <= 0)? '+' : '-')
+                                .arg(s)
+                                .arg(i18n("Duration"))
+                                .arg(timeline.simplifiedTC(new_duration))
+                            timeline.showToolTip(s);
+                            //bubbleHelp.show(clip.x + clip.width - 20, trackRoot.y + trackRoot.height, s)
+                        }
+                    }
+                    onTrimmedOut: {
+                        timeline.showToolTip();
+                        //bubbleHelp.hide()
+                        if (shiftTrim || (root.groupTrimData == undefined/*TODO > */ || root.activeTool === ProjectTool.RippleTool /* < TODO*/) || controlTrim) {
+                            if (root.activeTool === ProjectTool.RippleTool) {
+                                timeline.requestItemRippleResize(clip.clipId, clip.originalDuration, true, false, 0, shiftTrim)
+                            } else {
+                                controller.requestItemResize(clip.clipId, clip.originalDuration, true, false, 0, shiftTrim)
+                            }
+
+                            if (root.activeTool === ProjectTool.SelectTool && controlTrim) {
+                                speedController.visible = false
+                                // Update speed
+                                controller.requestClipResizeAndTimeWarp(clip.clipId, speedController.lastValidDuration, true, root.snapping, shiftTrim, clip.originalDuration * speedController.originalSpeed / speedController.lastValidDuration)
+                                speedController.originalSpeed = 1
+                            } else {
+                                if (root.activeTool === ProjectTool.RippleTool) {
+                                    timeline.requestItemRippleResize(clip.clipId, clip.lastValidDuration, true, true, 0, shiftTrim)
+                                    timeline.requestEndTrimmingMode();
+                                } else {
+                                    controller.requestItemResize(clip.clipId, clip.lastValidDuration, true, true, 0, shiftTrim)
+                                }
+                            }
+                        } else {
+                            var updatedGroupData = controller.getGroupData(clip.clipId)
+                            controller.processGroupResize(root.groupTrimData, updatedGroupData, true)
+                        }
+                        root.groupTrimData = undefined
+                    }
                 }
-                Binding {
-                    target: loader.item
-                    property: "timeremap"
-                    value: model.timeremap
-                    when: loader.status == Loader.Ready && clipItem
+            }
+            Component {
+                id: compositionDelegate
+                Composition {
+                    id: loadedComposition
+                    displayHeight: Math.max(trackRoot.height / 2, trackRoot.height - (root.baseUnit * 2))
+                    opacity: 0.8
+                    selected: root.timelineSelection.indexOf(clipId) != -1
+                    Binding {
+                        target: loadedComposition
+                        property: "timeScale"
+                        value: root.timeScale
+                    }
+                    Binding {
+                        target: loadedComposition
+                        property: "selected"
+                        value: model.selected
+                    }
+                    Binding {
+                        target: loadedComposition
+                        property: "mltService"
+                        value: model.mlt_service
+                    }
+                    Binding {
+                        target: loadedComposition
+                        property: "modelStart"
+                        value: model.start
+                    }
+                    Binding {
+                        target: loadedComposition
+                        property: "scrollX"
+                        value: scrollView.contentX
+                    }
+                    Binding {
+                        target: loadedComposition
+                        property: "showKeyframes"
+                        value: model.showKeyframes
+                    }
+                    Binding {
+                        target: loadedComposition
+                        property: "isGrabbed"
+                        value: model.isGrabbed
+                    }
+                    Binding {
+                        target: loadedComposition
+                        property: "keyframeModel"
+                        value: model.keyframeModel
+                    }
+                    Binding {
+                        target: loadedComposition
+                        property: "aTrack"
+                        value: model.a_track
+                    }
+                    Binding {
+                        target: loadedComposition
+                        property: "trackHeight"
+                        value: root.trackHeight
+                    }
+                    Binding {
+                        target: loadedComposition
+                        property: "clipDuration"
+                        value: model.duration
+                    }
+                    Binding {
+                        target: loadedComposition
+                        property: "inPoint"
+                        value: model.in
+                    }
+                    Binding {
+                        target: loadedComposition
+                        property: "outPoint"
+                        value: model.out
+                    }
+                    Binding {
+                        target: loadedComposition
+                        property: "grouped"
+                        value: model.grouped
+                    }
+                    Binding {
+                        target: loadedComposition
+                        property: "clipName"
+                        value: model.name
+                    }
+                    onTrimmingIn: {
+                        var new_duration = controller.requestItemResize(clip.clipId, newDuration, false, false, root.snapping)
+                        if (new_duration > 0) {
+                            clip.lastValidDuration = newDuration
+                            clip.originalX = clip.draggedX
+                            // Show amount trimmed as a time in a "bubble" help.
+                            var delta = clip.originalDuration - new_duration
+                            var s = timeline.simplifiedTC(Math.abs(delta))
+                            s = i18n("%1%2, Duration = %3", ((delta <= 0)? '+' : '-')
+                                , s, timeline.simplifiedTC(new_duration))
+                            timeline.showToolTip(s)
+                        }
+                    }
+                    onTrimmedIn: {
+                        timeline.showToolTip()
+                        //bubbleHelp.hide()
+                        controller.requestItemResize(clip.clipId, clip.originalDuration, false, false, root.snapping)
+                        controller.requestItemResize(clip.clipId, clip.lastValidDuration, false, true, root.snapping)
+                    }
+                    onTrimmingOut: {
+                        var new_duration = controller.requestItemResize(clip.clipId, newDuration, true, false, root.snapping)
+                        if (new_duration > 0) {
+                            clip.lastValidDuration = newDuration
+                            // Show amount trimmed as a time in a "bubble" help.
+                            var delta = clip.originalDuration - new_duration
+                            var s = timeline.simplifiedTC(Math.abs(delta))
+                            s = i18n("%1%2, Duration = %3", ((delta <= 0)? '+' : '-')
+                                , s, timeline.simplifiedTC(new_duration))
+                            timeline.showToolTip(s)
+                        }
+                    }
+                    onTrimmedOut: {
+                        timeline.showToolTip()
+                        //bubbleHelp.hide()
+                        controller.requestItemResize(clip.clipId, clip.originalDuration, true, false, root.snapping)
+                        controller.requestItemResize(clip.clipId, clip.lastValidDuration, true, true, root.snapping)
+                    }
                 }
+            }
+            Loader {
+                id: loader
                 sourceComponent: {
                     if (clipItem) {
                         return clipDelegate
@@ -272,7 +561,6 @@ Item{
                     item.clipId= model.item
                     item.parentTrack = trackRoot
                     if (clipItem) {
-                        console.log('loaded clip: ', model.start, ', ID: ', model.item, ', index: ', trackRoot.DelegateModel.itemsIndex,', TYPE:', model.clipType)
                         item.isAudio= model.audio
                         item.markers= model.markers
                         item.hasAudio = model.hasAudio
@@ -283,9 +571,7 @@ Item{
                         item.audioStream = model.audioStream
                         item.multiStream = model.multiStream
                         item.aStreamIndex = model.audioStreamIndex
-                        console.log('loaded clip with Astream: ', model.audioStream)                       
                     } else if (model.clipType == ProducerType.Composition) {
-                        console.log('loaded composition: ', model.start, ', ID: ', model.item, ', index: ', trackRoot.DelegateModel.itemsIndex)
                         //item.aTrack = model.a_track
                     } else {
                         console.log('loaded unwanted element: ', model.item, ', index: ', trackRoot.DelegateModel.itemsIndex)
@@ -304,208 +590,6 @@ Item{
         Repeater { id: repeater; model: trackModel }
     }
 
-    Component {
-        id: clipDelegate
-        Clip {
-            height: trackRoot.height
-            onInitGroupTrim: {
-                // We are resizing a group, remember coordinates of all elements
-                root.groupTrimData = controller.getGroupData(clip.clipId)
-            }
-            onTrimmingIn: {
-                if (root.activeTool === ProjectTool.SelectTool && controlTrim) {
-                    newDuration = controller.requestItemSpeedChange(clip.clipId, newDuration, false, root.snapping)
-                    if (!speedController.visible) {
-                        // Store original speed
-                        speedController.originalSpeed = clip.speed
-                    }
-                    clip.x += clip.width - (newDuration * root.timeScale)
-                    clip.width = newDuration * root.timeScale
-                    speedController.x = clip.x + clip.border.width
-                    speedController.width = Math.max(0, clip.width - 2 * clip.border.width)
-                    speedController.lastValidDuration = newDuration
-                    clip.speed = clip.originalDuration * speedController.originalSpeed / newDuration
-                    speedController.visible = true
-                    var s = timeline.simplifiedTC(Math.abs(delta))
-                    s = '%1:%2, %3:%4'.arg(i18n("Speed"))
-                        .arg(clip.speed)
-                        .arg(i18n("Duration"))
-                        .arg(timeline.simplifiedTC(newDuration))
-                    timeline.showToolTip(s)
-                    return
-                }
-                var new_duration = 0;
-                if (root.activeTool === ProjectTool.RippleTool) {
-                    console.log("In: Request for " + newDuration)
-                    new_duration = timeline.requestItemRippleResize(clip.clipId, newDuration, false, false, root.snapping, shiftTrim)
-                    timeline.requestStartTrimmingMode(clip.clipId, false, false);
-                    timeline.ripplePosChanged(new_duration, false);
-                } else {
-                    new_duration = controller.requestItemResize(clip.clipId, newDuration, false, false, root.snapping, shiftTrim)
-                }
-
-                if (new_duration > 0) {
-                    clip.lastValidDuration = new_duration
-                    clip.originalX = clip.draggedX
-                    // Show amount trimmed as a time in a "bubble" help.
-                    var delta = new_duration - clip.originalDuration
-                    var s = timeline.simplifiedTC(Math.abs(delta))
-                    s = '%1%2, %3:%4'.arg((delta <= 0)? '+' : '-')
-                        .arg(s)
-                        .arg(i18n("In"))
-                        .arg(timeline.simplifiedTC(clip.inPoint))
-                    timeline.showToolTip(s)
-                    //bubbleHelp.show(clip.x - 20, trackRoot.y + trackRoot.height, s)
-                }
-            }
-            onTrimmedIn: {
-                //bubbleHelp.hide()
-                timeline.showToolTip();
-                if (shiftTrim || (root.groupTrimData == undefined/*TODO > */ || root.activeTool === ProjectTool.RippleTool /* < TODO*/) || controlTrim) {
-                    // We only resize one element
-                    if (root.activeTool === ProjectTool.RippleTool) {
-                        timeline.requestItemRippleResize(clip.clipId, clip.originalDuration, false, false, 0, shiftTrim)
-                    } else {
-                        controller.requestItemResize(clip.clipId, clip.originalDuration, false, false, 0, shiftTrim)
-                    }
-
-                    if (root.activeTool === ProjectTool.SelectTool && controlTrim) {
-                        // Update speed
-                        speedController.visible = false
-                        controller.requestClipResizeAndTimeWarp(clip.clipId, speedController.lastValidDuration, false, root.snapping, shiftTrim, clip.originalDuration * speedController.originalSpeed / speedController.lastValidDuration)
-                        speedController.originalSpeed = 1
-                    } else {
-                        if (root.activeTool === ProjectTool.RippleTool) {
-                            timeline.requestItemRippleResize(clip.clipId, clip.lastValidDuration, false, true, 0, shiftTrim)
-                            timeline.requestEndTrimmingMode();
-                        } else {
-                            controller.requestItemResize(clip.clipId, clip.lastValidDuration, false, true, 0, shiftTrim)
-                        }
-                    }
-                } else {
-                    var updatedGroupData = controller.getGroupData(clip.clipId)
-                    controller.processGroupResize(root.groupTrimData, updatedGroupData, false)
-                }
-                root.groupTrimData = undefined
-            }
-            onTrimmingOut: {
-                if (root.activeTool === ProjectTool.SelectTool && controlTrim) {
-                    if (!speedController.visible) {
-                        // Store original speed
-                        speedController.originalSpeed = clip.speed
-                    }
-                    speedController.x = clip.x + clip.border.width
-                    newDuration = controller.requestItemSpeedChange(clip.clipId, newDuration, true, root.snapping)
-                    clip.width = newDuration * root.timeScale
-                    speedController.width = Math.max(0, clip.width - 2 * clip.border.width)
-                    speedController.lastValidDuration = newDuration
-                    clip.speed = clip.originalDuration * speedController.originalSpeed / newDuration
-                    speedController.visible = true
-                    var s = '%1:%2\%, %3:%4'.arg(i18n("Speed"))
-                        .arg(Math.round(clip.speed*100))
-                        .arg(i18n("Duration"))
-                        .arg(timeline.simplifiedTC(newDuration))
-                    timeline.showToolTip(s)
-                    return
-                }
-                var new_duration = 0;
-                if (root.activeTool === ProjectTool.RippleTool) {
-                    console.log("Out: Request for " + newDuration)
-                    new_duration = timeline.requestItemRippleResize(clip.clipId, newDuration, true, false, root.snapping, shiftTrim)
-                    timeline.requestStartTrimmingMode(clip.clipId, false, true);
-                    timeline.ripplePosChanged(new_duration, true);
-                } else {
-                    new_duration = controller.requestItemResize(clip.clipId, newDuration, true, false, root.snapping, shiftTrim)
-                }
-                if (new_duration > 0) {
-                    clip.lastValidDuration = new_duration
-                    // Show amount trimmed as a time in a "bubble" help.
-                    var delta = clip.originalDuration - new_duration
-                    var s = timeline.simplifiedTC(Math.abs(delta))
-                    s = '%1%2, %3:%4'.arg((delta <= 0)? '+' : '-')
-                        .arg(s)
-                        .arg(i18n("Duration"))
-                        .arg(timeline.simplifiedTC(new_duration))
-                    timeline.showToolTip(s);
-                    //bubbleHelp.show(clip.x + clip.width - 20, trackRoot.y + trackRoot.height, s)
-                }
-            }
-            onTrimmedOut: {
-                timeline.showToolTip();
-                //bubbleHelp.hide()
-                if (shiftTrim || (root.groupTrimData == undefined/*TODO > */ || root.activeTool === ProjectTool.RippleTool /* < TODO*/) || controlTrim) {
-                    if (root.activeTool === ProjectTool.RippleTool) {
-                        timeline.requestItemRippleResize(clip.clipId, clip.originalDuration, true, false, 0, shiftTrim)
-                    } else {
-                        controller.requestItemResize(clip.clipId, clip.originalDuration, true, false, 0, shiftTrim)
-                    }
-
-                    if (root.activeTool === ProjectTool.SelectTool && controlTrim) {
-                        speedController.visible = false
-                        // Update speed
-                        controller.requestClipResizeAndTimeWarp(clip.clipId, speedController.lastValidDuration, true, root.snapping, shiftTrim, clip.originalDuration * speedController.originalSpeed / speedController.lastValidDuration)
-                        speedController.originalSpeed = 1
-                    } else {
-                        if (root.activeTool === ProjectTool.RippleTool) {
-                            timeline.requestItemRippleResize(clip.clipId, clip.lastValidDuration, true, true, 0, shiftTrim)
-                            timeline.requestEndTrimmingMode();
-                        } else {
-                            controller.requestItemResize(clip.clipId, clip.lastValidDuration, true, true, 0, shiftTrim)
-                        }
-                    }
-                } else {
-                    var updatedGroupData = controller.getGroupData(clip.clipId)
-                    controller.processGroupResize(root.groupTrimData, updatedGroupData, true)
-                }
-                root.groupTrimData = undefined
-            }
-        }
-    }
-    Component {
-        id: compositionDelegate
-        Composition {
-            displayHeight: Math.max(trackRoot.height / 2, trackRoot.height - (root.baseUnit * 2))
-            opacity: 0.8
-            selected: root.timelineSelection.indexOf(clipId) != -1
-            onTrimmingIn: {
-                var new_duration = controller.requestItemResize(clip.clipId, newDuration, false, false, root.snapping)
-                if (new_duration > 0) {
-                    clip.lastValidDuration = newDuration
-                    clip.originalX = clip.draggedX
-                    // Show amount trimmed as a time in a "bubble" help.
-                    var delta = clip.originalDuration - new_duration
-                    var s = timeline.simplifiedTC(Math.abs(delta))
-                    s = i18n("%1%2, Duration = %3", ((delta <= 0)? '+' : '-')
-                        , s, timeline.simplifiedTC(new_duration))
-                    timeline.showToolTip(s)
-                }
-            }
-            onTrimmedIn: {
-                timeline.showToolTip()
-                //bubbleHelp.hide()
-                controller.requestItemResize(clip.clipId, clip.originalDuration, false, false, root.snapping)
-                controller.requestItemResize(clip.clipId, clip.lastValidDuration, false, true, root.snapping)
-            }
-            onTrimmingOut: {
-                var new_duration = controller.requestItemResize(clip.clipId, newDuration, true, false, root.snapping)
-                if (new_duration > 0) {
-                    clip.lastValidDuration = newDuration
-                    // Show amount trimmed as a time in a "bubble" help.
-                    var delta = clip.originalDuration - new_duration
-                    var s = timeline.simplifiedTC(Math.abs(delta))
-                    s = i18n("%1%2, Duration = %3", ((delta <= 0)? '+' : '-')
-                        , s, timeline.simplifiedTC(new_duration))
-                    timeline.showToolTip(s)
-                }
-            }
-            onTrimmedOut: {
-                timeline.showToolTip()
-                //bubbleHelp.hide()
-                controller.requestItemResize(clip.clipId, clip.originalDuration, true, false, root.snapping)
-                controller.requestItemResize(clip.clipId, clip.lastValidDuration, true, true, root.snapping)
-            }
-        }
-    }
     Rectangle {
         id: speedController
         anchors.bottom: parent.bottom
@@ -456,6 +456,13 @@ Rectangle {
     property bool seekingFinished : proxy.seekFinished
     property int scrollMin: scrollView.contentX / root.timeScale
     property int scrollMax: scrollMin + scrollView.contentItem.width / root.timeScale
+    // Timeline items are only instantiated in this range: the visible page and about one page on each side.
+    // It only changes when scrolling crosses a page boundary, to avoid updating the tracks' loaded items on each scroll step.
+    property int visibleFrames: Math.max(1, scrollMax - scrollMin)
+    property int loadedRangeStart: Math.max(0, (Math.floor(scrollMin / visibleFrames) - 1) * visibleFrames)
+    property int loadedRangeEnd: (Math.floor(scrollMin / visibleFrames) + 3) * visibleFrames
+    // Diagnostics: number of instantiated clip and composition delegates
+    property int itemDelegates: 0
     property double dar: 16/9
     property bool paletteUnchanged: true
     property int maxLabelWidth: 20 * root.baseUnit * Math.sqrt(root.timeScale)
@@ -2096,6 +2103,7 @@ Rectangle {
         Item {
             id: guideRoot
             z: 20
+            visible: model.frame >= root.loadedRangeStart && model.frame <= root.loadedRangeEnd
             Rectangle {
                 id: guideBase
                 width: 1
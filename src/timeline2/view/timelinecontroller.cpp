@@ -2595,7 +2595,7 @@ void TimelineController::removeSpace(int trackId, int frame, bool affectAllTrack
 
 void TimelineController::invalidateItem(int cid)
 {
-    if (!m_timelinePreview || !m_model->isItem(cid)) {
+    if (!m_model->isItem(cid)) {
         return;
     }
     const int tid = m_model->getItemTrackId(cid);
@@ -2604,12 +2604,15 @@ void TimelineController::invalidateItem(int cid)
     }
     int start = m_model->getItemPosition(cid);
     int end = start + m_model->getItemPlaytime(cid);
-    m_timelinePreview->invalidatePreview(start, end);
+    pCore->monitorManager()->projectMonitor()->invalidateFrameCache(start, end);
+    if (m_timelinePreview) {
+        m_timelinePreview->invalidatePreview(start, end);
+    }
 }
 
 void TimelineController::invalidateTrack(int tid)
 {
-    if (!m_timelinePreview || !m_model->isTrack(tid) || m_model->getTrackById_const(tid)->isAudioTrack()) {
+    if (!m_model->isTrack(tid) || m_model->getTrackById_const(tid)->isAudioTrack()) {
         return;
     }
     for (const auto &clp : m_model->getTrackById_const(tid)->m_allClips) {
@@ -2619,6 +2622,7 @@ void TimelineController::invalidateTrack(int tid)
 
 void TimelineController::invalidateZone(int in, int out)
 {
+    pCore->monitorManager()->projectMonitor()->invalidateFrameCache(in, out == -1 ? m_duration : out);
     if (!m_timelinePreview) {
         return;
     }
@@ -24,6 +24,7 @@
 #include "timelinecontroller.h"
 #include "timelinewidget.h"
 #include "utils/clipboardproxy.hpp"
+#include "utils/startuptimeline.hpp"
 
 #include <KDeclarative/KDeclarative>
 // #include <QUrl>
@@ -34,6 +35,7 @@
 #include <QQmlContext>
 #include <QQmlEngine>
 #include <QQuickItem>
+#include <QQuickWindow>
 #include <QSortFilterProxyModel>
 #include <QUuid>
 
@@ -172,6 +174,17 @@ void TimelineWidget::setModel(const std::shared_ptr<TimelineItemModel> &model, M
     const QStringList trans = sortedItems(KdenliveSettings::favorite_transitions(), true).values();
 
     setSource(QUrl(QStringLiteral("qrc:/qml/timeline.qml")));
+    if (!StartupTimeline::isFinished()) {
+        StartupTimeline::mark(QStringLiteral("Timeline loaded"));
+        auto connection = std::make_shared<QMetaObject::Connection>();
+        *connection = connect(
+            quickWindow(), &QQuickWindow::afterRendering, this,
+            [connection]() {
+                QObject::disconnect(*connection);
+                StartupTimeline::finish(QStringLiteral("First timeline paint"));
+            },
+            Qt::QueuedConnection);
+    }
     connect(rootObject(), SIGNAL(mousePosChanged(int)), pCore->window(), SLOT(slotUpdateMousePosition(int)));
     connect(rootObject(), SIGNAL(zoomIn(bool)), pCore->window(), SLOT(slotZoomIn(bool)));
     connect(rootObject(), SIGNAL(zoomOut(bool)), pCore->window(), SLOT(slotZoomOut(bool)));
@@ -8,14 +8,66 @@
 #include "logger.hpp"
 #endif
 #include <QDebug>
+#include <algorithm>
 #include <utility>
-FunctionalUndoCommand::FunctionalUndoCommand(Fun undo, Fun redo, const QString &text, QUndoCommand *parent)
+#include <vector>
+
+namespace {
+// Payloads attached on this thread that were not collected by a command yet
+thread_local std::vector<std::weak_ptr<UndoPayload>> pendingPayloads;
+} // namespace
+
+UndoPayload::UndoPayload(qint64 bytes)
+    : m_bytes(bytes)
+{
+}
+
+Fun UndoPayload::attach(Fun operation, qint64 bytes)
+{
+    auto payload = std::make_shared<UndoPayload>(bytes);
+    if (pendingPayloads.size() >= 256) {
+        // Drop the payloads of operations that were never pushed on the stack
+        pendingPayloads.erase(std::remove_if(pendingPayloads.begin(), pendingPayloads.end(), [](const std::weak_ptr<UndoPayload> &p) { return p.expired(); }),
+                              pendingPayloads.end());
+    }
+    pendingPayloads.push_back(payload);
+    return [operation = std::move(operation), payload]() {
+        Q_UNUSED(payload)
+        return operation();
+    };
+}
+
+qint64 UndoPayload::collect()
+{
+    qint64 total = 0;
+    for (const auto &p : pendingPayloads) {
+        if (auto payload = p.lock()) {
+            total += payload->m_bytes;
+        }
+    }
+    pendingPayloads.clear();
+    return total;
+}
+
+qint64 UndoPayload::stringSize(const QString &value)
+{
+    return qint64(sizeof(QString)) + value.capacity() * qint64(sizeof(QChar));
+}
+
+MeasuredUndoCommand::MeasuredUndoCommand(QUndoCommand *parent)
     : QUndoCommand(parent)
+{
+}
+
+FunctionalUndoCommand::FunctionalUndoCommand(Fun undo, Fun redo, const QString &text, QUndoCommand *parent)
+    : MeasuredUndoCommand(parent)
     , m_undo(std::move(undo))
     , m_redo(std::move(redo))
     , m_undone(false)
+    , m_memoryCost(qint64(sizeof(FunctionalUndoCommand)) + UndoPayload::collect())
 {
     setText(text);
+    m_stamp.start();
 }
 
 void FunctionalUndoCommand::undo()
@@ -40,3 +92,48 @@ void FunctionalUndoCommand::redo()
         Q_ASSERT(res);
     }
 }
+
+int FunctionalUndoCommand::id() const
+{
+    // Ids 1 to 3 are used by the asset commands
+    return m_mergeKey.isEmpty() ? -1 : 100;
+}
+
+bool FunctionalUndoCommand::mergeWith(const QUndoCommand *other)
+{
+    if (other->id() != id()) {
+        return false;
+    }
+    auto *command = static_cast<const FunctionalUndoCommand *>(other);
+    if (command->m_mergeKey != m_nextMergeKey || m_stamp.elapsed() - command->m_stamp.elapsed() > MergeDelay) {
+        return false;
+    }
+    // Undo the latest operation first
+    Fun undo = m_undo;
+    Fun redo = m_redo;
+    Fun otherUndo = command->m_undo;
+    Fun otherRedo = command->m_redo;
+    m_undo = [undo, otherUndo]() { return otherUndo() && undo(); };
+    m_redo = [redo, otherRedo]() { return redo() && otherRedo(); };
+    m_memoryCost += command->m_memoryCost;
+    m_nextMergeKey = command->m_nextMergeKey;
+    // Restart the merge delay so that a long drag is merged as a single operation
+    m_stamp.start();
+    return true;
+}
+
+void FunctionalUndoCommand::setMergeKey(const QString &key, const QString &nextKey)
+{
+    m_mergeKey = key;
+    m_nextMergeKey = nextKey.isEmpty() ? key : nextKey;
+}
+
+void FunctionalUndoCommand::addMemoryCost(qint64 bytes)
+{
+    m_memoryCost += bytes;
+}
+
+qint64 FunctionalUndoCommand::memoryCost() const
+{
+    return m_memoryCost + text().size() * qint64(sizeof(QChar));
+}
@@ -25,21 +25,68 @@ using Fun = std::function<bool(void)>;
         return v && lambda();                                                                                                                                  \
     };
 
+#include <QElapsedTimer>
 #include <QUndoCommand>
+#include <memory>
+
+/** @brief Size of some state captured by an undo lambda (xml, effect parameters, keyframe values).
+  A payload is registered with attach(): it lives as long as the lambda holding it, and the
+  FunctionalUndoCommand built next on the same thread collects the payloads still alive as its memory cost.
+ */
+class UndoPayload
+{
+public:
+    explicit UndoPayload(qint64 bytes);
+    /** @brief Returns a lambda calling @param operation that accounts for @param bytes of captured state */
+    static Fun attach(Fun operation, qint64 bytes);
+    /** @brief Sum of the payloads attached since the last call that are still alive */
+    static qint64 collect();
+    /** @brief Memory used by a string captured in a lambda */
+    static qint64 stringSize(const QString &value);
+
+private:
+    qint64 m_bytes;
+};
+
+/** @brief Base class of the undo commands whose memory usage is accounted by DocUndoStack
+ */
+class MeasuredUndoCommand : public QUndoCommand
+{
+public:
+    explicit MeasuredUndoCommand(QUndoCommand *parent = nullptr);
+    /** @brief Number of bytes kept alive by this command */
+    virtual qint64 memoryCost() const = 0;
+};
 
 /** @brief this is a generic class that takes fonctors as undo and redo actions. It just executes them when required by Qt
   Note that QUndoStack actually executes redo() when we push the undoCommand to the stack
   This is bad for us because we execute the command as we construct the undo Function. So to prevent it to be executed twice, there is a small hack in this
   command that prevent redoing if it has not been undone before.
  */
-class FunctionalUndoCommand : public QUndoCommand
+class FunctionalUndoCommand : public MeasuredUndoCommand
 {
 public:
     FunctionalUndoCommand(Fun undo, Fun redo, const QString &text, QUndoCommand *parent = nullptr);
     void undo() override;
     void redo() override;
+    int id() const override;
+    /** @brief Consecutive commands with the same non empty merge key, pushed within a short delay, are merged in a single entry */
+    bool mergeWith(const QUndoCommand *other) override;
+    /** @brief Set the merge key of this command. If @param nextKey is not empty, only a command with this key can be merged after this one,
+        so that a chain of operations on a changing item (like successive moves of a keyframe) ends up in one entry */
+    void setMergeKey(const QString &key, const QString &nextKey = QString());
+    /** @brief Account for memory held by the lambdas that was not registered as an UndoPayload */
+    void addMemoryCost(qint64 bytes);
+    qint64 memoryCost() const override;
+
+    /** @brief Maximum delay between two commands to allow merging them */
+    static const int MergeDelay = 3000;
 
 private:
     Fun m_undo, m_redo;
     bool m_undone;
+    QString m_mergeKey;
+    QString m_nextMergeKey;
+    QElapsedTimer m_stamp;
+    qint64 m_memoryCost;
 };
@@ -0,0 +1,108 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "audiopeaks.h"
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KDENLIVE_AUDIOPEAKS_SSE2
+#include <emmintrin.h>
+#endif
+
+static std::atomic<bool> s_forceScalar(false);
+
+// Absolute value saturated to 32767, like the saturating SSE2 subtraction
+static inline int absSample(int16_t value)
+{
+    return value == -32768 ? 32767 : (value < 0 ? -value : value);
+}
+
+#ifdef KDENLIVE_AUDIOPEAKS_SSE2
+// Processes 8 samples per iteration, so each lane always holds the same channel when 8 is a multiple of the channel count.
+// Returns the number of samples per channel that were processed
+static int channelPeaksSse2(const int16_t *samples, int sampleCount, int channels, int *peaks)
+{
+    const int framesPerVector = 8 / channels;
+    const int vectors = sampleCount / framesPerVector;
+    const __m128i zero = _mm_setzero_si128();
+    __m128i maxima = zero;
+    for (int i = 0; i < vectors; ++i) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i * 8));
+        // max(x, -x), the saturating subtraction maps -32768 to 32767
+        maxima = _mm_max_epi16(maxima, _mm_max_epi16(in, _mm_subs_epi16(zero, in)));
+    }
+    alignas(16) int16_t lanes[8];
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes), maxima);
+    for (int lane = 0; lane < 8; ++lane) {
+        peaks[lane % channels] = qMax(peaks[lane % channels], int(lanes[lane]));
+    }
+    return vectors * framesPerVector;
+}
+#endif
+
+bool AudioPeaks::useSimd()
+{
+#ifdef KDENLIVE_AUDIOPEAKS_SSE2
+    return !s_forceScalar;
+#else
+    return false;
+#endif
+}
+
+void AudioPeaks::setForceScalar(bool force)
+{
+    s_forceScalar = force;
+}
+
+void AudioPeaks::channelPeaks(const int16_t *samples, int sampleCount, int channels, int *peaks)
+{
+    for (int channel = 0; channel < channels; ++channel) {
+        peaks[channel] = 0;
+    }
+    int frame = 0;
+#ifdef KDENLIVE_AUDIOPEAKS_SSE2
+    if (useSimd() && channels > 0 && 8 % channels == 0) {
+        frame = channelPeaksSse2(samples, sampleCount, channels, peaks);
+    }
+#endif
+    for (; frame < sampleCount; ++frame) {
+        const int16_t *in = samples + frame * channels;
+        for (int channel = 0; channel < channels; ++channel) {
+            peaks[channel] = qMax(peaks[channel], absSample(in[channel]));
+        }
+    }
+}
+
+uint8_t AudioPeaks::level(int peak)
+{
+    if (peak <= 0) {
+        return 0;
+    }
+    // Same scale as the audio mixer meters
+    const double dB = 20. * std::log10(peak / 32768.);
+    double scale = 1.;
+    if (dB < -70.) {
+        scale = 0.;
+    } else if (dB < -60.) {
+        scale = (dB + 70.) * 0.0025;
+    } else if (dB < -50.) {
+        scale = (dB + 60.) * 0.005 + 0.025;
+    } else if (dB < -40.) {
+        scale = (dB + 50.) * 0.0075 + 0.075;
+    } else if (dB < -30.) {
+        scale = (dB + 40.) * 0.015 + 0.15;
+    } else if (dB < -20.) {
+        scale = (dB + 30.) * 0.02 + 0.3;
+    } else if (dB < -0.001 || dB > 0.001) {
+        scale = (dB + 20.) * 0.025 + 0.5;
+    }
+    // Same mapping as the values produced by the audiolevel filter in AudioLevelsTask
+    return uint8_t(256 * qMin(scale * 0.9, 1.0));
+}
@@ -0,0 +1,30 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <cstdint>
+
+/** @class AudioPeaks
+    @brief Peak computation on interleaved 16 bit audio, used to build the audio thumbnails.
+    An SSE2 implementation is used when available for 1, 2, 4 and 8 channels, with a scalar fallback that produces identical results.
+ */
+class AudioPeaks
+{
+public:
+    /** @brief Compute the peak absolute value (0-32767) of each channel
+       @param samples interleaved samples, @param sampleCount samples per channel
+       @param peaks receives @param channels values
+     */
+    static void channelPeaks(const int16_t *samples, int sampleCount, int channels, int *peaks);
+    /** @brief The 0-255 audio thumbnail value of a peak, on the IEC scale used by the audio mixer */
+    static uint8_t level(int peak);
+    /** @brief Use the scalar code even if SSE2 is available */
+    static void setForceScalar(bool force);
+
+private:
+    static bool useSimd();
+};
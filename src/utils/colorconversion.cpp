@@ -0,0 +1,286 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "colorconversion.h"
+
+#include <QMutexLocker>
+#include <QRgb>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KDENLIVE_COLORCONVERSION_SSE2
+#include <emmintrin.h>
+#endif
+
+static std::atomic<bool> s_forceScalar(false);
+
+static inline int clamp8(int value)
+{
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+// BT.601 limited range coefficients with 6 bits of precision, so that the SIMD version can work on 16 bit integers.
+// The luma factor is rounded up (75 instead of 74.5) so that nominal white maps to 255
+static inline QRgb yuvToRgb(int y, int u, int v)
+{
+    const int c = 75 * (y - 16) + 32;
+    const int d = u - 128;
+    const int e = v - 128;
+    return qRgb(clamp8((c + 102 * e) >> 6), clamp8((c - 25 * d - 52 * e) >> 6), clamp8((c + 129 * d) >> 6));
+}
+
+static void packedToRgb32Scalar(const uchar *src, uchar *dst, int x, int width, bool uyvy)
+{
+    auto *out = reinterpret_cast<QRgb *>(dst);
+    const int yOffset = uyvy ? 1 : 0;
+    const int uOffset = uyvy ? 0 : 1;
+    for (; x < width; x += 2) {
+        const uchar *pair = src + x * 2;
+        const int u = pair[uOffset];
+        const int v = pair[uOffset + 2];
+        out[x] = yuvToRgb(pair[yOffset], u, v);
+        if (x + 1 < width) {
+            out[x + 1] = yuvToRgb(pair[yOffset + 2], u, v);
+        }
+    }
+}
+
+#ifdef KDENLIVE_COLORCONVERSION_SSE2
+static inline void yuvToRgb16(__m128i y, __m128i u, __m128i v, __m128i &r, __m128i &g, __m128i &b)
+{
+    // Saturating adds are fine here, a saturated value is out of the 0-255 range after the shift anyways
+    const __m128i c = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(y, _mm_set1_epi16(16)), _mm_set1_epi16(75)), _mm_set1_epi16(32));
+    const __m128i d = _mm_sub_epi16(u, _mm_set1_epi16(128));
+    const __m128i e = _mm_sub_epi16(v, _mm_set1_epi16(128));
+    r = _mm_srai_epi16(_mm_adds_epi16(c, _mm_mullo_epi16(e, _mm_set1_epi16(102))), 6);
+    g = _mm_srai_epi16(_mm_subs_epi16(_mm_subs_epi16(c, _mm_mullo_epi16(d, _mm_set1_epi16(25))), _mm_mullo_epi16(e, _mm_set1_epi16(52))), 6);
+    b = _mm_srai_epi16(_mm_adds_epi16(c, _mm_mullo_epi16(d, _mm_set1_epi16(129))), 6);
+}
+
+/** @brief Store 8 pixels as B G R A bytes, which is QImage::Format_RGB32 on little endian */
+static inline void storeRgb32(__m128i r, __m128i g, __m128i b, uchar *dst)
+{
+    const __m128i r8 = _mm_packus_epi16(r, r);
+    const __m128i g8 = _mm_packus_epi16(g, g);
+    const __m128i b8 = _mm_packus_epi16(b, b);
+    const __m128i bg = _mm_unpacklo_epi8(b8, g8);
+    const __m128i ra = _mm_unpacklo_epi8(r8, _mm_set1_epi8(char(0xff)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 16), _mm_unpackhi_epi16(bg, ra));
+}
+
+static int packedToRgb32Sse2(const uchar *src, uchar *dst, int width, bool uyvy)
+{
+    const __m128i lowMask = _mm_set1_epi16(0x00ff);
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x * 2));
+        const __m128i y = uyvy ? _mm_srli_epi16(in, 8) : _mm_and_si128(in, lowMask);
+        const __m128i uv = uyvy ? _mm_and_si128(in, lowMask) : _mm_srli_epi16(in, 8);
+        // uv contains U0 V0 U1 V1 U2 V2 U3 V3, duplicate the chroma for both pixels of each pair
+        const __m128i u = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 2, 0, 0));
+        const __m128i v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(3, 3, 1, 1)), _MM_SHUFFLE(3, 3, 1, 1));
+        __m128i r, g, b;
+        yuvToRgb16(y, u, v, r, g, b);
+        storeRgb32(r, g, b, dst + x * 4);
+    }
+    return x;
+}
+
+static int i420RowSse2(const uchar *srcY, const uchar *srcU, const uchar *srcV, uchar *dst, int width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        int u4;
+        int v4;
+        memcpy(&u4, srcU + x / 2, 4);
+        memcpy(&v4, srcV + x / 2, 4);
+        const __m128i y = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcY + x)), zero);
+        __m128i u = _mm_unpacklo_epi8(_mm_cvtsi32_si128(u4), zero);
+        __m128i v = _mm_unpacklo_epi8(_mm_cvtsi32_si128(v4), zero);
+        u = _mm_unpacklo_epi16(u, u);
+        v = _mm_unpacklo_epi16(v, v);
+        __m128i r, g, b;
+        yuvToRgb16(y, u, v, r, g, b);
+        storeRgb32(r, g, b, dst + x * 4);
+    }
+    return x;
+}
+
+static int rgbaRowSse2(const uchar *src, uchar *dst, int width)
+{
+    // Bytes R G B A are read as 0xAABBGGRR, we want 0xAARRGGBB
+    const __m128i agMask = _mm_set1_epi32(int(0xff00ff00));
+    const __m128i rbMask = _mm_set1_epi32(0x00ff00ff);
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x * 4));
+        const __m128i rb = _mm_and_si128(in, rbMask);
+        const __m128i swapped = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x * 4), _mm_or_si128(_mm_and_si128(in, agMask), swapped));
+    }
+    return x;
+}
+#endif
+
+bool ColorConversion::useSimd()
+{
+#ifdef KDENLIVE_COLORCONVERSION_SSE2
+    return !s_forceScalar;
+#else
+    return false;
+#endif
+}
+
+const char *ColorConversion::backendName()
+{
+    return useSimd() ? "sse2" : "scalar";
+}
+
+void ColorConversion::setForceScalar(bool force)
+{
+    s_forceScalar = force;
+}
+
+void ColorConversion::uyvyToRgb32(const uchar *src, int srcStride, uchar *dst, int dstStride, int width, int height)
+{
+    const bool simd = useSimd();
+    for (int row = 0; row < height; ++row) {
+        const uchar *in = src + row * srcStride;
+        uchar *out = dst + row * dstStride;
+        int x = 0;
+#ifdef KDENLIVE_COLORCONVERSION_SSE2
+        if (simd) {
+            x = packedToRgb32Sse2(in, out, width, true);
+        }
+#else
+        Q_UNUSED(simd)
+#endif
+        packedToRgb32Scalar(in, out, x, width, true);
+    }
+}
+
+void ColorConversion::yuyvToRgb32(const uchar *src, int srcStride, uchar *dst, int dstStride, int width, int height)
+{
+    const bool simd = useSimd();
+    for (int row = 0; row < height; ++row) {
+        const uchar *in = src + row * srcStride;
+        uchar *out = dst + row * dstStride;
+        int x = 0;
+#ifdef KDENLIVE_COLORCONVERSION_SSE2
+        if (simd) {
+            x = packedToRgb32Sse2(in, out, width, false);
+        }
+#else
+        Q_UNUSED(simd)
+#endif
+        packedToRgb32Scalar(in, out, x, width, false);
+    }
+}
+
+void ColorConversion::i420ToRgb32(const uchar *srcY, int strideY, const uchar *srcU, int strideU, const uchar *srcV, int strideV, uchar *dst, int dstStride,
+                                  int width, int height)
+{
+    const bool simd = useSimd();
+    for (int row = 0; row < height; ++row) {
+        const uchar *inY = srcY + row * strideY;
+        const uchar *inU = srcU + (row / 2) * strideU;
+        const uchar *inV = srcV + (row / 2) * strideV;
+        uchar *out = dst + row * dstStride;
+        int x = 0;
+#ifdef KDENLIVE_COLORCONVERSION_SSE2
+        if (simd) {
+            x = i420RowSse2(inY, inU, inV, out, width);
+        }
+#else
+        Q_UNUSED(simd)
+#endif
+        auto *pixels = reinterpret_cast<QRgb *>(out);
+        for (; x < width; ++x) {
+            pixels[x] = yuvToRgb(inY[x], inU[x / 2], inV[x / 2]);
+        }
+    }
+}
+
+void ColorConversion::rgbaToArgb32(const uchar *src, int srcStride, uchar *dst, int dstStride, int width, int height)
+{
+    const bool simd = useSimd();
+    for (int row = 0; row < height; ++row) {
+        const uchar *in = src + row * srcStride;
+        uchar *out = dst + row * dstStride;
+        int x = 0;
+#ifdef KDENLIVE_COLORCONVERSION_SSE2
+        if (simd) {
+            x = rgbaRowSse2(in, out, width);
+        }
+#else
+        Q_UNUSED(simd)
+#endif
+        auto *pixels = reinterpret_cast<QRgb *>(out);
+        for (; x < width; ++x) {
+            const uchar *p = in + x * 4;
+            pixels[x] = qRgba(p[0], p[1], p[2], p[3]);
+        }
+    }
+}
+
+QImage ColorConversion::fromYuyv(const uchar *src, int width, int height)
+{
+    QImage image(width, height, QImage::Format_RGB32);
+    yuyvToRgb32(src, ((width + 1) / 2) * 4, image.bits(), image.bytesPerLine(), width, height);
+    return image;
+}
+
+QImage ColorConversion::fromRgba(const uchar *src, int width, int height)
+{
+    QImage image(width, height, QImage::Format_ARGB32);
+    rgbaToArgb32(src, width * 4, image.bits(), image.bytesPerLine(), width, height);
+    return image;
+}
+
+ImagePool::ImagePool(int maxImages)
+    : m_maxImages(maxImages)
+{
+}
+
+QImage ImagePool::fill(int width, int height, QImage::Format format, const std::function<void(uchar *, int)> &writer)
+{
+    QMutexLocker lk(&m_mutex);
+    // Drop buffers of a different size or format, for example after a frame size change
+    m_images.erase(std::remove_if(m_images.begin(), m_images.end(),
+                                  [width, height, format](const QImage &img) { return img.width() != width || img.height() != height || img.format() != format; }),
+                   m_images.end());
+    QImage *target = nullptr;
+    for (auto &image : m_images) {
+        if (image.isDetached()) {
+            target = &image;
+            break;
+        }
+    }
+    if (target == nullptr) {
+        if (m_images.size() >= m_maxImages) {
+            // All buffers are still in use, don't grow the pool
+            QImage image(width, height, format);
+            writer(image.bits(), image.bytesPerLine());
+            return image;
+        }
+        m_images.append(QImage(width, height, format));
+        target = &m_images.last();
+    }
+    // The pool holds the only reference, so bits() does not detach
+    writer(target->bits(), target->bytesPerLine());
+    return *target;
+}
+
+void ImagePool::clear()
+{
+    QMutexLocker lk(&m_mutex);
+    m_images.clear();
+}
@@ -0,0 +1,64 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QImage>
+#include <QMutex>
+#include <QVector>
+
+#include <functional>
+
+/** @class ColorConversion
+    @brief Fast pixel format conversions used for capture preview and frame grabs.
+    YUV input uses the BT.601 limited range matrix, output is QImage::Format_RGB32 (or ARGB32 for rgba input).
+    An SSE2 implementation is used when available, with a scalar fallback that produces identical results.
+ */
+class ColorConversion
+{
+public:
+    /** @brief Convert packed 4:2:2 U Y0 V Y1 data to RGB32 */
+    static void uyvyToRgb32(const uchar *src, int srcStride, uchar *dst, int dstStride, int width, int height);
+    /** @brief Convert packed 4:2:2 Y0 U Y1 V data (MLT's mlt_image_yuv422) to RGB32 */
+    static void yuyvToRgb32(const uchar *src, int srcStride, uchar *dst, int dstStride, int width, int height);
+    /** @brief Convert planar 4:2:0 data (MLT's mlt_image_yuv420p) to RGB32 */
+    static void i420ToRgb32(const uchar *srcY, int strideY, const uchar *srcU, int strideU, const uchar *srcV, int strideV, uchar *dst, int dstStride,
+                            int width, int height);
+    /** @brief Convert R G B A bytes (MLT's mlt_image_rgba) to QImage::Format_ARGB32, without an intermediate copy */
+    static void rgbaToArgb32(const uchar *src, int srcStride, uchar *dst, int dstStride, int width, int height);
+
+    /** @brief Convenience wrappers returning a new image */
+    static QImage fromYuyv(const uchar *src, int width, int height);
+    static QImage fromRgba(const uchar *src, int width, int height);
+
+    /** @brief Name of the implementation used on this machine, for debug output */
+    static const char *backendName();
+    /** @brief Force the scalar implementation, used to compare results in tests and benchmarks */
+    static void setForceScalar(bool force);
+
+private:
+    static bool useSimd();
+};
+
+/** @class ImagePool
+    @brief A small pool of reusable images to avoid reallocating a full frame buffer for each preview frame.
+    An image is only reused once all other copies (for example in a queued signal) have been released.
+ */
+class ImagePool
+{
+public:
+    explicit ImagePool(int maxImages = 3);
+    /** @brief Fill an image of the requested size and format that is not referenced elsewhere and return a shallow copy of it
+       @param writer receives the image bits and bytes per line and should write the whole image
+     */
+    QImage fill(int width, int height, QImage::Format format, const std::function<void(uchar *, int)> &writer);
+    void clear();
+
+private:
+    QMutex m_mutex;
+    QVector<QImage> m_images;
+    int m_maxImages;
+};
@@ -0,0 +1,138 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "mediaprobecache.hpp"
+#include "kdenlive_debug.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+const quint32 probeCacheMagic = 0x4b445043;
+const quint32 probeCacheVersion = 1;
+// Entries not used during this number of days are deleted
+const int probeCacheMaxAge = 60;
+} // namespace
+
+std::unique_ptr<MediaProbeCache> MediaProbeCache::instance;
+std::once_flag MediaProbeCache::m_onceFlag;
+
+MediaProbeCache::MediaProbeCache()
+    : m_folder(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/probe"))
+{
+}
+
+std::unique_ptr<MediaProbeCache> &MediaProbeCache::get()
+{
+    std::call_once(m_onceFlag, [] {
+        instance.reset(new MediaProbeCache());
+        instance->prune(probeCacheMaxAge);
+    });
+    return instance;
+}
+
+QString MediaProbeCache::entryPath(const QString &path) const
+{
+    const QString key = QString::fromLatin1(QCryptographicHash::hash(path.toUtf8(), QCryptographicHash::Md5).toHex());
+    return m_folder + QLatin1Char('/') + key + QStringLiteral(".dat");
+}
+
+void MediaProbeCache::removeEntry(const QString &path)
+{
+    m_entries.remove(path);
+    QFile::remove(entryPath(path));
+}
+
+void MediaProbeCache::prune(int days)
+{
+    QMutexLocker lock(&m_mutex);
+    QDir dir(m_folder);
+    const QDateTime limit = QDateTime::currentDateTime().addDays(-days);
+    const QFileInfoList entries = dir.entryInfoList({QStringLiteral("*.dat")}, QDir::Files);
+    for (const QFileInfo &entry : entries) {
+        if (entry.lastModified() < limit) {
+            QFile::remove(entry.absoluteFilePath());
+        }
+    }
+}
+
+bool MediaProbeCache::find(const QString &path, const QString &fileHash, MediaProbeInfo &info)
+{
+    QFileInfo fileInfo(path);
+    QMutexLocker lock(&m_mutex);
+    if (!fileInfo.isFile()) {
+        // The media was deleted
+        removeEntry(path);
+        return false;
+    }
+    if (!m_entries.contains(path)) {
+        QFile file(entryPath(path));
+        // Opening in write mode would create the missing entries
+        if (!file.exists() || !file.open(QIODevice::ReadWrite)) {
+            return false;
+        }
+        QDataStream stream(&file);
+        quint32 magic;
+        quint32 version;
+        QString storedPath;
+        MediaProbeInfo entry;
+        stream >> magic >> version;
+        if (magic != probeCacheMagic || version != probeCacheVersion) {
+            file.close();
+            removeEntry(path);
+            return false;
+        }
+        stream >> storedPath >> entry.size >> entry.lastModified >> entry.fileHash >> entry.hasAudio >> entry.hasVideo;
+        if (stream.status() != QDataStream::Ok || storedPath != path) {
+            // Corrupted entry or hash collision
+            file.close();
+            removeEntry(path);
+            return false;
+        }
+        // Mark the entry as used, so that it is not pruned
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+        m_entries.insert(path, entry);
+    }
+    const MediaProbeInfo &entry = m_entries.value(path);
+    if (entry.size != fileInfo.size() || entry.lastModified != fileInfo.lastModified() ||
+        (!fileHash.isEmpty() && !entry.fileHash.isEmpty() && fileHash != entry.fileHash)) {
+        // The file changed since it was probed
+        removeEntry(path);
+        return false;
+    }
+    info = entry;
+    return true;
+}
+
+void MediaProbeCache::store(const QString &path, const QString &fileHash, MediaProbeInfo info)
+{
+    QFileInfo fileInfo(path);
+    if (!fileInfo.isFile()) {
+        return;
+    }
+    info.size = fileInfo.size();
+    info.lastModified = fileInfo.lastModified();
+    info.fileHash = fileHash;
+    QMutexLocker lock(&m_mutex);
+    m_entries.insert(path, info);
+    if (!QDir().mkpath(m_folder)) {
+        return;
+    }
+    QSaveFile file(entryPath(path));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCDebug(KDENLIVE_LOG) << "Cannot write media probe cache for" << path;
+        return;
+    }
+    QDataStream stream(&file);
+    stream << probeCacheMagic << probeCacheVersion << path << info.size << info.lastModified << info.fileHash << info.hasAudio << info.hasVideo;
+    file.commit();
+}
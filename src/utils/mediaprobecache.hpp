@@ -0,0 +1,70 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <memory>
+#include <mutex>
+
+/** @brief The result of probing a media file that requires decoding an image, see ClipLoadTask */
+struct MediaProbeInfo
+{
+    /** @brief Identification of the probed file */
+    qint64 size = -1;
+    QDateTime lastModified;
+    QString fileHash;
+    /** @brief Whether a decoded frame contains audio / video */
+    bool hasAudio = false;
+    bool hasVideo = false;
+};
+
+/** @class MediaProbeCache
+    @brief Persistent cache of media probe results, so that the first image of unchanged files doesn't need to be decoded again when a project is reopened.
+    Only the results that need a decoded image are stored. The producer still opens the file and reads the stream layout, durations and codecs,
+    since it is the object used for playback.
+    An entry is only valid as long as the file's size and modification date (and hash if known) don't change.
+    Entries are stored on disk in the user's cache folder, one small file per media. Stale entries are deleted when found, and entries
+    that were not used for a long time are pruned when the cache is created. This class is thread safe.
+ * Note that this class is a Singleton
+ */
+class MediaProbeCache
+{
+
+public:
+    // Returns the instance of the Singleton
+    static std::unique_ptr<MediaProbeCache> &get();
+
+    /** @brief Look for the probe result of a file
+       @param path is the media file
+       @param fileHash is the kdenlive:file_hash of the clip if known, empty otherwise
+       @param info receives the cached result
+       @returns false if there is no valid entry, in which case the file has to be probed
+     */
+    bool find(const QString &path, const QString &fileHash, MediaProbeInfo &info);
+
+    /** @brief Store the probe result of a file, the file identification fields of @param info are filled here */
+    void store(const QString &path, const QString &fileHash, MediaProbeInfo info);
+
+protected:
+    MediaProbeCache();
+    /** @brief The disk location of the entry of a file */
+    QString entryPath(const QString &path) const;
+    /** @brief Delete the entry of a file, from memory and disk */
+    void removeEntry(const QString &path);
+    /** @brief Delete the entries that were not used for @param days */
+    void prune(int days);
+
+    static std::unique_ptr<MediaProbeCache> instance;
+    static std::once_flag m_onceFlag; // flag to create the cache only once;
+
+    QString m_folder;
+    QMutex m_mutex;
+    QHash<QString, MediaProbeInfo> m_entries;
+};
@@ -0,0 +1,47 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "startuptimeline.hpp"
+#include "kdenlive_debug.h"
+
+QElapsedTimer StartupTimeline::s_timer;
+QList<QPair<QString, qint64>> StartupTimeline::s_phases;
+bool StartupTimeline::s_finished = false;
+
+void StartupTimeline::start()
+{
+    s_timer.start();
+    s_phases.clear();
+    s_finished = false;
+}
+
+void StartupTimeline::mark(const QString &phase)
+{
+    if (s_finished || !s_timer.isValid()) {
+        return;
+    }
+    s_phases.append({phase, s_timer.elapsed()});
+}
+
+void StartupTimeline::finish(const QString &phase)
+{
+    if (s_finished || !s_timer.isValid()) {
+        return;
+    }
+    mark(phase);
+    s_finished = true;
+    qint64 previous = 0;
+    qCInfo(KDENLIVE_LOG) << "Startup timeline:";
+    for (const auto &entry : qAsConst(s_phases)) {
+        qCInfo(KDENLIVE_LOG).nospace() << "  " << entry.second << "ms (+" << entry.second - previous << "ms) " << entry.first;
+        previous = entry.second;
+    }
+}
+
+bool StartupTimeline::isFinished()
+{
+    return s_finished;
+}
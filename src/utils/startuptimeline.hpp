@@ -0,0 +1,34 @@
+/*
+    SPDX-FileCopyrightText: 2022 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+/** @class StartupTimeline
+    @brief Records the time of each application startup phase, from main() to the first paint of the timeline,
+    and writes them to the log once startup is done so that cold start regressions can be tracked.
+ */
+class StartupTimeline
+{
+public:
+    /** @brief Start the timer, to be called at the beginning of main() */
+    static void start();
+    /** @brief Record the end of a startup phase */
+    static void mark(const QString &phase);
+    /** @brief Record the last phase and write the timeline to the log. Later calls are ignored */
+    static void finish(const QString &phase);
+    /** @returns true if the startup timeline was already written */
+    static bool isFinished();
+
+private:
+    static QElapsedTimer s_timer;
+    static QList<QPair<QString, qint64>> s_phases;
+    static bool s_finished;
+};
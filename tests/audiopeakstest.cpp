@@ -0,0 +1,68 @@
+#include "catch.hpp"
+#include "utils/audiopeaks.h"
+
+#include <random>
+#include <vector>
+
+static std::vector<int16_t> randomSamples(size_t size)
+{
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+    std::vector<int16_t> samples(size);
+    for (auto &s : samples) {
+        s = int16_t(dist(gen));
+    }
+    return samples;
+}
+
+TEST_CASE("Audio peaks", "[AudioPeaks]")
+{
+    SECTION("SSE2 and scalar code agree")
+    {
+        // Odd sample count to exercise the scalar tail after the SIMD loop
+        const int sampleCount = 1001;
+        for (int channels : {1, 2, 3, 4, 6, 8}) {
+            std::vector<int16_t> samples = randomSamples(size_t(sampleCount * channels));
+            // Scale down each channel differently so that the peaks differ
+            for (size_t i = 0; i < samples.size(); ++i) {
+                samples[i] = int16_t(samples[i] / int(1 + i % size_t(channels)));
+            }
+            std::vector<int> simd(size_t(channels), -1);
+            std::vector<int> scalar(size_t(channels), -1);
+            AudioPeaks::setForceScalar(false);
+            AudioPeaks::channelPeaks(samples.data(), sampleCount, channels, simd.data());
+            AudioPeaks::setForceScalar(true);
+            AudioPeaks::channelPeaks(samples.data(), sampleCount, channels, scalar.data());
+            AudioPeaks::setForceScalar(false);
+            REQUIRE(simd == scalar);
+        }
+    }
+
+    SECTION("Reference peaks")
+    {
+        const int16_t samples[8] = {100, -200, -32768, 5, 300, 0, -7, 32767};
+        int peaks[2];
+        AudioPeaks::channelPeaks(samples, 4, 2, peaks);
+        REQUIRE(peaks[0] == 32767);
+        REQUIRE(peaks[1] == 32767);
+        AudioPeaks::channelPeaks(samples, 2, 2, peaks);
+        REQUIRE(peaks[0] == 32767);
+        REQUIRE(peaks[1] == 200);
+        AudioPeaks::channelPeaks(samples, 0, 2, peaks);
+        REQUIRE(peaks[0] == 0);
+    }
+
+    SECTION("Levels")
+    {
+        REQUIRE(AudioPeaks::level(0) == 0);
+        // Below -70dB
+        REQUIRE(AudioPeaks::level(5) == 0);
+        REQUIRE(AudioPeaks::level(32767) == 230);
+        int previous = 0;
+        for (int peak = 1; peak < 32768; peak += 97) {
+            int value = AudioPeaks::level(peak);
+            REQUIRE(value >= previous);
+            previous = value;
+        }
+    }
+}
@@ -0,0 +1,129 @@
+#include "catch.hpp"
+#include "utils/colorconversion.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <cstring>
+#include <functional>
+#include <random>
+
+static std::vector<uchar> randomBuffer(size_t size)
+{
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::vector<uchar> buffer(size);
+    for (auto &b : buffer) {
+        b = uchar(dist(gen));
+    }
+    return buffer;
+}
+
+TEST_CASE("Color conversion", "[ColorConversion]")
+{
+    // Odd width to exercise the scalar tail after the SIMD loop
+    const int width = 93;
+    const int height = 7;
+    std::vector<uchar> source = randomBuffer(size_t(width + 1) * 4 * height);
+
+    auto compare = [&](const std::function<void(uchar *, int)> &convert) {
+        QImage simd(width, height, QImage::Format_RGB32);
+        QImage scalar(width, height, QImage::Format_RGB32);
+        ColorConversion::setForceScalar(false);
+        convert(simd.bits(), simd.bytesPerLine());
+        ColorConversion::setForceScalar(true);
+        convert(scalar.bits(), scalar.bytesPerLine());
+        ColorConversion::setForceScalar(false);
+        return simd == scalar;
+    };
+
+    SECTION("SIMD and scalar give identical results")
+    {
+        const int packedStride = ((width + 1) / 2) * 4;
+        REQUIRE(compare([&](uchar *dst, int stride) { ColorConversion::uyvyToRgb32(source.data(), packedStride, dst, stride, width, height); }));
+        REQUIRE(compare([&](uchar *dst, int stride) { ColorConversion::yuyvToRgb32(source.data(), packedStride, dst, stride, width, height); }));
+        const int chromaStride = (width + 1) / 2;
+        const uchar *u = source.data() + width * height;
+        const uchar *v = u + chromaStride * ((height + 1) / 2);
+        REQUIRE(compare([&](uchar *dst, int stride) { ColorConversion::i420ToRgb32(source.data(), width, u, chromaStride, v, chromaStride, dst, stride, width, height); }));
+        REQUIRE(compare([&](uchar *dst, int stride) { ColorConversion::rgbaToArgb32(source.data(), width * 4, dst, stride, width, height); }));
+    }
+
+    SECTION("Reference colors")
+    {
+        // Y U Y V: black, white
+        const uchar yuyv[8] = {16, 128, 235, 128, 16, 128, 235, 128};
+        QImage img = ColorConversion::fromYuyv(yuyv, 4, 1);
+        REQUIRE(img.pixel(0, 0) == qRgb(0, 0, 0));
+        REQUIRE(img.pixel(1, 0) == qRgb(255, 255, 255));
+        const uchar rgba[4] = {10, 20, 30, 40};
+        img = ColorConversion::fromRgba(rgba, 1, 1);
+        REQUIRE(img.pixel(0, 0) == qRgba(10, 20, 30, 40));
+    }
+
+    SECTION("Capture preview data is converted as Y U Y V")
+    {
+        // Reference: the conversion previously done by MltDeviceCapture::uyvy2rgb on the captured frames
+        const int packedStride = ((width + 1) / 2) * 4;
+        QImage img(width, height, QImage::Format_RGB32);
+        ColorConversion::yuyvToRgb32(source.data(), packedStride, img.bits(), img.bytesPerLine(), width, height);
+        auto clamp = [](int value) { return qBound(0, value, 255); };
+        int maxDiff = 0;
+        for (int y = 0; y < height; ++y) {
+            const uchar *line = source.data() + y * packedStride;
+            for (int x = 0; x < width; ++x) {
+                const uchar *pair = line + (x / 2) * 4;
+                const int Y = pair[(x % 2) * 2];
+                const int U = pair[1];
+                const int V = pair[3];
+                const int r = clamp((298 * (Y - 16) + 409 * (V - 128) + 128) >> 8);
+                const int g = clamp((298 * (Y - 16) - 100 * (U - 128) - 208 * (V - 128) + 128) >> 8);
+                const int b = clamp((298 * (Y - 16) + 516 * (U - 128) + 128) >> 8);
+                const QRgb pixel = img.pixel(x, y);
+                maxDiff = qMax(maxDiff, qMax(qAbs(qRed(pixel) - r), qMax(qAbs(qGreen(pixel) - g), qAbs(qBlue(pixel) - b))));
+            }
+        }
+        // Only rounding differences are allowed
+        REQUIRE(maxDiff <= 3);
+    }
+
+    SECTION("Image pool reuses released buffers")
+    {
+        ImagePool pool(2);
+        auto writer = [](uchar *bits, int bytesPerLine) { memset(bits, 0, size_t(bytesPerLine)); };
+        const uchar *firstBits = nullptr;
+        {
+            QImage first = pool.fill(16, 16, QImage::Format_RGB32, writer);
+            firstBits = first.constBits();
+            // Still referenced, we must get another buffer
+            QImage second = pool.fill(16, 16, QImage::Format_RGB32, writer);
+            REQUIRE(second.constBits() != firstBits);
+        }
+        QImage third = pool.fill(16, 16, QImage::Format_RGB32, writer);
+        REQUIRE(third.constBits() == firstBits);
+    }
+}
+
+TEST_CASE("Color conversion benchmark", "[.][benchmark][ColorConversion]")
+{
+    const int width = 1920;
+    const int height = 1080;
+    const int iterations = 100;
+    std::vector<uchar> source = randomBuffer(size_t(width) * height * 4);
+    QImage target(width, height, QImage::Format_RGB32);
+    for (bool scalar : {true, false}) {
+        ColorConversion::setForceScalar(scalar);
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < iterations; i++) {
+            ColorConversion::yuyvToRgb32(source.data(), width * 2, target.bits(), target.bytesPerLine(), width, height);
+        }
+        qint64 yuyvTime = timer.restart();
+        for (int i = 0; i < iterations; i++) {
+            ColorConversion::rgbaToArgb32(source.data(), width * 4, target.bits(), target.bytesPerLine(), width, height);
+        }
+        qint64 rgbaTime = timer.elapsed();
+        qDebug() << "Color conversion" << ColorConversion::backendName() << "1080p yuyv:" << double(yuyvTime) / iterations
+                 << "ms/frame, rgba:" << double(rgbaTime) / iterations << "ms/frame";
+    }
+    ColorConversion::setForceScalar(false);
+}
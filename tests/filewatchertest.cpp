@@ -0,0 +1,89 @@
+#include "catch.hpp"
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#define private public
+#define protected public
+#include "bin/filewatcher.hpp"
+
+TEST_CASE("File watcher", "[FileWatcher]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("clip.mkv"));
+    QFile file(path);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    file.write("data");
+    file.close();
+
+    FileWatcher watcher;
+    int waiting = 0;
+    int modified = 0;
+    int missing = 0;
+    QObject::connect(&watcher, &FileWatcher::binClipWaiting, [&waiting](const QString &) { waiting++; });
+    QObject::connect(&watcher, &FileWatcher::binClipModified, [&modified](const QString &) { modified++; });
+    QObject::connect(&watcher, &FileWatcher::binClipMissing, [&missing](const QString &) { missing++; });
+    watcher.addFile(QStringLiteral("1"), path);
+    watcher.addFile(QStringLiteral("2"), path);
+
+    SECTION("Paths are normalized and folders are shared")
+    {
+        REQUIRE(watcher.contains(path));
+        REQUIRE(watcher.contains(dir.path() + QStringLiteral("/./clip.mkv")));
+        REQUIRE_FALSE(watcher.contains(dir.filePath(QStringLiteral("other.mkv"))));
+        REQUIRE(watcher.m_watchedDirs.size() == 1);
+        watcher.removeFile(QStringLiteral("1"));
+        REQUIRE(watcher.contains(path));
+        watcher.removeFile(QStringLiteral("2"));
+        REQUIRE_FALSE(watcher.contains(path));
+        REQUIRE(watcher.m_watchedDirs.empty());
+    }
+
+    SECTION("Events are coalesced until the file settles")
+    {
+        watcher.slotUrlModified(path);
+        watcher.slotUrlModified(path);
+        // Waiting is sent once per clip, for the first event only
+        REQUIRE(waiting == 2);
+        // The first check records the size
+        watcher.slotProcessModifiedUrls();
+        REQUIRE(modified == 0);
+        // The size did not change, but the last event is too recent
+        watcher.slotProcessModifiedUrls();
+        REQUIRE(modified == 0);
+        watcher.m_modifiedUrls[path].lastEvent = QDateTime::currentDateTime().addSecs(-3);
+        watcher.slotProcessModifiedUrls();
+        REQUIRE(modified == 2);
+        REQUIRE(watcher.m_modifiedUrls.empty());
+    }
+
+    SECTION("A growing file is not reloaded")
+    {
+        watcher.slotUrlAdded(path);
+        watcher.slotProcessModifiedUrls();
+        REQUIRE(file.open(QIODevice::Append));
+        file.write("more data");
+        file.close();
+        watcher.m_modifiedUrls[path].lastEvent = QDateTime::currentDateTime().addSecs(-3);
+        watcher.slotProcessModifiedUrls();
+        REQUIRE(modified == 0);
+        // The size change counts as a new event
+        watcher.slotProcessModifiedUrls();
+        REQUIRE(modified == 0);
+        watcher.m_modifiedUrls[path].lastEvent = QDateTime::currentDateTime().addSecs(-3);
+        watcher.slotProcessModifiedUrls();
+        REQUIRE(modified == 2);
+    }
+
+    SECTION("Deleted files are reported missing")
+    {
+        watcher.slotUrlModified(path);
+        REQUIRE(QFile::remove(path));
+        watcher.slotUrlMissing(path);
+        REQUIRE(missing == 2);
+        REQUIRE(watcher.m_modifiedUrls.empty());
+        // Events of files that are not used in the project are ignored
+        watcher.slotUrlModified(dir.filePath(QStringLiteral("other.mkv")));
+        REQUIRE(watcher.m_modifiedUrls.empty());
+    }
+}
@@ -0,0 +1,190 @@
+#include "catch.hpp"
+#include <QDataStream>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtMath>
+#include <cmath>
+#include <vector>
+#define private public
+#define protected public
+#include "jobs/ingestanalyzers.h"
+
+// Feed @param seconds of a stereo 1kHz sine of amplitude @param amplitude (0-1) to the meter, in 25fps frames
+static void feedSine(LoudnessMeter &meter, double amplitude, int seconds, int &position)
+{
+    const int frequency = 48000;
+    const int samplesPerFrame = frequency / 25;
+    std::vector<int16_t> samples(size_t(samplesPerFrame * 2));
+    for (int frame = 0; frame < seconds * 25; ++frame) {
+        for (int i = 0; i < samplesPerFrame; ++i) {
+            const int n = frame * samplesPerFrame + i;
+            const auto value = int16_t(qRound(amplitude * 32767 * std::sin(2 * M_PI * 1000. * n / frequency)));
+            samples[size_t(2 * i)] = value;
+            samples[size_t(2 * i + 1)] = value;
+        }
+        IngestAudioFrame audio;
+        audio.position = position++;
+        audio.samples = samples.data();
+        audio.sampleCount = samplesPerFrame;
+        audio.channels = 2;
+        audio.frequency = frequency;
+        meter.processAudio(audio);
+    }
+}
+
+TEST_CASE("Loudness meter", "[IngestAnalysis]")
+{
+    IngestMediaInfo info;
+    info.channels = 2;
+    info.frequency = 48000;
+    LoudnessMeter meter;
+    meter.begin(info);
+    int position = 0;
+
+    SECTION("A -20dBFS stereo sine measures -20 LUFS")
+    {
+        feedSine(meter, 0.1, 3, position);
+        REQUIRE(std::abs(meter.integratedLoudness() + 20.) < 0.5);
+        REQUIRE(std::abs(meter.samplePeak() + 20.) < 0.1);
+    }
+
+    SECTION("Silence is below the absolute gate")
+    {
+        feedSine(meter, 0., 3, position);
+        REQUIRE(meter.integratedLoudness() == Approx(-70.));
+        feedSine(meter, 0.1, 3, position);
+        REQUIRE(std::abs(meter.integratedLoudness() + 20.) < 0.5);
+    }
+
+    SECTION("Quiet passages are removed by the relative gate")
+    {
+        // Without the relative gate the average power would give about -23 LUFS
+        feedSine(meter, 0.1, 3, position);
+        feedSine(meter, 0.01, 3, position);
+        REQUIRE(std::abs(meter.integratedLoudness() + 20.) < 0.5);
+    }
+
+    SECTION("Frames without samples are ignored")
+    {
+        IngestAudioFrame audio;
+        audio.position = 0;
+        audio.samples = nullptr;
+        audio.sampleCount = 1920;
+        audio.channels = 2;
+        audio.frequency = 48000;
+        meter.processAudio(audio);
+        REQUIRE(meter.m_subBlocks.isEmpty());
+        QTemporaryDir dir;
+        REQUIRE_FALSE(meter.finish(dir.filePath(QStringLiteral("clip_"))));
+    }
+}
+
+// Feed a frame of uniform gray @param value to the metric
+static void feedGray(SceneChangeMetric &metric, int position, uchar value)
+{
+    const int width = 128;
+    const int height = 72;
+    std::vector<uchar> rgba(size_t(width * height * 4), value);
+    metric.processVideo(position, rgba.data(), width, height);
+}
+
+TEST_CASE("Scene change metric", "[IngestAnalysis]")
+{
+    IngestMediaInfo info;
+    info.length = 10;
+    info.width = 128;
+    info.height = 72;
+    SceneChangeMetric metric;
+    metric.begin(info);
+
+    SECTION("A cut scores high, a fade does not")
+    {
+        int position = 0;
+        for (int i = 0; i < 5; ++i) {
+            feedGray(metric, position++, uchar(50 + 2 * i));
+        }
+        feedGray(metric, position++, 200);
+        feedGray(metric, position++, 200);
+        const QVector<float> &scores = metric.scores();
+        REQUIRE(scores.size() == 7);
+        REQUIRE(scores.at(0) == 0.f);
+        // The fade has a constant frame difference
+        for (int i = 2; i < 5; ++i) {
+            REQUIRE(scores.at(i) == 0.f);
+        }
+        REQUIRE(scores.at(5) > 0.9f);
+        REQUIRE(scores.at(6) == 0.f);
+    }
+
+    SECTION("Missing positions get a zero score")
+    {
+        feedGray(metric, 0, 50);
+        feedGray(metric, 3, 50);
+        REQUIRE(metric.scores().size() == 4);
+        REQUIRE(metric.scores().at(1) == 0.f);
+        REQUIRE(metric.scores().at(2) == 0.f);
+    }
+
+    SECTION("Scores are saved and loaded")
+    {
+        feedGray(metric, 0, 50);
+        feedGray(metric, 1, 150);
+        QTemporaryDir dir;
+        const QString prefix = dir.filePath(QStringLiteral("clip_"));
+        REQUIRE(metric.finish(prefix));
+        REQUIRE(SceneChangeMetric::loadScores(IngestAnalyzer::cacheFile(prefix, metric.name())) == metric.scores());
+        // Damaged files are rejected
+        QFile file(IngestAnalyzer::cacheFile(prefix, metric.name()));
+        REQUIRE(file.open(QIODevice::WriteOnly));
+        file.write("garbage");
+        file.close();
+        REQUIRE(SceneChangeMetric::loadScores(IngestAnalyzer::cacheFile(prefix, metric.name())).isEmpty());
+    }
+}
+
+TEST_CASE("Audio peak pyramid", "[IngestAnalysis]")
+{
+    IngestMediaInfo info;
+    info.length = 5;
+    info.channels = 2;
+    AudioPeakPyramid peaks(QString());
+    peaks.begin(info);
+    const QVector<QVector<double>> levels = {{0.1, 0.2}, {0.5, 0.}, {0.3, 0.9}, {}, {1.0, 0.4}};
+    for (int i = 0; i < levels.size(); ++i) {
+        IngestAudioFrame audio;
+        audio.position = i;
+        audio.samples = nullptr;
+        audio.sampleCount = 0;
+        audio.channels = 2;
+        audio.frequency = 48000;
+        audio.levels = levels.at(i);
+        peaks.processAudio(audio);
+    }
+
+    SECTION("Levels are stored per channel, invalid frames repeat the last value like AudioLevelsTask")
+    {
+        const QVector<uint8_t> expected = {23, 46, 115, 0, 69, 207, 207, 207, 230, 92};
+        REQUIRE(peaks.levels() == expected);
+    }
+
+    SECTION("Each pyramid level keeps the highest peak of 2 frames")
+    {
+        QTemporaryDir dir;
+        const QString prefix = dir.filePath(QStringLiteral("clip_"));
+        REQUIRE(peaks.finish(prefix));
+        QFile file(IngestAnalyzer::cacheFile(prefix, peaks.name()));
+        REQUIRE(file.open(QIODevice::ReadOnly));
+        QDataStream stream(&file);
+        quint32 magic, version;
+        qint32 channels;
+        QVector<uint8_t> stored;
+        QVector<QVector<uint8_t>> pyramid;
+        stream >> magic >> version >> channels >> stored >> pyramid;
+        REQUIRE(stream.status() == QDataStream::Ok);
+        REQUIRE(channels == 2);
+        REQUIRE(stored == peaks.levels());
+        REQUIRE(pyramid.size() == 2);
+        REQUIRE(pyramid.at(0) == QVector<uint8_t>({115, 46, 207, 207, 230, 92}));
+        REQUIRE(pyramid.at(1) == QVector<uint8_t>({207, 207, 230, 92}));
+    }
+}
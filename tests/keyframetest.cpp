@@ -1,6 +1,7 @@
 #include <memory>
 
 #include "test_utils.hpp"
+#include "assets/keyframes/model/keyframesimplifier.hpp"
 
 using namespace fakeit;
 
@@ -259,3 +260,48 @@ TEST_CASE("Keyframe model", "[KeyframeModel]")
     }
     pCore->m_projectManager = nullptr;
 }
+
+TEST_CASE("Keyframe simplification", "[KeyframeModel]")
+{
+    SECTION("Linear ramp is reduced to its end points")
+    {
+        QVector<int> frames;
+        QVector<QVector<double>> channels;
+        for (int i = 0; i < 100; i++) {
+            frames << i;
+            channels << QVector<double>({2. * i, 50.});
+        }
+        QVector<bool> keep = KeyframeSimplifier::simplify(frames, channels, {}, 0.1);
+        REQUIRE(keep.size() == 100);
+        REQUIRE(keep.count(true) == 2);
+        REQUIRE(keep.first());
+        REQUIRE(keep.last());
+    }
+
+    SECTION("Deviation above tolerance is kept")
+    {
+        QVector<int> frames = {0, 10, 20, 30, 40};
+        QVector<QVector<double>> channels = {{0.}, {1.}, {20.}, {3.}, {4.}};
+        QVector<bool> keep = KeyframeSimplifier::simplify(frames, channels, {}, 2.);
+        REQUIRE(keep == QVector<bool>({true, false, true, false, true}));
+        // A large tolerance removes everything but the ends
+        keep = KeyframeSimplifier::simplify(frames, channels, {}, 100.);
+        REQUIRE(keep == QVector<bool>({true, false, false, false, true}));
+    }
+
+    SECTION("Any channel above tolerance keeps the keyframe")
+    {
+        QVector<int> frames = {0, 1, 2};
+        QVector<QVector<double>> channels = {{0., 0.}, {1., 10.}, {2., 0.}};
+        QVector<bool> keep = KeyframeSimplifier::simplify(frames, channels, {}, 1.);
+        REQUIRE(keep.count(true) == 3);
+    }
+
+    SECTION("Locked keyframes are kept")
+    {
+        QVector<int> frames = {0, 1, 2, 3, 4};
+        QVector<QVector<double>> channels = {{0.}, {1.}, {2.}, {3.}, {4.}};
+        QVector<bool> keep = KeyframeSimplifier::simplify(frames, channels, {false, false, true, false, false}, 1.);
+        REQUIRE(keep == QVector<bool>({true, false, true, false, true}));
+    }
+}
@@ -163,6 +163,52 @@ TEST_CASE("Marker model", "[MarkerListModel]")
         checkStates(undoStack, model, {{}, state1, state2, state3, state4, state5, state6, state7, state8, state9, {}}, snaps);
     }
 
+    SECTION("Bulk operations")
+    {
+        std::vector<Marker> list;
+        checkMarkerList(model, list, snaps);
+
+        list.emplace_back(GenTime(1.3), QLatin1String("test marker"), 3);
+        REQUIRE(model->addMarker(GenTime(1.3), QLatin1String("test marker"), 3));
+        auto state1 = list;
+
+        // add several markers at once, one of them renaming an existing marker
+        QMap<GenTime, QString> markers;
+        markers.insert(GenTime(0.3), QLatin1String("bulk 1"));
+        markers.insert(GenTime(1.3), QLatin1String("bulk 2"));
+        markers.insert(GenTime(5), QLatin1String("bulk 3"));
+        REQUIRE(model->addMarkers(markers, 2));
+        list.clear();
+        list.emplace_back(GenTime(0.3), QLatin1String("bulk 1"), 2);
+        list.emplace_back(GenTime(1.3), QLatin1String("bulk 2"), 2);
+        list.emplace_back(GenTime(5), QLatin1String("bulk 3"), 2);
+        checkMarkerList(model, list, snaps);
+        auto state2 = list;
+        checkStates(undoStack, model, {{}, state1, state2}, snaps);
+
+        // range queries are sorted by position
+        int frame1 = GenTime(1.3).frames(fps);
+        int frame2 = GenTime(5).frames(fps);
+        QList<CommentedTime> inRange = model->getMarkersInRange(frame1, -1);
+        REQUIRE(inRange.size() == 2);
+        REQUIRE(inRange.at(0).comment() == QLatin1String("bulk 2"));
+        REQUIRE(inRange.at(1).comment() == QLatin1String("bulk 3"));
+        REQUIRE(model->getMarkersIdInRange(0, frame2 - 1).size() == 2);
+        REQUIRE(model->getMarkersIdInRange(frame2 + 1, -1).isEmpty());
+
+        // removing an unexisting marker aborts the whole operation
+        REQUIRE_FALSE(model->removeMarkers({GenTime(0.3), GenTime(42.)}));
+        checkMarkerList(model, list, snaps);
+
+        // remove several markers at once
+        REQUIRE(model->removeMarkers({GenTime(0.3), GenTime(5)}));
+        list.clear();
+        list.emplace_back(GenTime(1.3), QLatin1String("bulk 2"), 2);
+        checkMarkerList(model, list, snaps);
+        auto state3 = list;
+        checkStates(undoStack, model, {{}, state1, state2, state3}, snaps);
+    }
+
     SECTION("Json identity test")
     {
         std::vector<Marker> list;
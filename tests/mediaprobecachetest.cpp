@@ -0,0 +1,100 @@
+#include "catch.hpp"
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#define private public
+#define protected public
+#include "utils/mediaprobecache.hpp"
+
+TEST_CASE("Media probe cache", "[MediaProbeCache]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString media = dir.filePath(QStringLiteral("clip.mkv"));
+    QFile file(media);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    file.write("data");
+    file.close();
+
+    MediaProbeCache cache;
+    cache.m_folder = dir.filePath(QStringLiteral("probe"));
+    MediaProbeInfo probe;
+    probe.hasAudio = true;
+    probe.hasVideo = false;
+    cache.store(media, QStringLiteral("hash"), probe);
+    REQUIRE(QFile::exists(cache.entryPath(media)));
+
+    SECTION("Entries are found in memory and on disk")
+    {
+        MediaProbeInfo info;
+        REQUIRE(cache.find(media, QStringLiteral("hash"), info));
+        REQUIRE(info.hasAudio);
+        REQUIRE_FALSE(info.hasVideo);
+        // An unknown hash does not invalidate the entry
+        REQUIRE(cache.find(media, QString(), info));
+        MediaProbeCache other;
+        other.m_folder = cache.m_folder;
+        MediaProbeInfo stored;
+        REQUIRE(other.find(media, QStringLiteral("hash"), stored));
+        REQUIRE(stored.hasAudio);
+        REQUIRE_FALSE(stored.hasVideo);
+        REQUIRE(stored.size == 4);
+    }
+
+    SECTION("A different hash invalidates the entry")
+    {
+        MediaProbeInfo info;
+        REQUIRE_FALSE(cache.find(media, QStringLiteral("otherhash"), info));
+        REQUIRE_FALSE(QFile::exists(cache.entryPath(media)));
+        REQUIRE_FALSE(cache.find(media, QStringLiteral("hash"), info));
+    }
+
+    SECTION("A modified file invalidates the entry")
+    {
+        REQUIRE(file.open(QIODevice::Append));
+        file.write("more data");
+        file.close();
+        MediaProbeInfo info;
+        REQUIRE_FALSE(cache.find(media, QStringLiteral("hash"), info));
+        REQUIRE_FALSE(QFile::exists(cache.entryPath(media)));
+    }
+
+    SECTION("A deleted file invalidates the entry")
+    {
+        REQUIRE(QFile::remove(media));
+        MediaProbeInfo info;
+        REQUIRE_FALSE(cache.find(media, QStringLiteral("hash"), info));
+        REQUIRE_FALSE(QFile::exists(cache.entryPath(media)));
+    }
+
+    SECTION("Corrupted entries are removed")
+    {
+        QFile entry(cache.entryPath(media));
+        REQUIRE(entry.open(QIODevice::WriteOnly));
+        entry.write("garbage");
+        entry.close();
+        MediaProbeCache other;
+        other.m_folder = cache.m_folder;
+        MediaProbeInfo info;
+        REQUIRE_FALSE(other.find(media, QStringLiteral("hash"), info));
+        REQUIRE_FALSE(QFile::exists(cache.entryPath(media)));
+    }
+
+    SECTION("Unused entries are pruned")
+    {
+        const QString recent = dir.filePath(QStringLiteral("recent.mkv"));
+        QFile recentFile(recent);
+        REQUIRE(recentFile.open(QIODevice::WriteOnly));
+        recentFile.write("data");
+        recentFile.close();
+        cache.store(recent, QString(), probe);
+        QFile entry(cache.entryPath(media));
+        REQUIRE(entry.open(QIODevice::ReadWrite));
+        REQUIRE(entry.setFileTime(QDateTime::currentDateTime().addDays(-100), QFileDevice::FileModificationTime));
+        entry.close();
+        cache.prune(60);
+        REQUIRE_FALSE(QFile::exists(cache.entryPath(media)));
+        REQUIRE(QFile::exists(cache.entryPath(recent)));
+    }
+}
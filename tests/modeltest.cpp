@@ -2070,3 +2070,380 @@ TEST_CASE("Operations under locked tracks", "[Locked]")
     pCore->m_projectManager = nullptr;
 }
 
+
+TEST_CASE("Timeline layout snapshot", "[Snapshot]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    TimelineItemModel tim(&profile_model, undoStack);
+    Mock<TimelineItemModel> timMock(tim);
+    auto timeline = std::shared_ptr<TimelineItemModel>(&timMock.get(), [](...) {});
+    TimelineItemModel::finishConstruct(timeline, guideModel);
+
+    QString binId = createProducer(profile_model, "red", binModel, 20);
+    int tid1 = TrackModel::construct(timeline);
+    int tid2 = TrackModel::construct(timeline);
+    int cid1 = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+    int cid2 = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+    REQUIRE(timeline->requestClipMove(cid1, tid1, 30));
+    REQUIRE(timeline->requestClipMove(cid2, tid1, 0));
+
+    timeline->publishLayoutSnapshot();
+    TimelineSnapshotPtr snapshot = timeline->layoutSnapshot();
+    REQUIRE(snapshot->version() == timeline->layoutVersion());
+    REQUIRE(snapshot->duration() == timeline->duration());
+    REQUIRE(snapshot->tracks().size() == 2);
+    const TrackSnapshot *track = snapshot->track(tid1);
+    REQUIRE(track != nullptr);
+    REQUIRE(track->clips.size() == 2);
+    // Items are ordered by position
+    REQUIRE(track->clips[0].id == cid2);
+    REQUIRE(track->clips[1].id == cid1);
+    REQUIRE(track->clips[1].position == 30);
+    REQUIRE(track->clips[1].duration == 20);
+    REQUIRE(track->clipAt(10)->id == cid2);
+    REQUIRE(track->clipAt(25) == nullptr);
+    REQUIRE(track->clipAt(49)->id == cid1);
+    REQUIRE(track->clipAt(50) == nullptr);
+    REQUIRE(track->clipsInRange(15, 35).size() == 2);
+    REQUIRE(track->clipsInRange(20, 30).empty());
+    REQUIRE(snapshot->track(tid2)->clips.empty());
+
+    // A published snapshot is immutable, changes are visible in the next one
+    REQUIRE(timeline->requestClipMove(cid1, tid2, 60));
+    REQUIRE(snapshot->track(tid1)->clips.size() == 2);
+    timeline->publishLayoutSnapshot();
+    TimelineSnapshotPtr next = timeline->layoutSnapshot();
+    REQUIRE(next->version() > snapshot->version());
+    int trackId = -1;
+    REQUIRE(next->item(cid1, &trackId)->position == 60);
+    REQUIRE(trackId == tid2);
+    REQUIRE(next->track(tid1)->clips.size() == 1);
+
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
+
+TEST_CASE("Undo history coalescing and memory budget", "[Undo]")
+{
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    undoStack->setMemoryBudget(0);
+    QStringList log;
+    auto makeCommand = [&log](int i, const QString &key) {
+        Fun undo = [&log, i]() {
+            log << QStringLiteral("undo%1").arg(i);
+            return true;
+        };
+        Fun redo = [&log, i]() {
+            log << QStringLiteral("redo%1").arg(i);
+            return true;
+        };
+        auto *command = new FunctionalUndoCommand(undo, redo, QStringLiteral("Command %1").arg(i));
+        command->setMergeKey(key);
+        return command;
+    };
+
+    SECTION("Commands with the same key are merged")
+    {
+        undoStack->push(makeCommand(1, QStringLiteral("drag")));
+        undoStack->push(makeCommand(2, QStringLiteral("drag")));
+        undoStack->push(makeCommand(3, QStringLiteral("drag")));
+        REQUIRE(undoStack->count() == 1);
+        undoStack->push(makeCommand(4, QString()));
+        undoStack->push(makeCommand(5, QString()));
+        REQUIRE(undoStack->count() == 3);
+        undoStack->undo();
+        undoStack->undo();
+        undoStack->undo();
+        REQUIRE(log == QStringList({"undo5", "undo4", "undo3", "undo2", "undo1"}));
+        log.clear();
+        undoStack->redo();
+        REQUIRE(log == QStringList({"redo1", "redo2", "redo3"}));
+    }
+
+    SECTION("Chained merge keys only merge the same item")
+    {
+        auto makeMove = [&](int i, int from, int to) {
+            auto *command = makeCommand(i, QString());
+            command->setMergeKey(QStringLiteral("move-%1").arg(from), QStringLiteral("move-%1").arg(to));
+            return command;
+        };
+        // An item moved from 0 to 1 then 2 is a single entry
+        undoStack->push(makeMove(1, 0, 1));
+        undoStack->push(makeMove(2, 1, 2));
+        REQUIRE(undoStack->count() == 1);
+        // Moving another item starts a new entry
+        undoStack->push(makeMove(3, 5, 6));
+        REQUIRE(undoStack->count() == 2);
+        undoStack->push(makeMove(4, 2, 3));
+        REQUIRE(undoStack->count() == 3);
+    }
+
+    SECTION("Captured payloads are accounted")
+    {
+        // Flush the payloads left by previous tests
+        UndoPayload::collect();
+        Fun dropped = UndoPayload::attach([]() { return true; }, 30000);
+        dropped = Fun();
+        Fun undo = UndoPayload::attach([]() { return true; }, 50000);
+        Fun redo = []() { return true; };
+        auto *command = new FunctionalUndoCommand(undo, redo, QStringLiteral("Payload"));
+        REQUIRE(command->memoryCost() >= 50000);
+        REQUIRE(command->memoryCost() < 80000);
+        undoStack->push(command);
+        REQUIRE(undoStack->memoryUsage() == command->memoryCost());
+        // Each command adds its cost
+        undoStack->push(makeCommand(1, QString()));
+        qint64 usage = undoStack->memoryUsage();
+        REQUIRE(usage > command->memoryCost());
+        undoStack->undo();
+        REQUIRE(undoStack->memoryUsage() == usage);
+        // Pushing a new command deletes the undone one
+        undoStack->push(makeCommand(2, QString()));
+        REQUIRE(undoStack->memoryUsage() == usage);
+    }
+
+    SECTION("Oldest commands are removed when over budget")
+    {
+        for (int i = 0; i < 5; ++i) {
+            auto *command = makeCommand(i, QString());
+            command->addMemoryCost(100000);
+            undoStack->push(command);
+        }
+        qint64 usage = undoStack->memoryUsage();
+        REQUIRE(usage > 500000);
+        undoStack->setMemoryBudget(250000);
+        REQUIRE(undoStack->compact() == 3);
+        REQUIRE(undoStack->memoryUsage() <= 250000);
+        REQUIRE(undoStack->count() == 2);
+        REQUIRE(undoStack->index() == 2);
+        REQUIRE(log.isEmpty());
+        while (undoStack->canUndo()) {
+            undoStack->undo();
+        }
+        REQUIRE(log == QStringList({"undo4", "undo3"}));
+        log.clear();
+        undoStack->redo();
+        REQUIRE(log == QStringList({"redo3"}));
+    }
+
+    SECTION("The clean state is kept by compaction")
+    {
+        for (int i = 0; i < 5; ++i) {
+            auto *command = makeCommand(i, QString());
+            command->addMemoryCost(100000);
+            undoStack->push(command);
+            if (i == 3) {
+                undoStack->setClean();
+            }
+        }
+        undoStack->setMemoryBudget(250000);
+        REQUIRE(undoStack->compact() == 3);
+        REQUIRE(undoStack->cleanIndex() == 1);
+        REQUIRE_FALSE(undoStack->isClean());
+        undoStack->undo();
+        REQUIRE(undoStack->isClean());
+    }
+
+    SECTION("The clean state is dropped when its command is removed")
+    {
+        REQUIRE(undoStack->isClean());
+        for (int i = 0; i < 5; ++i) {
+            auto *command = makeCommand(i, QString());
+            command->addMemoryCost(100000);
+            undoStack->push(command);
+        }
+        undoStack->setMemoryBudget(250000);
+        REQUIRE(undoStack->compact() == 3);
+        REQUIRE(undoStack->cleanIndex() == -1);
+        while (undoStack->canUndo()) {
+            undoStack->undo();
+            REQUIRE_FALSE(undoStack->isClean());
+        }
+    }
+}
+
+TEST_CASE("Bulk clip adoption", "[ClipModel]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    TimelineItemModel tim(&profile_model, undoStack);
+    Mock<TimelineItemModel> timMock(tim);
+    auto timeline = std::shared_ptr<TimelineItemModel>(&timMock.get(), [](...) {});
+    TimelineItemModel::finishConstruct(timeline, guideModel);
+
+    QString binId = createProducer(profile_model, "red", binModel, 20);
+    int tid1 = TrackModel::construct(timeline);
+    int cid1 = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+    int cid2 = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+    int cid3 = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+    int undoCount = undoStack->count();
+
+    // Clips are appended in position order, with blanks in between
+    REQUIRE(timeline->adoptClip(cid1, tid1, 0));
+    REQUIRE(timeline->adoptClip(cid2, tid1, 50));
+    // A clip before the end of the playlist cannot be adopted, and the track is not modified
+    const int entries = timeline->getTrackById(tid1)->m_playlists[0].count();
+    REQUIRE_FALSE(timeline->adoptClip(cid3, tid1, 30));
+    REQUIRE(timeline->getClipTrackId(cid3) == -1);
+    REQUIRE(timeline->getTrackById(tid1)->m_playlists[0].count() == entries);
+    REQUIRE(timeline->getTrackById(tid1)->m_allClips.count(cid3) == 0);
+    REQUIRE(timeline->requestClipMove(cid3, tid1, 25));
+    REQUIRE(timeline->finishTrackAdoption(tid1));
+    REQUIRE(timeline->checkConsistency());
+    REQUIRE(timeline->getClipPosition(cid1) == 0);
+    REQUIRE(timeline->getClipPosition(cid2) == 50);
+    REQUIRE(timeline->getClipPosition(cid3) == 25);
+    REQUIRE(timeline->duration() == 70);
+    // Only the regular move created an undo entry
+    REQUIRE(undoStack->count() == undoCount + 1);
+
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
+
+TEST_CASE("Batched clip moves", "[ClipModel]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    TimelineItemModel tim(&profile_model, undoStack);
+    Mock<TimelineItemModel> timMock(tim);
+    auto timeline = std::shared_ptr<TimelineItemModel>(&timMock.get(), [](...) {});
+    TimelineItemModel::finishConstruct(timeline, guideModel);
+
+    QString binId = createProducer(profile_model, "red", binModel, 20);
+    int tid1 = TrackModel::construct(timeline);
+    int tid2 = TrackModel::construct(timeline);
+    int cid1 = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+    int cid2 = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+    int cid3 = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+    REQUIRE(timeline->requestClipMove(cid1, tid1, 0));
+    REQUIRE(timeline->requestClipMove(cid2, tid1, 30));
+    REQUIRE(timeline->requestClipMove(cid3, tid2, 100));
+
+    auto state0 = [&]() {
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(timeline->getClipTrackId(cid1) == tid1);
+        REQUIRE(timeline->getClipTrackId(cid2) == tid1);
+        REQUIRE(timeline->getClipTrackId(cid3) == tid2);
+        REQUIRE(timeline->getClipPosition(cid1) == 0);
+        REQUIRE(timeline->getClipPosition(cid2) == 30);
+        REQUIRE(timeline->getClipPosition(cid3) == 100);
+    };
+    state0();
+    int undoCount = undoStack->count();
+
+    SECTION("Invalid batch does not modify anything")
+    {
+        Fun undo = []() { return true; };
+        Fun redo = []() { return true; };
+        // cid2 would overlap cid3, which is not moved
+        REQUIRE_FALSE(timeline->requestClipsMove({{cid1, {tid1, 10}}, {cid2, {tid2, 90}}}, true, undo, redo));
+        // Moved clips cannot overlap each other
+        REQUIRE_FALSE(timeline->requestClipsMove({{cid1, {tid2, 10}}, {cid2, {tid2, 20}}}, true, undo, redo));
+        state0();
+        REQUIRE(undoStack->count() == undoCount);
+    }
+
+    SECTION("Swap and move clips across tracks with one undo entry")
+    {
+        // Moved clips can take the place of each other
+        Fun undo = []() { return true; };
+        Fun redo = []() { return true; };
+        REQUIRE(timeline->requestClipsMove({{cid1, {tid1, 30}}, {cid2, {tid2, 0}}, {cid3, {tid1, 0}}}, true, undo, redo));
+        undoStack->push(new FunctionalUndoCommand(undo, redo, QStringLiteral("Batch move")));
+        auto state1 = [&]() {
+            REQUIRE(timeline->checkConsistency());
+            REQUIRE(timeline->getClipTrackId(cid1) == tid1);
+            REQUIRE(timeline->getClipTrackId(cid2) == tid2);
+            REQUIRE(timeline->getClipTrackId(cid3) == tid1);
+            REQUIRE(timeline->getClipPosition(cid1) == 30);
+            REQUIRE(timeline->getClipPosition(cid2) == 0);
+            REQUIRE(timeline->getClipPosition(cid3) == 0);
+            REQUIRE(timeline->getTrackClipsCount(tid1) == 2);
+            REQUIRE(timeline->getTrackClipsCount(tid2) == 1);
+            REQUIRE(timeline->duration() == 50);
+        };
+        state1();
+        REQUIRE(undoStack->count() == undoCount + 1);
+        undoStack->undo();
+        state0();
+        undoStack->redo();
+        state1();
+        undoStack->undo();
+        state0();
+    }
+
+    SECTION("Clips that are not in a track are inserted")
+    {
+        int cid4 = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+        int cid5 = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+        Fun undo = []() { return true; };
+        Fun redo = []() { return true; };
+        REQUIRE(timeline->requestClipsMove({{cid4, {tid2, 0}}, {cid5, {tid1, 60}}}, true, undo, redo));
+        undoStack->push(new FunctionalUndoCommand(undo, redo, QStringLiteral("Batch insert")));
+        auto state1 = [&]() {
+            REQUIRE(timeline->checkConsistency());
+            REQUIRE(timeline->getClipTrackId(cid4) == tid2);
+            REQUIRE(timeline->getClipTrackId(cid5) == tid1);
+            REQUIRE(timeline->getClipPosition(cid4) == 0);
+            REQUIRE(timeline->getClipPosition(cid5) == 60);
+            REQUIRE(timeline->getTrackClipsCount(tid1) == 3);
+            REQUIRE(timeline->getTrackClipsCount(tid2) == 2);
+        };
+        state1();
+        undoStack->undo();
+        state0();
+        REQUIRE(timeline->getClipTrackId(cid4) == -1);
+        REQUIRE(timeline->getClipTrackId(cid5) == -1);
+        undoStack->redo();
+        state1();
+    }
+
+    SECTION("Group move uses a single operation")
+    {
+        int gid = timeline->requestClipsGroup({cid1, cid2, cid3});
+        REQUIRE(gid > 0);
+        REQUIRE(timeline->requestGroupMove(cid1, gid, 0, 40));
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(timeline->getClipPosition(cid1) == 40);
+        REQUIRE(timeline->getClipPosition(cid2) == 70);
+        REQUIRE(timeline->getClipPosition(cid3) == 140);
+        REQUIRE(timeline->duration() == 160);
+        undoStack->undo();
+        state0();
+    }
+
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
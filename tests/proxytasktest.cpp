@@ -0,0 +1,39 @@
+#include "catch.hpp"
+#include "jobs/proxytask.h"
+
+TEST_CASE("Proxy segments", "[ProxyTask]")
+{
+    SECTION("Segments cover the input, the last one goes to the end")
+    {
+        const QVector<QPair<int, int>> segments = ProxyTask::planSegments(250, 60);
+        REQUIRE(segments.size() == 5);
+        for (int i = 0; i < 4; ++i) {
+            REQUIRE(segments.at(i).first == i * 60);
+            REQUIRE(segments.at(i).second == 60);
+        }
+        REQUIRE(segments.last().first == 240);
+        REQUIRE(segments.last().second == -1);
+    }
+
+    SECTION("An exact multiple has no empty segment")
+    {
+        const QVector<QPair<int, int>> segments = ProxyTask::planSegments(180, 60);
+        REQUIRE(segments.size() == 3);
+        REQUIRE(segments.last() == qMakePair(120, -1));
+    }
+
+    SECTION("Invalid lengths give no segments")
+    {
+        REQUIRE(ProxyTask::planSegments(180, 0).isEmpty());
+        REQUIRE(ProxyTask::planSegments(0, 60).size() == 1);
+    }
+}
+
+TEST_CASE("FFmpeg progress parsing", "[ProxyTask]")
+{
+    REQUIRE(ProxyTask::parseFfmpegTime(QStringLiteral("frame=  120 fps= 60 q=28.0 size=     512kB time=00:01:05.52 bitrate= 640.1kbits/s speed=2.1x")) == 66);
+    REQUIRE(ProxyTask::parseFfmpegTime(QStringLiteral("size=     512kB time=01:02:03.40 bitrate= 640.1kbits/s")) == 3723);
+    REQUIRE(ProxyTask::parseFfmpegTime(QStringLiteral("size=N/A time=42 bitrate=N/A")) == 42);
+    REQUIRE(ProxyTask::parseFfmpegTime(QStringLiteral("[aac @ 0x5555] Too many bits per frame requested")) == -1);
+    REQUIRE(ProxyTask::parseFfmpegTime(QStringLiteral("time=")) == -1);
+}
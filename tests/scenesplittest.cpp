@@ -0,0 +1,39 @@
+#include "catch.hpp"
+#include "jobs/scenesplittask.h"
+
+TEST_CASE("Scene cuts", "[SceneSplit]")
+{
+    QVector<float> scores(100, 0.f);
+    scores[3] = 0.8f;
+    scores[10] = 0.5f;
+    scores[20] = 0.9f;
+    scores[25] = 0.9f;
+    scores[60] = 0.35f;
+
+    SECTION("Only scores above the threshold are cuts")
+    {
+        REQUIRE(SceneSplitTask::sceneCuts(scores, 0.4, 0) == QVector<int>({3, 10, 20, 25}));
+        REQUIRE(SceneSplitTask::sceneCuts(scores, 0.3, 0) == QVector<int>({3, 10, 20, 25, 60}));
+        REQUIRE(SceneSplitTask::sceneCuts(scores, 0.95, 0).isEmpty());
+    }
+
+    SECTION("Cuts closer than the minimum duration to the previous one are ignored")
+    {
+        REQUIRE(SceneSplitTask::sceneCuts(scores, 0.4, 8) == QVector<int>({3, 20}));
+        REQUIRE(SceneSplitTask::sceneCuts(scores, 0.4, 5) == QVector<int>({3, 10, 20, 25}));
+        REQUIRE(SceneSplitTask::sceneCuts(scores, 0.3, 40) == QVector<int>({3, 60}));
+    }
+
+    SECTION("The first cut is kept even if it is close to the start")
+    {
+        REQUIRE(SceneSplitTask::sceneCuts(scores, 0.4, 50) == QVector<int>({3}));
+        REQUIRE(SceneSplitTask::sceneCuts(scores, 0.85, 30) == QVector<int>({20}));
+    }
+
+    SECTION("The first frame is never a cut")
+    {
+        QVector<float> start(10, 0.f);
+        start[0] = 1.f;
+        REQUIRE(SceneSplitTask::sceneCuts(start, 0.4, 0).isEmpty());
+    }
+}
@@ -0,0 +1,82 @@
+#include "catch.hpp"
+#include "pythoninterfaces/speechpipeline.h"
+
+TEST_CASE("Speech recognition chunks", "[SpeechPipeline]")
+{
+    SECTION("Without levels the zone is split at fixed intervals")
+    {
+        auto chunks = SpeechPipeline::splitAtSilences({}, 2, 25., 10., 200., 60.);
+        REQUIRE(chunks.size() == 3);
+        REQUIRE(chunks.at(0) == QPair<double, double>(10., 60.));
+        REQUIRE(chunks.at(1) == QPair<double, double>(70., 60.));
+        // The last chunk takes the remaining 80 seconds instead of leaving a short one
+        REQUIRE(chunks.at(2) == QPair<double, double>(130., 80.));
+    }
+
+    SECTION("Short zones are not split")
+    {
+        auto chunks = SpeechPipeline::splitAtSilences({}, 1, 25., 0., 80., 60.);
+        REQUIRE(chunks.size() == 1);
+        REQUIRE(chunks.at(0) == QPair<double, double>(0., 80.));
+    }
+
+    SECTION("Chunks are cut in the silence closest to the chunk end")
+    {
+        const double fps = 25.;
+        const int channels = 2;
+        const int frames = 200 * 25;
+        QVector<uint8_t> levels(frames * channels, 100);
+        // Silence from 55s to 56s, inside the search window of the first cut at 60s
+        for (int frame = 55 * 25; frame < 56 * 25; ++frame) {
+            levels[frame * channels] = 0;
+            levels[frame * channels + 1] = 0;
+        }
+        auto chunks = SpeechPipeline::splitAtSilences(levels, channels, fps, 0., 200., 60.);
+        REQUIRE(chunks.size() == 3);
+        REQUIRE(chunks.at(0).first == 0.);
+        REQUIRE(chunks.at(0).second >= 55.);
+        REQUIRE(chunks.at(0).second <= 56.);
+        // Chunks are contiguous and cover the zone
+        double end = 0.;
+        for (const auto &chunk : chunks) {
+            REQUIRE(qFuzzyCompare(chunk.first + 1., end + 1.));
+            end = chunk.first + chunk.second;
+        }
+        REQUIRE(qFuzzyCompare(end, 200.));
+    }
+}
+
+TEST_CASE("Speech recognition output parsing", "[SpeechPipeline]")
+{
+    SECTION("Complete objects are extracted, partial data is kept")
+    {
+        QByteArray buffer("{\"text\": \"hello\"}\n{\"partial\": \"wor");
+        auto objects = SpeechPipeline::takeJsonObjects(buffer);
+        REQUIRE(objects.size() == 1);
+        REQUIRE(objects.first().value(QLatin1String("text")).toString() == QLatin1String("hello"));
+        REQUIRE(buffer == QByteArray("{\"partial\": \"wor"));
+        buffer.append("ld\"}");
+        objects = SpeechPipeline::takeJsonObjects(buffer);
+        REQUIRE(objects.size() == 1);
+        REQUIRE(objects.first().value(QLatin1String("partial")).toString() == QLatin1String("world"));
+        REQUIRE(buffer.isEmpty());
+    }
+
+    SECTION("Braces and quotes inside strings are ignored")
+    {
+        QByteArray buffer("{\"text\": \"a } \\\" { b\", \"result\": [{\"word\": \"x\"}]}");
+        auto objects = SpeechPipeline::takeJsonObjects(buffer);
+        REQUIRE(objects.size() == 1);
+        REQUIRE(objects.first().value(QLatin1String("text")).toString() == QLatin1String("a } \" { b"));
+        REQUIRE(objects.first().value(QLatin1String("result")).toArray().size() == 1);
+        REQUIRE(buffer.isEmpty());
+    }
+
+    SECTION("Text outside of objects is dropped")
+    {
+        QByteArray buffer("progress 10%\n{\"text\": \"\"}");
+        auto objects = SpeechPipeline::takeJsonObjects(buffer);
+        REQUIRE(objects.size() == 1);
+        REQUIRE(buffer.isEmpty());
+    }
+}
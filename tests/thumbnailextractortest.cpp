@@ -0,0 +1,27 @@
+#include "catch.hpp"
+#include "jobs/thumbnailextractor.h"
+
+TEST_CASE("Thumbnail extraction plan", "[ThumbnailExtractor]")
+{
+    SECTION("Positions far apart are all seeked")
+    {
+        std::set<int> positions = {0, 100, 200, 300};
+        auto plan = ThumbnailExtractor::plan(positions, 25);
+        REQUIRE(plan.steps.size() == 4);
+        REQUIRE(plan.seeks == 4);
+        REQUIRE(plan.steps.at(2).position == 200);
+    }
+
+    SECTION("Close positions are decoded forward")
+    {
+        std::set<int> positions = {20, 22, 24, 49, 75};
+        auto plan = ThumbnailExtractor::plan(positions, 25);
+        REQUIRE(plan.seeks == 2);
+        REQUIRE(plan.steps.at(0).seek);
+        REQUIRE_FALSE(plan.steps.at(1).seek);
+        REQUIRE_FALSE(plan.steps.at(2).seek);
+        // The gap is inclusive
+        REQUIRE_FALSE(plan.steps.at(3).seek);
+        REQUIRE(plan.steps.at(4).seek);
+    }
+}